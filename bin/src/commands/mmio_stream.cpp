@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "mmio_stream.hpp"
+#include <cstdio>
+
+InputStream::InputStream(std::string fname) {
+  if (fname == "-") _file.open(stdin, QIODevice::ReadOnly | QIODevice::Text);
+  else {
+    _file.setFileName(QString::fromStdString(fname));
+    _file.open(QIODevice::ReadOnly | QIODevice::Text);
+  }
+}
+
+void InputStream::attach(sim::memory::Input<quint16> &port) {
+  _endpoint = port.endpoint();
+  port.setRefill([this]() { return refill(); });
+}
+
+bool InputStream::refill() {
+  if (!_endpoint || !_file.isOpen()) return false;
+  _block.resize(blockSize);
+  // Returns 0 at the end of the file, or when stdin is closed.
+  auto length = _file.read(_block.data(), _block.size());
+  if (length <= 0) return false;
+  // The port only refills once it has read every event, and the CLI never rewinds it, so consumed input is discarded.
+  _endpoint->set_to_tail();
+  _endpoint->trim_before();
+  for (qint64 it = 0; it < length; it++) _endpoint->append_value(_block[it]);
+  return true;
+}
+
+OutputStream::OutputStream(std::string fname) {
+  if (fname == "-") _stdout = _file.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+  else {
+    _file.setFileName(QString::fromStdString(fname));
+    _file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+  }
+  _block.reserve(blockSize);
+}
+
+OutputStream::~OutputStream() { flush(); }
+
+void OutputStream::attach(sim::memory::Output<quint16> &port) {
+  _endpoint = port.endpoint();
+  _endpoint->set_to_head();
+}
+
+void OutputStream::drain() {
+  if (!_endpoint) return;
+  for (auto next = _endpoint->next_value(); next.has_value(); next = _endpoint->next_value()) {
+    _block.append(char(*next));
+    if (_block.size() >= blockSize) {
+      _file.write(_block);
+      _block.clear();
+    }
+  }
+  // Drained bytes are never read again, since the CLI neither traces nor rewinds the port.
+  _endpoint->trim_before();
+}
+
+void OutputStream::flush() {
+  drain();
+  if (!_file.isOpen()) return;
+  // If writing to terminal, ensure that there exists a \n.
+  if (_stdout && _endpoint) _block.append('\n');
+  _file.write(_block);
+  _block.clear();
+  _file.flush();
+  // Only flush the trailing newline once.
+  _endpoint = nullptr;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+#include "sim/device/broadcast/mmi.hpp"
+#include "sim/device/broadcast/mmo.hpp"
+
+// Feeds an MMI port from a file (or stdin if the name is `-`) one block at a time, as the program consumes input.
+class InputStream {
+public:
+  static constexpr qint64 blockSize = 64 * 1024;
+  InputStream(std::string fname);
+  bool isOpen() const { return _file.isOpen(); }
+  // Refill port from this stream whenever the program exhausts its input. The stream must outlive the port.
+  void attach(sim::memory::Input<quint16> &port);
+  // Append the next block to the port. Returns false if the stream is exhausted.
+  bool refill();
+
+private:
+  QFile _file;
+  QByteArray _block;
+  QSharedPointer<sim::memory::detail::Channel<quint16, quint8>::Endpoint> _endpoint = nullptr;
+};
+
+// Collects the bytes written to an MMO port, and writes them to a file (or stdout if the name is `-`) in blocks.
+class OutputStream {
+public:
+  static constexpr qint64 blockSize = 64 * 1024;
+  OutputStream(std::string fname);
+  ~OutputStream();
+  bool isOpen() const { return _file.isOpen(); }
+  void attach(sim::memory::Output<quint16> &port);
+  // Move bytes written since the last drain into the block, writing the block out whenever it fills.
+  void drain();
+  // Drain, then write any partial block.
+  void flush();
+
+private:
+  QFile _file;
+  bool _stdout = false;
+  QByteArray _block;
+  QSharedPointer<sim::memory::detail::Channel<quint16, quint8>::Endpoint> _endpoint = nullptr;
+};
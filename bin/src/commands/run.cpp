@@ -15,13 +15,19 @@
  */
 
 #include "run.hpp"
+#include <atomic>
+#include <thread>
 #include "../shared.hpp"
 #include "bits/strings.hpp"
 #include "builtins/figure.hpp"
 #include "helpers/asmb.hpp"
+#include "helpers/os_cache.hpp"
 #include "link/mmio.hpp"
+#include "mmio_stream.hpp"
 #include "sim/device/broadcast/mmi.hpp"
 #include "sim/device/broadcast/mmo.hpp"
+#include "sim/debug/profiler.hpp"
+#include "sim/device/ide.hpp"
 #include "sim/device/simple_bus.hpp"
 #include "targets/isa3/helpers.hpp"
 #include "targets/isa3/system.hpp"
@@ -32,6 +38,126 @@ auto gs = sim::api2::memory::Operation{
     .kind = sim::api2::memory::Operation::Kind::data,
 };
 
+namespace {
+enum class Outcome { Halted, NeedsMMI, MaxSteps, MemoryError };
+
+QString outcomeName(Outcome outcome) {
+  switch (outcome) {
+  case Outcome::Halted:
+    return "halted";
+  case Outcome::NeedsMMI:
+    return "needsInput";
+  case Outcome::MaxSteps:
+    return "maxSteps";
+  case Outcome::MemoryError:
+    return "memoryError";
+  }
+  return "";
+}
+
+// Run until the program powers off, exceeds maxSteps, or causes a memory error.
+// If provided, poll is called every pollInterval ticks, e.g., to drain output as it is produced.
+Outcome simulate(targets::isa::System &system, quint64 maxSteps, std::string &message,
+                 const std::function<void()> &poll = nullptr) {
+  static const quint32 pollInterval = 64 * 1024;
+  auto endpoint = system.output("pwrOff")->endpoint();
+  try {
+    for (quint32 sincePoll = 0; system.currentTick() < maxSteps && !endpoint->next_value().has_value();) {
+      system.tick(sim::api2::Scheduler::Mode::Jump);
+      if (poll && ++sincePoll == pollInterval) {
+        poll();
+        sincePoll = 0;
+      }
+    }
+  } catch (const sim::api2::memory::Error &e) {
+    if (e.type() == sim::api2::memory::Error::Type::NeedsMMI)
+      return Outcome::NeedsMMI;
+    message = e.what();
+    return Outcome::MemoryError;
+  }
+  return system.currentTick() >= maxSteps ? Outcome::MaxSteps : Outcome::Halted;
+}
+
+void overrideRegisters(targets::isa::System &system, int ed, const QMap<std::string, quint16> &overrides) {
+  for (auto [reg, val] : overrides.asKeyValueRange()) {
+    QMetaEnum enu;
+    switch (ed) {
+    case 6:
+      enu = QMetaEnum::fromType<::isa::Pep10::Register>();
+      break;
+    default:
+      static const char *const e = "Unhandled book";
+      qCritical(e);
+      throw std::logic_error(e);
+    }
+    bool ok = true;
+    // Always compare in caps
+    auto transformed = QString::fromStdString(reg).toUpper().toStdString();
+    auto regEnu = enu.keyToValue(transformed.c_str(), &ok);
+    if (!ok) {
+      static const char *const e = "Invalid register";
+      qCritical(e);
+      throw std::logic_error(e);
+    }
+    auto cpu = static_cast<targets::pep10::isa::CPU *>(system.cpu());
+    targets::isa::writeRegister<isa::Pep10>(cpu->regs(), static_cast<isa::Pep10::Register>(regEnu), val, gs);
+  }
+}
+
+void dumpMemory(targets::isa::System &system, const QString &fname) {
+  QVector<quint8> dump(0x1'00'00);
+  system.bus()->dump({dump.data(), std::size_t(dump.size())});
+  QFile memDump(fname);
+  if (memDump.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    memDump.write(reinterpret_cast<const char *>(dump.constData()), dump.size());
+    memDump.close();
+  }
+}
+
+// Names of addresses in every symbol table of elf, so that profiles can name routines. Constants are skipped, since
+// their values are not addresses.
+QHash<quint16, QString> symbols(const ELFIO::elfio &elf) {
+  QHash<quint16, QString> ret;
+  std::string name;
+  ELFIO::Elf64_Addr value;
+  ELFIO::Elf_Xword size;
+  unsigned char bind, type, other;
+  ELFIO::Elf_Half index;
+  for (const auto &section : elf.sections) {
+    if (section->get_type() != ELFIO::SHT_SYMTAB)
+      continue;
+    ELFIO::symbol_section_accessor symTabAc(elf, section.get());
+    for (ELFIO::Elf_Xword it = 1; it < symTabAc.get_symbols_num(); it++) {
+      if (!symTabAc.get_symbol(it, name, value, size, bind, type, index, other) || name.empty())
+        continue;
+      else if (index == ELFIO::SHN_ABS || index == ELFIO::SHN_UNDEF || ret.contains(quint16(value)))
+        continue;
+      ret[quint16(value)] = QString::fromStdString(name);
+    }
+  }
+  return ret;
+}
+
+void writeProfile(const pepp::sim::Profiler &profiler, const std::string &folded, const std::string &summary) {
+  if (QFile f(QString::fromStdString(folded));
+      !folded.empty() && f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    QTextStream out(&f);
+    profiler.writeFolded(out);
+  }
+  if (QFile f(QString::fromStdString(summary));
+      !summary.empty() && f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+    auto json = profiler.summary([](quint8 is) {
+      auto opcode = isa::Pep10::opcodeLUT[is];
+      auto ret = isa::Pep10::string(opcode.instr.mnemon).toUpper();
+      if (!opcode.instr.unary)
+        ret += "," + isa::Pep10::string(opcode.mode).toLower();
+      return ret;
+    });
+    f.write(QJsonDocument(json).toJson());
+  }
+}
+} // namespace
+
 RunTask::RunTask(int ed, std::string fname, QObject *parent) : Task(parent), _ed(ed), _objIn(fname) {}
 
 bool RunTask::loadToElf() {
@@ -40,28 +166,6 @@ bool RunTask::loadToElf() {
     _elf = ret;
     return true;
   }
-  auto book = helpers::book(_ed);
-  if (book.isNull())
-    return false;
-  QString osContents;
-  if (_forceBm && _ed == 6) {
-    auto os = book->findFigure("os", "pep10baremetal");
-    osContents = os->typesafeElements()["pep"]->contents;
-  } else if (!_osIn.has_value()) {
-    auto os = book->findFigure("os", "pep10os");
-    osContents = os->typesafeElements()["pep"]->contents;
-  } else {
-    QFile oIn(QString::fromStdString(*_osIn)); // auto-closes
-    oIn.open(QIODevice::ReadOnly | QIODevice::Text);
-    osContents = oIn.readAll();
-  }
-  auto macroRegistry = helpers::registry(book, {});
-  helpers::AsmHelper helper(macroRegistry, osContents);
-  auto result = helper.assemble();
-  if (!result) {
-    std::cerr << "OS assembly failed" << std::endl;
-    return false;
-  }
   QFile objF(QString::fromStdString(_objIn));
   if (!objF.open(QIODevice::ReadOnly | QIODevice::Text)) {
     std::cerr << "Failed to open object code: " << _objIn << std::endl;
@@ -71,80 +175,91 @@ bool RunTask::loadToElf() {
   auto bytes = bits::asciiHexToByte({objText.data(), objText.size()});
   if (!bytes)
     return false;
-  _elf = helper.elf(*bytes);
-  return true;
+  _elf = assembleOS(*bytes);
+  return !_elf.isNull();
+}
+
+QString RunTask::osSource(const builtins::Book &book) const {
+  if (_forceBm && _ed == 6) {
+    auto os = book.findFigure("os", "pep10baremetal");
+    return os->typesafeElements()["pep"]->contents;
+  } else if (!_osIn.has_value()) {
+    auto os = book.findFigure("os", "pep10os");
+    return os->typesafeElements()["pep"]->contents;
+  }
+  QFile oIn(QString::fromStdString(*_osIn)); // auto-closes
+  oIn.open(QIODevice::ReadOnly | QIODevice::Text);
+  return oIn.readAll();
+}
+
+QSharedPointer<ELFIO::elfio> RunTask::assembleOS(std::optional<QList<quint8>> userObj) const {
+  auto book = helpers::book(_ed);
+  if (book.isNull())
+    return nullptr;
+  auto osContents = osSource(*book);
+  auto macroRegistry = helpers::registry(book, {});
+  auto &cache = helpers::OSImageCache::instance();
+  // Reuse OS images assembled by previous runs.
+  if (auto dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation); _persistOS && !dir.isEmpty())
+    cache.setDirectory(QDir(dir).filePath("os"));
+  auto elf = cache.elf(macroRegistry, osContents, builtins::Architecture::PEP10, userObj);
+  if (!elf)
+    std::cerr << "OS assembly failed" << std::endl;
+  return elf;
 }
 
 void RunTask::run() {
   using namespace Qt::StringLiterals;
+  if (_batchThreads)
+    return runBatch();
   if (!loadToElf())
     return emit finished(1);
   auto system = targets::isa::systemFromElf(*_elf, true);
   system->init();
 
   // Perform any requested register overrides.
-  for (auto [reg, val] : _regOverrides.asKeyValueRange()) {
-    QMetaEnum enu;
-    switch (_ed) {
-    case 6:
-      enu = QMetaEnum::fromType<::isa::Pep10::Register>();
-      break;
-    default:
-      static const char *const e = "Unhandled book";
-      qCritical(e);
-      throw std::logic_error(e);
-    }
-    bool ok = true;
-    // Always compare in caps
-    auto transformed = QString::fromStdString(reg).toUpper().toStdString();
-    auto regEnu = enu.keyToValue(transformed.c_str(), &ok);
-    if (!ok) {
-      static const char *const e = "Invalid register";
-      qCritical(e);
-      throw std::logic_error(e);
+  overrideRegisters(*system, _ed, _regOverrides);
+
+  for (auto disk = _disks.cbegin(); disk != _disks.cend(); ++disk) {
+    auto ide = system->ideController(QString::fromStdString(disk.key()));
+    if (ide == nullptr) {
+      std::cerr << "No IDE controller named " << disk.key() << std::endl;
+      return emit finished(1);
+    } else if (!ide->attachImage(QString::fromStdString(disk.value()))) {
+      std::cerr << "Could not map disk image " << disk.value() << std::endl;
+      return emit finished(1);
     }
-    auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
-    targets::isa::writeRegister<isa::Pep10>(cpu->regs(), static_cast<isa::Pep10::Register>(regEnu), val, gs);
   }
 
-  auto pwrOff = system->output("pwrOff");
-  auto endpoint = pwrOff->endpoint();
-  bool fail = false;
-  if (auto charIn = system->input("charIn"); !_charIn.empty() && charIn) {
-    auto charInEndpoint = charIn->endpoint();
-    QString buffer;
-
-    if (_charIn == "-") {
-      QTextStream in(stdin, QIODevice::ReadOnly | QIODevice::Text);
-      while (!in.atEnd())
-        charInEndpoint->append_value(in.read(1).toUtf8()[0]);
-    } else {
-      QFile f(QString::fromStdString(_charIn));
-      f.open(QIODevice::ReadOnly | QIODevice::Text);
-      QByteArray buffer = f.readAll();
-      for (int it = 0; it < buffer.size(); it++)
-        charInEndpoint->append_value(buffer[it]);
-    }
+  // Input is read in blocks as the program consumes it, and output is written in blocks as it is produced.
+  std::optional<InputStream> charIn;
+  if (auto port = system->input("charIn"); !_charIn.empty() && port)
+    charIn.emplace(_charIn).attach(*port);
+  std::optional<OutputStream> charOut;
+  if (auto port = system->output("charOut"); !_charOut.empty() && port)
+    charOut.emplace(_charOut).attach(*port);
+
+  std::optional<pepp::sim::Profiler> profiler;
+  auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
+  if (!_profileFolded.empty() || !_profileSummary.empty()) {
+    profiler.emplace().setSymbols(symbols(*_elf));
+    cpu->setProfiler(&*profiler);
   }
 
   auto printReg = [&](isa::Pep10::Register reg) {
     quint16 tmp = 0;
-    auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
     targets::isa::readRegister<isa::Pep10>(cpu->regs(), reg, tmp, gs);
     auto regName = QMetaEnum::fromType<isa::detail::pep10::Register>().valueToKey((int)reg);
     std::cout << u"%1=%2"_s.arg(regName).arg(QString::number(tmp, 16), 4, '0').toStdString() << " ";
   };
-  bool noMMI = false;
-  try {
-    while (system->currentTick() < _maxSteps && !endpoint->next_value().has_value())
-      system->tick(sim::api2::Scheduler::Mode::Jump);
-  } catch (const sim::api2::memory::Error &e) {
-    if (e.type() == sim::api2::memory::Error::Type::NeedsMMI) {
-      noMMI = true;
-    } else
-      std::cerr << "Memory error: " << e.what() << std::endl;
-  }
-  if (noMMI) {
+  std::string message;
+  auto outcome = simulate(*system, _maxSteps, message, [&charOut]() {
+    if (charOut)
+      charOut->drain();
+  });
+  if (outcome == Outcome::MemoryError)
+    std::cerr << "Memory error: " << message << std::endl;
+  else if (outcome == Outcome::NeedsMMI) {
     std::cout << "Program requested data from charIn, but no data is present. "
                  "Terminating.\n";
   }
@@ -152,41 +267,158 @@ void RunTask::run() {
     std::cout << "Exceeded max number of steps. Possible infinite loop\n";
     // Write to console that an infinite loop was detected.
   }
-  if (auto charOut = system->output("charOut"); !_charOut.empty() && charOut) {
-    auto charOutEndpoint = charOut->endpoint();
-    charOutEndpoint->set_to_head();
-    auto writeOut = [&](QTextStream &outF) {
-      for (auto next = charOutEndpoint->next_value(); next.has_value(); next = charOutEndpoint->next_value()) {
-        outF << char(*next);
-      }
+  if (charOut)
+    charOut->flush();
+  if (profiler) {
+    cpu->clearProfiler();
+    writeProfile(*profiler, _profileFolded, _profileSummary);
+  }
+
+  if (!_memDump.empty())
+    dumpMemory(*system, QString::fromStdString(_memDump));
+  emit finished(0);
+}
+
+void RunTask::runBatch() {
+  QFile manifestF(QString::fromStdString(_objIn));
+  if (!manifestF.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    std::cerr << "Failed to open manifest: " << _objIn << std::endl;
+    return emit finished(1);
+  }
+  QJsonParseError parseError;
+  auto manifest = QJsonDocument::fromJson(manifestF.readAll(), &parseError);
+  if (parseError.error != QJsonParseError::NoError || !manifest.isArray()) {
+    std::cerr << "Manifest must be a JSON array of jobs" << std::endl;
+    return emit finished(1);
+  }
+
+  const auto root = QFileInfo(manifestF).absoluteDir();
+  QList<BatchJob> jobs;
+  for (const auto &entry : manifest.array()) {
+    auto object = entry.toObject();
+    auto path = [&](const char *key) {
+      auto value = object[key].toString();
+      return value.isEmpty() ? value : root.filePath(value);
     };
+    BatchJob job{.obj = path("obj"),
+                 .charIn = path("charIn"),
+                 .charOut = path("charOut"),
+                 .memDump = path("memDump"),
+                 .result = path("result"),
+                 .maxSteps = quint64(object["maxSteps"].toInteger(_maxSteps))};
+    if (job.obj.isEmpty()) {
+      std::cerr << "Manifest entry " << jobs.size() << " is missing `obj`" << std::endl;
+      return emit finished(1);
+    } else if (job.result.isEmpty())
+      job.result = job.obj + ".result.json";
+    jobs.push_back(job);
+  }
+
+  // Assemble the OS once, and share the read-only ELF with every job that provides object code.
+  BatchOS os{.book = helpers::book(_ed)};
+  if (os.book.isNull() || (os.elf = assembleOS()).isNull())
+    return emit finished(1);
+  os.source = osSource(*os.book);
+
+  std::atomic<qsizetype> next = 0, failed = 0;
+  auto worker = [&]() {
+    for (auto index = next++; index < jobs.size(); index = next++)
+      if (!runJob(jobs[index], os))
+        failed++;
+  };
+  std::vector<std::thread> pool;
+  for (qsizetype it = 0; it < std::clamp<qsizetype>(jobs.size(), 1, *_batchThreads); it++)
+    pool.emplace_back(worker);
+  for (auto &thread : pool)
+    thread.join();
+
+  std::cout << "Ran " << jobs.size() - failed << " of " << jobs.size() << " jobs" << std::endl;
+  emit finished(failed == 0 ? 0 : 1);
+}
+
+bool RunTask::runJob(const BatchJob &job, const BatchOS &os) const {
+  QJsonObject result{{"obj", job.obj}};
+  auto writeResult = [&](bool ok) {
+    QFile f(job.result);
+    if (f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+      f.write(QJsonDocument(result).toJson());
+    return ok;
+  };
+  auto fail = [&](QString message) {
+    result["status"] = "error";
+    result["message"] = message;
+    return writeResult(false);
+  };
+
+  // Must outlive the system, which was configured from it.
+  ELFIO::elfio elf;
+  QSharedPointer<ELFIO::elfio> assembled = nullptr;
+  QSharedPointer<targets::isa::System> system = nullptr;
+  try {
+    if (QFileInfo(job.obj).suffix().compare("pep", Qt::CaseInsensitive) == 0) {
+      QFile srcF(job.obj);
+      if (!srcF.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("Failed to open source");
+      // User programs link against the OS's exports, so the OS is assembled alongside each one. Every job needs its
+      // own registry, since assembling the OS registers its system calls as macros.
+      helpers::AsmHelper helper(helpers::registry(os.book, {}), os.source);
+      helper.setUserText(srcF.readAll());
+      if (!helper.assemble()) {
+        result["errors"] = QJsonArray::fromStringList(helper.errors());
+        return fail("Assembly failed");
+      }
+      assembled = helper.elf();
+      system = targets::isa::systemFromElf(*assembled, true);
+    } else if (elf.load(job.obj.toStdString()))
+      system = targets::isa::systemFromElf(elf, true);
+    else {
+      QFile objF(job.obj);
+      if (!objF.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("Failed to open object code");
+      auto objText = objF.readAll().toStdString();
+      auto bytes = bits::asciiHexToByte({objText.data(), objText.size()});
+      if (!bytes)
+        return fail("Invalid object code");
+      // Load the user program on top of the shared OS, like the GUI does.
+      system = targets::isa::systemFromElf(*os.elf, true);
+      system->bus()->write(0, *bytes, gs);
+    }
+    system->init();
+    overrideRegisters(*system, _ed, _regOverrides);
 
-    if (_charOut == "-") {
-      QTextStream out(stdout, QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
-      writeOut(out);
-      // If writing to terminal, ensure that there exists a \n.
-      out << "\n";
-      out.flush();
-
-    } else {
-      QFile f(QString::fromStdString(_charOut));
-      f.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
-      QTextStream out(&f);
-      writeOut(out);
-      out.flush();
+    if (auto charIn = system->input("charIn"); !job.charIn.isEmpty() && charIn) {
+      QFile f(job.charIn);
+      if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+        return fail("Failed to open charIn");
+      auto charInEndpoint = charIn->endpoint();
+      for (auto byte : f.readAll())
+        charInEndpoint->append_value(byte);
     }
-  }
 
-  if (!_memDump.empty()) {
-    QVector<quint8> dump(0x1'00'00);
-    system->bus()->dump({dump.data(), std::size_t(dump.size())});
-    QFile memDump(QString::fromStdString(_memDump));
-    if (memDump.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-      memDump.write(reinterpret_cast<const char *>(dump.constData()), dump.size());
-      memDump.close();
+    std::string message;
+    auto outcome = simulate(*system, job.maxSteps, message);
+    result["status"] = outcomeName(outcome);
+    if (!message.empty())
+      result["message"] = QString::fromStdString(message);
+    result["steps"] = qint64(system->currentTick());
+
+    QByteArray charOut;
+    if (auto output = system->output("charOut"); output) {
+      auto charOutEndpoint = output->endpoint();
+      charOutEndpoint->set_to_head();
+      for (auto next = charOutEndpoint->next_value(); next.has_value(); next = charOutEndpoint->next_value())
+        charOut.append(char(*next));
     }
+    result["charOut"] = QString::fromLatin1(charOut);
+    if (QFile f(job.charOut); !job.charOut.isEmpty() && f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+      f.write(charOut);
+    if (!job.memDump.isEmpty())
+      dumpMemory(*system, job.memDump);
+  } catch (const std::exception &e) {
+    // Illegal opcodes and invalid register overrides only fail this job, not the whole batch.
+    return fail(e.what());
   }
-  emit finished(0);
+  return writeResult(true);
 }
 
 void RunTask::setCharOut(std::string fname) { this->_charOut = fname; }
@@ -201,4 +433,16 @@ void RunTask::setBm(bool forceBm) { _forceBm = forceBm; }
 
 void RunTask::setOsIn(std::string fname) { _osIn = fname; }
 
+void RunTask::setPersistOS(bool persist) { _persistOS = persist; }
+
 void RunTask::addRegisterOverride(std::string name, quint16 value) { _regOverrides[name] = value; }
+
+void RunTask::addDisk(std::string name, std::string fname) { _disks[name] = fname; }
+
+void RunTask::setProfileFolded(std::string fname) { _profileFolded = fname; }
+
+void RunTask::setProfileSummary(std::string fname) { _profileSummary = fname; }
+
+void RunTask::setBatch(unsigned threads) {
+  _batchThreads = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+}
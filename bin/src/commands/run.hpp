@@ -18,6 +18,7 @@
 #include <CLI11.hpp>
 #include "../shared.hpp"
 #include "../task.hpp"
+#include "builtins/book.hpp"
 #include "elfio/elfio.hpp"
 
 class RunTask : public Task {
@@ -32,25 +33,57 @@ public:
   void setMaxSteps(quint64 maxSteps);
   void setBm(bool forceBm);
   void setOsIn(std::string fname);
+  // Read and write assembled OS images in the user's cache directory, so that later runs skip OS assembly.
+  void setPersistOS(bool persist);
   void addRegisterOverride(std::string name, quint16 value);
+  // Back the disk of the IDE controller `name` with the image file fname. See IDEController::attachImage.
+  void addDisk(std::string name, std::string fname);
+  // Treat the input file as a JSON manifest of jobs, which are simulated concurrently on `threads` threads.
+  // If threads is 0, one thread is used per core.
+  void setBatch(unsigned threads);
+  // Profile the simulation, writing folded call stacks and/or a JSON summary to the named files.
+  void setProfileFolded(std::string fname);
+  void setProfileSummary(std::string fname);
 
 private:
+  struct BatchJob {
+    QString obj, charIn, charOut, memDump, result;
+    quint64 maxSteps;
+  };
+  // Shared read-only by every job in a batch.
+  struct BatchOS {
+    QSharedPointer<const builtins::Book> book;
+    QString source;
+    QSharedPointer<const ELFIO::elfio> elf;
+  };
+  // Source of the OS selected by setBm/setOsIn.
+  QString osSource(const builtins::Book &book) const;
+  // Assemble the OS selected by setBm/setOsIn, with userObj as the user program. Returns nullptr if assembly fails.
+  QSharedPointer<ELFIO::elfio> assembleOS(std::optional<QList<quint8>> userObj = std::nullopt) const;
+  void runBatch();
+  // Returns false if the job could not be simulated, e.g., because its source does not assemble.
+  bool runJob(const BatchJob &job, const BatchOS &os) const;
   int _ed;
   std::string _objIn;
   QSharedPointer<ELFIO::elfio> _elf = nullptr;
   std::string _charOut, _charIn, _memDump;
   quint64 _maxSteps;
   std::optional<std::string> _osIn;
-  bool _forceBm = false;
+  bool _forceBm = false, _persistOS = false;
   QMap<std::string, quint16> _regOverrides;
+  QMap<std::string, std::string> _disks;
+  std::optional<unsigned> _batchThreads = std::nullopt;
+  std::string _profileFolded, _profileSummary;
 };
 
 void registerRun(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
   // Must initialize,
-  static bool bm = false;
-  static std::string objIn, charIn, charOut, memDump, osIn;
+  static bool bm = false, cacheOS = false;
+  static std::string objIn, charIn, charOut, memDump, osIn, profileFolded, profileSummary;
   static uint64_t maxSteps;
+  static unsigned threads = 0;
   static std::map<std::string, quint64> regOverrides;
+  static std::map<std::string, std::string> disks;
   static CLI::Option *bmRunOpt = nullptr;
 
   static auto runSC = app.add_subcommand("run", "Run ISA3 programs");
@@ -74,7 +107,33 @@ void registerRun(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
   static auto osInOpt = runSC->add_option("--os", osIn, "File from which os will be read.");
   if (flags.edValue == 6)
     bmRunOpt = runSC->add_flag("--bm", bm, "Use bare metal OS.")->excludes(osInOpt);
+  runSC->add_flag("--cache-os", cacheOS,
+                  "Store the assembled OS in the user's cache directory, and reuse images stored by previous runs.");
   static auto regOverrideOpt = runSC->add_option("--reg", regOverrides)->group("");
+  static auto diskOpt = runSC->add_option("--disk", disks,
+                                          "IDE controller name followed by a disk image file, which backs that "
+                                          "controller's disk. The file is created if it does not exist, and writes "
+                                          "to the disk persist in the file. May be repeated.");
+  static auto batchOpt = runSC->add_flag("--batch",
+                                         "Treat obj as a JSON manifest of jobs. Each job is an object with an `obj` "
+                                         "path and optional `charIn`, `charOut`, `memDump`, `result` paths and a "
+                                         "`maxSteps` limit. `obj` may be an ELF, object code, or a .pep source file, "
+                                         "which is assembled against the OS. Relative paths are resolved against the "
+                                         "manifest. A JSON result is written for each job, by default to "
+                                         "`<obj>.result.json`.");
+  runSC->add_option("-j,--jobs", threads, "Number of threads used by --batch. Defaults to one per core.")
+      ->needs(batchOpt);
+  // Concurrent jobs would share the same image.
+  diskOpt->excludes(batchOpt);
+  static auto profileFoldedOpt =
+      runSC->add_option("--profile-folded", profileFolded,
+                        "File to which executed instructions will be written as folded call stacks, one line per "
+                        "stack, suitable for flame graph tools.");
+  static auto profileSummaryOpt =
+      runSC->add_option("--profile-json", profileSummary,
+                        "File to which per-PC counts, per-opcode counts, and the call graph will be written as JSON.");
+  profileFoldedOpt->excludes(batchOpt);
+  profileSummaryOpt->excludes(batchOpt);
   runSC->callback([&]() {
     flags.kind = detail::SharedFlags::Kind::TERM;
     task = [&](QObject *parent) {
@@ -89,8 +148,17 @@ void registerRun(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
       else if (*osInOpt)
         ret->setOsIn(osIn);
       ret->setMaxSteps(maxSteps);
+      ret->setPersistOS(cacheOS);
       for (auto &reg : regOverrides)
         ret->addRegisterOverride(reg.first, reg.second);
+      for (auto &disk : disks)
+        ret->addDisk(disk.first, disk.second);
+      if (*batchOpt)
+        ret->setBatch(threads);
+      if (*profileFoldedOpt)
+        ret->setProfileFolded(profileFolded);
+      if (*profileSummaryOpt)
+        ret->setProfileSummary(profileSummary);
       return ret;
     };
   });
@@ -16,10 +16,23 @@
  */
 
 #include "throughput.hpp"
-#include "sim/device/dense.hpp"
-#include "targets/pep10/isa3/cpu.hpp"
 #include <chrono>
 #include <iostream>
+#include "builtins/figure.hpp"
+#include "helpers/asmb.hpp"
+#include "sim/device/dense.hpp"
+#include "sim/device/simple_bus.hpp"
+#include "sim/trace2/buffers.hpp"
+#include "targets/isa3/system.hpp"
+#include "targets/pep10/isa3/cpu.hpp"
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif !defined(Q_OS_WASM)
+#include <sys/resource.h>
+#endif
+
+namespace {
 const auto desc_mem = sim::api2::device::Descriptor{
     .id = 1,
     .baseName = "ram",
@@ -34,38 +47,291 @@ const auto desc_cpu = sim::api2::device::Descriptor{
 
 const auto span = sim::api2::memory::AddressSpan<quint16>(0, 0xFFFF);
 
-auto make = []() {
-  int i = 3;
-  sim::api2::device::IDGenerator gen = [&i]() { return i++; };
-  auto storage = QSharedPointer<sim::memory::Dense<quint16>>::create(desc_mem, span);
-  auto cpu = QSharedPointer<targets::pep10::isa::CPU>::create(desc_cpu, gen);
-  cpu->setTarget(storage.data(), nullptr);
-  return std::pair{storage, cpu};
-};
-
 sim::api2::memory::Operation rw = {
     .type = sim::api2::memory::Operation::Type::Standard,
     .kind = sim::api2::memory::Operation::Kind::data,
 };
 
-ThroughputTask::ThroughputTask(QObject *parent) : Task(parent) {}
+// Same budget as the GUI, so that traced workloads pay for eviction like the GUI does.
+const auto traceBudget = sim::trace2::BoundedBuffer::Budget{.bytes = 32 * 1024 * 1024};
+// Number of source lines in the generated program used to measure the assembler.
+constexpr qsizetype asmLines = 8'000;
 
-void ThroughputTask::run() {
-  using namespace Qt::StringLiterals;
-  auto [mem, cpu] = make();
+struct Measurement {
+  // Number of ticks simulated or lines assembled.
+  quint64 count = 0;
+  std::chrono::nanoseconds elapsed = {};
+};
+
+struct Workload {
+  enum class Kind { Simulator, Assembler } kind;
+  QString name, description;
+  // Throws std::runtime_error if the workload could not be set up, or std::logic_error if it did not run as intended.
+  std::function<Measurement(quint64 ticks)> run;
+};
+
+// Peak resident set size of the process in bytes, or 0 if unknown. This is a high-water mark for the whole process, so
+// it only increases as workloads are run.
+quint64 peakRSS() {
+#if defined(Q_OS_WIN)
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return counters.PeakWorkingSetSize;
+  return 0;
+#elif defined(Q_OS_WASM)
+  return 0;
+#else
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0)
+    return 0;
+#if defined(Q_OS_DARWIN)
+  return usage.ru_maxrss;
+#else
+  // Linux reports kibibytes.
+  return quint64(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+template <typename Body> Measurement measure(quint64 count, Body &&body) {
+  auto start = std::chrono::steady_clock::now();
+  body();
+  auto end = std::chrono::steady_clock::now();
+  return {.count = count, .elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start)};
+}
+
+// An infinite loop of BR against bare Dense memory, without a bus or OS. Only measures the CPU's dispatch overhead.
+Measurement bareBranch(quint64 ticks) {
+  int i = 3;
+  sim::api2::device::IDGenerator gen = [&i]() { return i++; };
+  auto mem = QSharedPointer<sim::memory::Dense<quint16>>::create(desc_mem, span);
+  auto cpu = QSharedPointer<targets::pep10::isa::CPU>::create(desc_cpu, gen);
+  cpu->setTarget(mem.data(), nullptr);
   cpu->regs()->clear(0);
   cpu->csrs()->clear(0);
   // Infinite looping branch to 0.
   auto program = std::array<quint8, 3>{static_cast<quint8>(isa::Pep10::Mnemonic::BR), 0x00, 0x00};
   mem->write(0, {program.data(), program.size()}, rw);
-  auto start = std::chrono::high_resolution_clock::now();
-  auto maxInstr = 1'000'000;
-  for (int it = 0; it < maxInstr; it++) cpu->clock(it);
-  auto end = std::chrono::high_resolution_clock::now();
-  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-  auto dt = 1.0 / (ms.count() / 1000.0);
-  std::cout << u"Duration was: %1\n"_s.arg(ms.count()).toStdString();
-  std::cout << u"Throughput was: %1\n"_s.arg(dt * maxInstr).toStdString();
-
-  emit finished(0);
+  // Memory is not modified after this point, so the decode cache needs no write observer.
+  cpu->setDecodeCacheEnabled(true);
+  return measure(ticks, [&]() {
+    for (quint64 it = 0; it < ticks; it++)
+      cpu->clock(it);
+  });
+}
+
+QString fullOS() {
+  auto book = helpers::book(6);
+  if (book.isNull())
+    throw std::runtime_error("Could not load book");
+  return book->findFigure("os", "pep10os")->typesafeElements()["pep"]->contents;
+}
+
+// Assembles user against the full OS. User programs must never return, since workloads run for a fixed number of ticks.
+// The system keeps pointers into the ELF, so the ELF must outlive it.
+std::pair<QSharedPointer<ELFIO::elfio>, QSharedPointer<targets::isa::System>> assemble(const QString &user) {
+  auto registry = helpers::registry(helpers::book(6), {});
+  helpers::AsmHelper helper(registry, fullOS());
+  helper.setUserText(user);
+  if (!helper.assemble())
+    throw std::runtime_error(helper.errors().join("\n").toStdString());
+  auto elf = helper.elf();
+  auto system = targets::isa::systemFromElf(*elf, true);
+  system->init();
+  return {elf, system};
+}
+
+Measurement simulate(const QString &user, bool traced, quint64 ticks) {
+  auto [elf, system] = assemble(user);
+  auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
+  sim::trace2::BoundedBuffer tb(traceBudget);
+  if (traced) {
+    // Matches the GUI, which only records while a program is running.
+    system->bus()->setBuffer(&tb);
+    cpu->setBuffer(&tb);
+    system->bus()->trace(true);
+    cpu->trace(true);
+  }
+  auto ret = measure(ticks, [&]() {
+    for (quint64 it = 0; it < ticks; it++)
+      system->tick(sim::api2::Scheduler::Mode::Jump);
+  });
+  // Otherwise a "+trace" workload would silently measure an untraced run.
+  if (traced && tb.cbegin() == tb.cend())
+    throw std::logic_error("Traced run recorded no frames");
+  return ret;
+}
+
+// Each program is run as the user program under the full OS, which must not return.
+struct Program {
+  QString name, description, source;
+};
+
+QList<Program> programs() {
+  using namespace Qt::StringLiterals;
+  QList<Program> ret;
+  ret.push_back({"arith", "Register-only arithmetic and logic", uR"(
+loop:    ADDA    1,i
+         SUBX    3,i
+         ASLA
+         ANDA    0x7FFF,i
+         ORX     0x0010,i
+         NOTA
+         CPWA    0,i
+         BR      loop
+)"_s});
+  // Load and store in each addressing mode. Stores are not legal with immediate addressing.
+  const QList<std::pair<QString, QString>> modes = {{"i", "5,i"},   {"d", "var,d"},  {"n", "ptr,n"},   {"s", "2,s"},
+                                                    {"sf", "0,sf"}, {"x", "arr,x"}, {"sx", "0,sx"}, {"sfx", "0,sfx"}};
+  for (const auto &[mode, operand] : modes) {
+    const QString store = mode == "i" ? u"LDWX    %1"_s.arg(operand) : u"STWA    %1"_s.arg(operand);
+    ret.push_back({u"ldst-%1"_s.arg(mode), u"Load and store with %1 addressing"_s.arg(mode), uR"(
+         BR      main
+var:     .WORD   0
+arr:     .BLOCK  8
+ptr:     .ADDRSS var
+main:    SUBSP   4,i
+         LDWA    arr,i
+         STWA    0,s
+         LDWX    2,i
+loop:    LDWA    %1
+         %2
+         BR      loop
+)"_s.arg(operand, store)});
+  }
+  ret.push_back({"call-ret", "Subroutine calls and returns", uR"(
+loop:    CALL    sub
+         BR      loop
+sub:     RET
+)"_s});
+  ret.push_back({"trap", "System calls through the OS trap handler", uR"(
+loop:    @SNOP   0,i
+         BR      loop
+)"_s});
+  ret.push_back({"mmio", "Memory-mapped output", uR"(
+loop:    LDBA    'x',i
+         STBA    charOut,d
+         BR      loop
+)"_s});
+  return ret;
 }
+
+// A large program with a mix of directives, labels, symbolic operands and comments.
+QString generateSource(qsizetype lines) {
+  using namespace Qt::StringLiterals;
+  QStringList ret = {u"         BR      main"_s};
+  for (qsizetype it = 0; ret.size() < lines - 1; it++) {
+    ret.push_back(u"v%1:     .WORD   %1"_s.arg(it));
+    ret.push_back(u"m%1:     LDWA    v%1,d       ;Load the value"_s.arg(it));
+    ret.push_back(u"         ADDA    %1,i"_s.arg(it % 100));
+    ret.push_back(u"         STWA    v%1,d"_s.arg(it));
+    ret.push_back(u"         ASRA"_s);
+    ret.push_back(u"         BRNE    m%1"_s.arg(it));
+  }
+  ret.push_back(u"main:    BR      main"_s);
+  return ret.join("\n");
+}
+
+Measurement assembleLarge() {
+  auto registry = helpers::registry(helpers::book(6), {});
+  auto source = generateSource(asmLines);
+  helpers::AsmHelper helper(registry, fullOS());
+  helper.setUserText(source);
+  bool ok = false;
+  auto ret = measure(asmLines, [&]() { ok = helper.assemble(); });
+  if (!ok)
+    throw std::runtime_error(helper.errors().join("\n").toStdString());
+  return ret;
+}
+
+QList<Workload> workloads() {
+  using namespace Qt::StringLiterals;
+  using Kind = Workload::Kind;
+  QList<Workload> ret;
+  ret.push_back({Kind::Simulator, "bare-br", "BR loop on a CPU attached directly to memory", &bareBranch});
+  for (const auto &program : programs()) {
+    auto source = program.source;
+    ret.push_back({Kind::Simulator, program.name, program.description,
+                   [source](quint64 ticks) { return simulate(source, false, ticks); }});
+    ret.push_back({Kind::Simulator, program.name + "+trace", program.description + ", with a trace buffer",
+                   [source](quint64 ticks) { return simulate(source, true, ticks); }});
+  }
+  ret.push_back({Kind::Assembler, "asm-large", u"Assemble a generated %1 line program"_s.arg(asmLines),
+                 [](quint64) { return assembleLarge(); }});
+  return ret;
+}
+
+QJsonObject report(const Workload &workload, const Measurement &m) {
+  QJsonObject ret{{"name", workload.name}};
+  double seconds = m.elapsed.count() / 1e9;
+  double perSecond = seconds > 0 ? m.count / seconds : 0;
+  double nsPer = m.count > 0 ? double(m.elapsed.count()) / m.count : 0;
+  ret["seconds"] = seconds;
+  if (workload.kind == Workload::Kind::Simulator) {
+    ret["ticks"] = qint64(m.count);
+    // Every tick of an ISA-level system executes one instruction.
+    ret["ips"] = perSecond;
+    ret["nsPerTick"] = nsPer;
+  } else {
+    ret["lines"] = qint64(m.count);
+    ret["linesPerSecond"] = perSecond;
+    ret["nsPerLine"] = nsPer;
+  }
+  ret["peakRSS"] = qint64(peakRSS());
+  return ret;
+}
+} // namespace
+
+ThroughputTask::ThroughputTask(QObject *parent) : Task(parent) {}
+
+void ThroughputTask::run() {
+  using namespace Qt::StringLiterals;
+  auto all = workloads();
+  if (_list) {
+    for (const auto &workload : all)
+      std::cout << workload.name.leftJustified(16).toStdString() << workload.description.toStdString() << std::endl;
+    return emit finished(0);
+  }
+
+  QList<Workload> selected;
+  for (const auto &name : _workloads) {
+    auto it = std::find_if(all.cbegin(), all.cend(), [&](const Workload &w) { return w.name == name; });
+    if (it == all.cend()) {
+      std::cerr << "Unknown workload: " << name.toStdString() << std::endl;
+      return emit finished(1);
+    }
+    selected.push_back(*it);
+  }
+  if (_workloads.isEmpty())
+    selected = all;
+
+  QJsonArray results;
+  bool failed = false;
+  for (const auto &workload : selected) {
+    try {
+      results.append(report(workload, workload.run(_ticks)));
+    } catch (const std::exception &e) {
+      results.append(QJsonObject{{"name", workload.name}, {"error", QString::fromStdString(e.what())}});
+      failed = true;
+    }
+  }
+
+  auto json = QJsonDocument(QJsonObject{{"results", results}}).toJson();
+  if (_output == "-")
+    std::cout << json.toStdString();
+  else if (QFile f(QString::fromStdString(_output)); f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    f.write(json);
+  else {
+    std::cerr << "Failed to open output: " << _output << std::endl;
+    return emit finished(1);
+  }
+  emit finished(failed ? 1 : 0);
+}
+
+void ThroughputTask::setWorkloads(QStringList names) { _workloads = names; }
+
+void ThroughputTask::setTicks(quint64 ticks) { _ticks = ticks; }
+
+void ThroughputTask::setOutput(std::string fname) { _output = fname; }
+
+void ThroughputTask::setList(bool list) { _list = list; }
@@ -18,6 +18,7 @@
 #include "../shared.hpp"
 #include "../task.hpp"
 
+// Runs named benchmark workloads, and reports their results as JSON.
 class ThroughputTask : public Task {
   Q_OBJECT
 public:
@@ -25,13 +26,46 @@ public:
   ;
   ~ThroughputTask() = default;
   void run();
+  // Only run the named workloads. If empty, all workloads are run.
+  void setWorkloads(QStringList names);
+  // Number of ticks simulated by each simulator workload.
+  void setTicks(quint64 ticks);
+  // Write the JSON report to fname instead of stdout.
+  void setOutput(std::string fname);
+  // Print workload names and descriptions instead of running them.
+  void setList(bool list);
+
+private:
+  QStringList _workloads = {};
+  quint64 _ticks = 1'000'000;
+  std::string _output = "-";
+  bool _list = false;
 };
 
 void registerThroughput(auto &app, task_factory_t &task, detail::SharedFlags &flags) {
+  static std::vector<std::string> workloads;
+  static quint64 ticks = 1'000'000;
+  static std::string output = "-";
+  static bool list = false;
   static auto instrThruSC = app.add_subcommand("mit", "Measure instruction throughput");
   instrThruSC->group("");
+  instrThruSC->add_option("-w,--workload", workloads, "Workload to run. May be repeated. Defaults to all workloads.");
+  instrThruSC->add_option("-n,--ticks", ticks, "Number of ticks simulated by each simulator workload.")
+      ->default_val(1'000'000);
+  instrThruSC->add_option("-o,--output", output, "File to which the JSON report will be written.")->default_val("-");
+  instrThruSC->add_flag("--list", list, "List the available workloads.");
   instrThruSC->callback([&]() {
     flags.kind = detail::SharedFlags::Kind::TERM;
-    task = [](QObject *parent) { return new ThroughputTask(parent); };
+    task = [](QObject *parent) {
+      auto ret = new ThroughputTask(parent);
+      QStringList names;
+      for (const auto &name : workloads)
+        names.push_back(QString::fromStdString(name));
+      ret->setWorkloads(names);
+      ret->setTicks(ticks);
+      ret->setOutput(output);
+      ret->setList(list);
+      return ret;
+    };
   });
 }
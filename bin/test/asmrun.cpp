@@ -201,4 +201,35 @@ TEST_CASE("Terminal, asmrun", "[term][cli]") {
       CHECK(out(term) == "C\n");
     }
   }
+
+  SECTION("Batch manifest with a source job") {
+    QTemporaryDir dir;
+    // Create user source and manifest
+    {
+      auto in_prog = QFile(dir.filePath("in.pep"));
+      REQUIRE(in_prog.open(QIODevice::WriteOnly));
+      in_prog.write("LDBA 'H',i\nSTBA charOut,d\nLDBA 'i',i\nSTBA charOut,d\nRET\n");
+      in_prog.close();
+
+      auto manifest = QFile(dir.filePath("manifest.json"));
+      REQUIRE(manifest.open(QIODevice::WriteOnly));
+      manifest.write(R"([{"obj": "in.pep", "charOut": "out.txt", "result": "in.json"}])");
+      manifest.close();
+    }
+    // Execute
+    {
+      QProcess term;
+      term.setWorkingDirectory(dir.path());
+      term.start(path, {"run", "--batch", "-s", "manifest.json"});
+      wait_return(term, 0);
+    }
+    auto result_f = QFile(dir.filePath("in.json"));
+    REQUIRE(result_f.open(QIODevice::ReadOnly));
+    auto result = QJsonDocument::fromJson(result_f.readAll()).object();
+    CHECK(result["status"].toString().toStdString() == "halted");
+    CHECK(result["charOut"].toString().toStdString() == "Hi");
+    auto out_f = QFile(dir.filePath("out.txt"));
+    REQUIRE(out_f.open(QIODevice::ReadOnly));
+    CHECK(out_f.readAll().toStdString() == "Hi");
+  }
 }
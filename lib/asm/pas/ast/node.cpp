@@ -31,15 +31,35 @@ const QMap<uint8_t, QVariant> pas::ast::Node::attributes() const {
   auto ret = _attributes;
   // Attempt to prevent common data from being modified
   ret.detach();
+  auto box = [&ret](const auto &slot) {
+    if (slot) ret[slot->attribute] = QVariant::fromValue(*slot);
+  };
+  box(_slots.type), box(_slots.parent), box(_slots.children), box(_slots.location);
+  box(_slots.symbol), box(_slots.argument), box(_slots.address);
   return ret;
 }
 
 void pas::ast::Node::fromAttributes(const QMap<uint8_t, QVariant> attributes) {
   for (auto key = attributes.keyBegin(); key != attributes.keyEnd(); ++key) {
-    _attributes[*key] = attributes[*key];
+    const auto &value = attributes[*key];
+    auto unbox = [&](auto &slot) {
+      using T = typename std::remove_reference_t<decltype(slot)>::value_type;
+      if (*key != T::attribute) return false;
+      slot = value.value<T>();
+      return true;
+    };
+    if (!(unbox(_slots.type) || unbox(_slots.parent) || unbox(_slots.children) || unbox(_slots.location) ||
+          unbox(_slots.symbol) || unbox(_slots.argument) || unbox(_slots.address)))
+      _attributes[*key] = value;
   }
 }
 
+void pas::ast::Node::throwMissing() {
+  static const char *const e = "Cannot convert";
+  qCritical(e);
+  throw std::logic_error(e);
+}
+
 QWeakPointer<const pas::ast::Node> pas::ast::parent(const Node &node) { return node.get<generic::Parent>().value; }
 
 QWeakPointer<pas::ast::Node> pas::ast::parent(Node &node) { return node.get<generic::Parent>().value; }
@@ -48,15 +68,18 @@ void pas::ast::setParent(Node &node, QWeakPointer<Node> parent) { node.set<gener
 
 const pas::ast::generic::Type pas::ast::type(const Node &node) { return node.get<generic::Type>(); }
 
-QList<QSharedPointer<pas::ast::Node>> pas::ast::children(Node &node) { return node.get<generic::Children>().value; }
-
-QList<QSharedPointer<pas::ast::Node>> pas::ast::children(const Node &node) {
-  return node.get<generic::Children>().value;
+const QList<QSharedPointer<pas::ast::Node>> &pas::ast::children(const Node &node) {
+  if (auto children = node.find<generic::Children>(); children) return children->value;
+  static const char *const e = "Cannot convert";
+  qCritical(e);
+  throw std::logic_error(e);
 }
+
 void pas::ast::addChild(Node &parent, QSharedPointer<Node> child) {
-  auto childList = children(parent);
-  childList.append(child);
-  parent.set(generic::Children{.value = childList});
+  // Append in place, rather than copying (and detaching) the list and replacing it.
+  auto children = parent.take<generic::Children>();
+  children.value.append(child);
+  parent.set(std::move(children));
 }
 
 QSharedPointer<pas::ast::Node> pas::ast::addError(QSharedPointer<Node> node, generic::Message msg) {
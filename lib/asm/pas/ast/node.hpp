@@ -17,6 +17,12 @@
 
 #pragma once
 
+#include "./generic/attr_address.hpp"
+#include "./generic/attr_argument.hpp"
+#include "./generic/attr_children.hpp"
+#include "./generic/attr_location.hpp"
+#include "./generic/attr_parent.hpp"
+#include "./generic/attr_symbol.hpp"
 #include "./generic/attr_type.hpp"
 #include "./op.hpp"
 #include "asm/pas/ast/generic/attr_error.hpp"
@@ -53,36 +59,93 @@ public:
   void apply_self_if_void(ops::ConstOp<bool> &predicate,
                           ops::MutatingOp<T> &transform);
 
+  // Non-copying access to the typed slot for T. Returns nullptr if T is not
+  // stored in a slot, or if the node does not have that attribute.
+  template <typename T> const T *find() const;
+
 private:
+  // Attributes which (nearly) every node has, or which are read by most
+  // visitors, are stored in typed slots. Reading them does not box/unbox a
+  // QVariant or search a map. All other attributes are stored in the map.
+  struct Slots {
+    std::optional<generic::Type> type;
+    std::optional<generic::Parent> parent;
+    std::optional<generic::Children> children;
+    std::optional<generic::SourceLocation> location;
+    std::optional<generic::SymbolDeclaration> symbol;
+    std::optional<generic::Argument> argument;
+    std::optional<generic::Address> address;
+  } _slots;
+  template <typename T>
+  static constexpr bool slotted =
+      std::is_same_v<T, generic::Type> || std::is_same_v<T, generic::Parent> ||
+      std::is_same_v<T, generic::Children> ||
+      std::is_same_v<T, generic::SourceLocation> ||
+      std::is_same_v<T, generic::SymbolDeclaration> ||
+      std::is_same_v<T, generic::Argument> ||
+      std::is_same_v<T, generic::Address>;
+  template <typename T> std::optional<T> &slot();
+  template <typename T> const std::optional<T> &slot() const {
+    return const_cast<Node *>(this)->slot<T>();
+  }
   QMap<uint8_t, QVariant> _attributes;
+  [[noreturn]] static void throwMissing();
 };
 
-template <typename T> bool Node::has() const { return _attributes.contains(T::attribute); }
+template <typename T> std::optional<T> &Node::slot() {
+  if constexpr (std::is_same_v<T, generic::Type>) return _slots.type;
+  else if constexpr (std::is_same_v<T, generic::Parent>) return _slots.parent;
+  else if constexpr (std::is_same_v<T, generic::Children>)
+    return _slots.children;
+  else if constexpr (std::is_same_v<T, generic::SourceLocation>)
+    return _slots.location;
+  else if constexpr (std::is_same_v<T, generic::SymbolDeclaration>)
+    return _slots.symbol;
+  else if constexpr (std::is_same_v<T, generic::Argument>)
+    return _slots.argument;
+  else return _slots.address;
+}
+
+template <typename T> bool Node::has() const {
+  if constexpr (slotted<T>) return slot<T>().has_value();
+  else return _attributes.contains(T::attribute);
+}
+
+template <typename T> const T *Node::find() const {
+  static_assert(slotted<T>, "Only attributes stored in slots can be found");
+  if (auto &value = slot<T>(); value) return &*value;
+  return nullptr;
+}
 
 template <typename T> const T Node::get() const {
-  QVariant attribute = _attributes[T::attribute];
-  if (attribute.userType() != qMetaTypeId<T>()) {
-    static const char *const e = "Cannot convert";
-    qCritical(e);
-    throw std::logic_error(e);
+  if constexpr (slotted<T>) {
+    if (auto &value = slot<T>(); value) return *value;
+    throwMissing();
+  } else {
+    QVariant attribute = _attributes[T::attribute];
+    if (attribute.userType() != qMetaTypeId<T>()) throwMissing();
+    return attribute.value<T>();
   }
-  return attribute.value<T>();
 }
 
 template <typename T> T Node::take() {
-  QVariant attribute = _attributes[T::attribute];
-  if (attribute.userType() != qMetaTypeId<T>()) {
-    static const char *const e = "Cannot convert";
-    qCritical(e);
-    throw std::logic_error(e);
+  if constexpr (slotted<T>) {
+    auto &value = slot<T>();
+    if (!value) throwMissing();
+    T ret = std::move(*value);
+    value.reset();
+    return ret;
+  } else {
+    QVariant attribute = _attributes[T::attribute];
+    if (attribute.userType() != qMetaTypeId<T>()) throwMissing();
+    _attributes.remove(T::attribute);
+    return attribute.value<T>();
   }
-  _attributes.remove(T::attribute);
-  return attribute.value<T>();
 }
 
 template <typename T> void Node::set(T attribute) {
-  // static_assert(QVariant::fromValue(attribute));
-  _attributes[T::attribute] = QVariant::fromValue(attribute);
+  if constexpr (slotted<T>) slot<T>() = std::move(attribute);
+  else _attributes[T::attribute] = QVariant::fromValue(attribute);
 }
 
 template <typename T> T Node::apply_self(ops::ConstOp<T> &transform) const {
@@ -99,8 +162,9 @@ void setParent(Node &node, QWeakPointer<Node> parent);
 const generic::Type type(const Node &node);
 // TODO: add custom iterator so that I can have QSharedPointer<const Node>
 // override;
-QList<QSharedPointer<Node>> children(const Node &node);
-QList<QSharedPointer<Node>> children(Node &node);
+// Does not copy the list. The reference is invalidated if the node's children
+// are replaced (e.g., by set<generic::Children>).
+const QList<QSharedPointer<Node>> &children(const Node &node);
 // Does not update child's parent pointer.
 void addChild(Node &parent, QSharedPointer<Node> child);
 void setAddress(Node &node, quint64 start, quint64 size);
@@ -162,7 +226,10 @@ void apply_recurse(const Node &node, ops::ConstOp<T> &transform) {
 template <typename T>
 void apply_recurse(Node &node, ops::MutatingOp<T> &transform) {
   node.apply_self(transform);
-  for (auto &child : children(node))
+  // transform may replace the children of node, so iterate over a (shallow)
+  // copy of the list.
+  const auto kids = children(node);
+  for (auto &child : kids)
     apply_recurse(*child, transform);
 }
 
@@ -180,7 +247,9 @@ template <typename T>
 void apply_recurse_if(Node &node, ops::ConstOp<bool> &predicate,
                       ops::MutatingOp<T> &transform) {
   apply_self_if_void(node, predicate, transform);
-  for (auto &child : children(node))
+  // See apply_recurse.
+  const auto kids = children(node);
+  for (auto &child : kids)
     apply_recurse_if(*child, predicate, transform);
 }
 } // namespace pas::ast
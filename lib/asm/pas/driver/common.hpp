@@ -17,6 +17,7 @@
 
 #pragma once
 #include <QtCore>
+#include <exception>
 
 namespace symbol {
 class Entry;
@@ -88,6 +89,12 @@ template <typename stage> struct Pipeline {
   using target_ptr = QSharedPointer<Target<stage>>;
   using transform_list = QList<QSharedPointer<Transform<stage>>>;
   QList<QPair<target_ptr, transform_list>> pipelines;
+  // If set, targets advance concurrently on the global thread pool. Otherwise, targets are assembled one after another.
+  bool concurrent = false;
+  // Stages which depend on the work of earlier targets (e.g., importing the OS's exports). When concurrent, a target
+  // may not run the transform starting at stage S until every earlier target has finished or reached waitFor[S].
+  // Transforms starting at any other stage must only modify their own target.
+  QMap<stage, stage> waitFor;
   bool assemble(stage target);
 };
 
@@ -96,16 +103,90 @@ template <typename stage> struct Pipeline {
 // target has its own pipeline How do I insert passess with side effects that do
 // not change the stage? -- Transforms can start and end in the same stage.
 template <typename stage> bool Pipeline<stage>::assemble(stage targetStage) {
-  for (auto &[target, ops] : this->pipelines) {
-    for (auto &op : ops) {
-      // Must explicitly deref op, or will attempt to call operator() on
-      // QSharedPointer<>.
-      if (op->operator()(globals, target)) target->stage = op->toStage();
-      else return false;
-      if ((int)target->stage > (int)targetStage) break;
+  if (!concurrent) {
+    for (auto &[target, ops] : this->pipelines) {
+      for (auto &op : ops) {
+        // Must explicitly deref op, or will attempt to call operator() on
+        // QSharedPointer<>.
+        if (op->operator()(globals, target)) target->stage = op->toStage();
+        else return false;
+        if ((int)target->stage > (int)targetStage) break;
+      }
     }
+    return true;
   }
-  return true;
+
+  // Shared with workers, so that the mutex outlives any worker which is still releasing it.
+  struct State {
+    QMutex mutex;
+    QWaitCondition changed;
+    // Index of the next transform of each target, and if that transform is executing.
+    QList<qsizetype> next;
+    QList<bool> running;
+    bool failed = false;
+    std::exception_ptr error = nullptr;
+  };
+  auto state = QSharedPointer<State>::create();
+  state->next.fill(0, pipelines.size()), state->running.fill(false, pipelines.size());
+
+  // The following helpers must only be called while holding the mutex.
+  auto done = [this, &state, targetStage](qsizetype it) {
+    auto &[target, ops] = pipelines.at(it);
+    return state->next[it] >= ops.size() || (int)target->stage > (int)targetStage;
+  };
+  auto ready = [this, &state, &done](qsizetype it) {
+    if (state->running[it] || done(it)) return false;
+    auto required = waitFor.constFind(pipelines.at(it).first->stage);
+    if (required == waitFor.cend()) return true;
+    for (qsizetype prev = 0; prev < it; prev++)
+      if (!done(prev) && (int)pipelines.at(prev).first->stage < (int)required.value()) return false;
+    return true;
+  };
+  // Runs a target's index'th transform, which must have been marked as running.
+  auto step = [this, state](qsizetype it, qsizetype index) {
+    auto &[target, ops] = pipelines.at(it);
+    auto &op = ops.at(index);
+    bool success = false;
+    std::exception_ptr error = nullptr;
+    try {
+      success = op->operator()(globals, target);
+    } catch (...) {
+      error = std::current_exception();
+    }
+    QMutexLocker locker(&state->mutex);
+    if (success) target->stage = op->toStage();
+    else state->failed = true;
+    if (error && !state->error) state->error = error;
+    state->next[it]++, state->running[it] = false;
+    state->changed.wakeAll();
+  };
+
+  auto pool = QThreadPool::globalInstance();
+  QMutexLocker locker(&state->mutex);
+  while (true) {
+    qsizetype local = -1, localIndex = 0;
+    // After a failure, let in-flight transforms finish, but do not start new ones.
+    for (qsizetype it = 0; !state->failed && it < pipelines.size(); it++) {
+      if (!ready(it)) continue;
+      state->running[it] = true;
+      // Keep one transform for this thread rather than idling while the pool does the work.
+      if (local < 0) local = it, localIndex = state->next[it];
+      else pool->start([step, it, index = state->next[it]]() { step(it, index); });
+    }
+    if (local >= 0) {
+      locker.unlock();
+      step(local, localIndex);
+      locker.relock();
+    } else if (state->running.contains(true)) {
+      // If assemble was itself called from the pool, let the pool use this thread's slot while it is blocked.
+      bool inPool = pool->contains(QThread::currentThread());
+      if (inPool) pool->releaseThread();
+      state->changed.wait(&state->mutex);
+      if (inPool) pool->reserveThread();
+    } else break;
+  }
+  if (state->error) std::rethrow_exception(state->error);
+  return !state->failed;
 }
 
 } // namespace pas::driver
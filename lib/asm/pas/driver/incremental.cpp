@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "./incremental.hpp"
+#include "asm/pas/ast/generic/attr_children.hpp"
+#include "asm/pas/ast/generic/attr_location.hpp"
+#include "asm/pas/ast/generic/attr_symbol.hpp"
+#include "asm/pas/ast/generic/attr_type.hpp"
+#include "asm/pas/ast/node.hpp"
+#include "asm/pas/operations/generic/instantiate.hpp"
+#include "asm/symbol/table.hpp"
+
+pas::driver::IncrementalParser::IncrementalParser(parse_fn parser) : _parser(parser) {}
+
+pas::driver::ParseResult pas::driver::IncrementalParser::operator()(QString text, QSharedPointer<ast::Node> parent) {
+  using namespace ast::generic;
+  if (parent.isNull()) {
+    static const Type structuralType = {.value = Type::Structural};
+    parent = QSharedPointer<ast::Node>::create(structuralType);
+    parent->set(SymbolTable{.value = QSharedPointer<symbol::Table>::create(2)});
+  }
+  auto table = parent->get<SymbolTable>().value;
+
+  auto lines = text.split('\n');
+  // The newline which terminates the final line does not begin another (blank) line.
+  if (lines.size() > 1 && lines.back().isEmpty()) lines.removeLast();
+
+  ParseResult ret = {.hadError = false, .root = parent};
+  QHash<QString, ParseResult> seen;
+  _parsedLines = 0;
+  for (int it = 0; it < lines.size(); it++) {
+    auto line = lines[it];
+    // Newlines may be \r\n, whose \r must not be parsed as part of the line.
+    if (line.endsWith('\r')) line.chop(1);
+    ParseResult parsed;
+    if (auto cached = seen.constFind(line); cached != seen.cend()) parsed = *cached;
+    else if (auto old = _lines.constFind(line); old != _lines.cend()) parsed = seen[line] = *old;
+    else {
+      parsed = seen[line] = _parser(line, nullptr);
+      _parsedLines++;
+    }
+
+    ret.hadError |= parsed.hadError;
+    ret.errors.append(parsed.errors);
+    for (const auto &child : ast::children(*parsed.root)) {
+      auto copy = ops::generic::instantiate(*child, *parent, table);
+      // Each line was parsed as if it were the first line of a program.
+      if (copy->has<SourceLocation>()) copy->set(SourceLocation{.value = {.line = it, .valid = true}});
+    }
+  }
+  _lines = std::move(seen);
+  return ret;
+}
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+#include <functional>
+#include "./common.hpp"
+
+namespace pas::driver {
+// Parses a program one line at a time, remembering the parse of each distinct line. Re-parsing an edited program only
+// runs the underlying parser over lines which it has not seen before. Every other line is cloned from its previous parse
+// and bound to the new program's symbol table, so the result is indistinguishable from parsing the whole program.
+// Relies on each line of the grammar parsing independently of its neighbors, which holds for the Pep/N grammars.
+class IncrementalParser {
+public:
+  using parse_fn = std::function<ParseResult(QString, QSharedPointer<ast::Node>)>;
+  explicit IncrementalParser(parse_fn parser);
+  // Same signature as parse_fn, so that it may be used in place of the parser it wraps.
+  ParseResult operator()(QString text, QSharedPointer<ast::Node> parent);
+  // Number of lines passed to the underlying parser by the most recent call.
+  qsizetype parsedLines() const { return _parsedLines; }
+
+private:
+  parse_fn _parser;
+  // Keyed on line text. Lines absent from the most recent program are dropped, so the cache does not grow without bound
+  // as a program is edited.
+  QHash<QString, ParseResult> _lines;
+  qsizetype _parsedLines = 0;
+};
+} // namespace pas::driver
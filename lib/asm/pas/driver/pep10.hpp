@@ -41,11 +41,13 @@ Q_ENUM_NS(Stage);
 
 template <typename ParserTag> class TransformParse : public driver::Transform<Stage> {
 public:
+  // If set, replaces the default parser (e.g., with an IncrementalParser).
+  std::function<ParseResult(QString, QSharedPointer<ast::Node>)> parser = nullptr;
   bool operator()(QSharedPointer<Globals>, QSharedPointer<pas::driver::Target<Stage>> target) override {
 
     auto source = target->bodies[repr::Source::name];
     auto body = source.value<repr::Source>().value;
-    auto parser = pas::driver::pepp::createParser<isa::Pep10, ParserTag>(false);
+    auto parser = this->parser ? this->parser : pas::driver::pepp::createParser<isa::Pep10, ParserTag>(false);
     auto parsed = parser(body, nullptr);
     int it = 0;
     auto children = pas::ast::children(*parsed.root);
@@ -110,6 +112,8 @@ public:
 struct Features {
   bool isOS = false;
   bool ignoreUndefinedSymbols = false;
+  // See TransformParse::parser.
+  std::function<ParseResult(QString, QSharedPointer<ast::Node>)> parser = nullptr;
 };
 
 struct TargetDefinition {
@@ -128,7 +132,9 @@ QPair<QSharedPointer<Target<Stage>>, QList<QSharedPointer<Transform<Stage>>>> st
   target->bodies[repr::Source::name] = QVariant::fromValue(repr::Source{.value = body});
 
   QList<QSharedPointer<Transform<Stage>>> pipe;
-  pipe.push_back(QSharedPointer<TransformParse<ParserTag>>::create());
+  auto parse = QSharedPointer<TransformParse<ParserTag>>::create();
+  parse->parser = feats.parser;
+  pipe.push_back(parse);
   pipe.push_back(QSharedPointer<TransformIncludeMacros<ParserTag>>::create());
   pipe.push_back(QSharedPointer<TransformFlattenMacros>::create());
   pipe.push_back(QSharedPointer<TransformGroup>::create());
@@ -152,6 +158,11 @@ QSharedPointer<driver::Pipeline<Stage>> pipeline(QList<QPair<QString, Features>>
   if (registry) ret->globals->macroRegistry = registry;
   else ret->globals->macroRegistry = QSharedPointer<macro::Registry>::create();
   for (auto &[body, feats] : targets) ret->pipelines.push_back(stages<ParserTag>(body, feats));
+  // Single-threaded builds (e.g., WASM) have nothing to gain from scheduling work on the pool.
+  ret->concurrent = QThreadPool::globalInstance()->maxThreadCount() > 1;
+  // User programs expand the OS's system call macros, so they must wait for the OS to register them. They also link
+  // against the exports of earlier targets, which must not change underneath them.
+  ret->waitFor = {{Stage::IncludeMacros, Stage::AssignAddresses}, {Stage::RegisterExports, Stage::End}};
   return ret;
 }
 } // namespace pas::driver::pep10
@@ -115,6 +115,10 @@ QSharedPointer<driver::Pipeline<Stage>> pipeline(QList<QPair<QString, Features>>
   if (registry) ret->globals->macroRegistry = registry;
   else ret->globals->macroRegistry = QSharedPointer<macro::Registry>::create();
   for (auto &[body, feats] : targets) ret->pipelines.push_back(stages<ParserTag>(body, feats));
+  // Single-threaded builds (e.g., WASM) have nothing to gain from scheduling work on the pool.
+  ret->concurrent = QThreadPool::globalInstance()->maxThreadCount() > 1;
+  // User programs link against the exports of earlier targets, which must not change underneath them.
+  ret->waitFor = {{Stage::RegisterExports, Stage::End}};
   return ret;
 }
 } // namespace pas::driver::pep9
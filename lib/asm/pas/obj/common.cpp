@@ -1,8 +1,49 @@
 #include "./common.hpp"
+#include <algorithm>
 #include <elfio/elfio.hpp>
 #include "asm/symbol/table.hpp"
 
 static const auto strTabStr = ".strtab";
+
+void pas::obj::common::StringPool::add(std::string str) { _strings.emplace_back(std::move(str)); }
+
+std::unordered_map<std::string, ELFIO::Elf_Word> pas::obj::common::StringPool::build(std::string &data) const {
+  // Every string table begins with the empty string.
+  if (data.empty()) data.push_back('\0');
+  // In descending order of reversed text, a string is a suffix of another only if it is a suffix of the nearest
+  // preceding string which was emitted.
+  auto strings = _strings;
+  auto reversedGreater = [](const std::string &lhs, const std::string &rhs) {
+    return std::lexicographical_compare(rhs.crbegin(), rhs.crend(), lhs.crbegin(), lhs.crend());
+  };
+  std::sort(strings.begin(), strings.end(), reversedGreater);
+  strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+
+  std::unordered_map<std::string, ELFIO::Elf_Word> ret;
+  const std::string *emitted = nullptr;
+  ELFIO::Elf_Word emittedOffset = 0;
+  for (const auto &str : strings) {
+    if (str.empty()) ret[str] = 0;
+    else if (emitted != nullptr && emitted->ends_with(str))
+      ret[str] = emittedOffset + ELFIO::Elf_Word(emitted->size() - str.size());
+    else {
+      emitted = &str, emittedOffset = ELFIO::Elf_Word(data.size());
+      data.append(str);
+      data.push_back('\0');
+      ret[str] = emittedOffset;
+    }
+  }
+  return ret;
+}
+
+void pas::obj::common::poolSectionNames(ELFIO::elfio &elf) {
+  StringPool pool;
+  for (auto &sec : elf.sections) pool.add(sec->get_name());
+  std::string data;
+  auto offsets = pool.build(data);
+  elf.sections[elf.get_section_name_str_index()]->set_data(data.data(), ELFIO::Elf_Word(data.size()));
+  for (auto &sec : elf.sections) sec->set_name_string_offset(offsets.at(sec->get_name()));
+}
 ELFIO::section *pas::obj::common::addStrTab(ELFIO::elfio &elf) {
   ELFIO::section *strTab = nullptr;
   for (auto &sec : elf.sections) {
@@ -29,20 +70,17 @@ void pas::obj::common::writeSymtab(ELFIO::elfio &elf, symbol::Table &table, QStr
   symTab->set_entry_size(elf.get_default_entry_size(ELFIO::SHT_SYMTAB));
   symTab->set_link(strTab->get_index());
 
-  // Attempt to pool strings when possible, to reduce final binary size.
-  // Probably O(n^2), but n should be small for Pep/N.
-  ELFIO::string_section_accessor strAc(strTab);
-  auto findOrCreateStr = [&](const std::string &str) {
-    auto tabStart = strTab->get_data();
-    auto tabEnd = tabStart + strTab->get_size();
-    auto iter = std::search(tabStart, tabEnd, str.cbegin(), str.cend());
-    if (iter != tabEnd) return (ELFIO::Elf_Word)(iter - tabStart);
-    return strAc.add_string(str.data());
-  };
+  // Pool strings, to reduce final binary size. Existing contents are preserved, since the table may be shared.
+  StringPool pool;
+  for (auto [name, entry] : table.entries()) pool.add(name.toStdString());
+  std::string strData;
+  if (strTab->get_size() > 0) strData.assign(strTab->get_data(), strTab->get_size());
+  auto offsets = pool.build(strData);
+  strTab->set_data(strData.data(), ELFIO::Elf_Word(strData.size()));
 
   ELFIO::symbol_section_accessor symAc(elf, symTab);
   for (auto [name, entry] : table.entries()) {
-    auto nameIdx = findOrCreateStr(name.toStdString());
+    auto nameIdx = offsets.at(name.toStdString());
     auto secIdx = entry->section_index;
     auto value = entry->value;
 
@@ -1,6 +1,7 @@
 #pragma once
 #include <QtCore>
 #include <elfio/elfio.hpp>
+#include <unordered_map>
 #include "asm/pas/ast/generic/attr_sec.hpp"
 #include "asm/pas/ast/generic/attr_symbol.hpp"
 #include "asm/pas/ast/node.hpp"
@@ -9,8 +10,24 @@
 #include "asm/symbol/entry.hpp"
 
 namespace pas::obj::common {
+// Lays out the strings of an ELF string table, where a string which is a suffix of another (e.g., "x" in "max") shares
+// the longer string's storage. Sorting the strings by their reversed text places each string directly after the
+// strings it may be a suffix of, so layout is O(n log n) rather than searching the table once per string.
+class StringPool {
+public:
+  void add(std::string str);
+  // Append all added strings to data, which must be empty or begin with a null byte.
+  // Returns the offset in data of each added string.
+  std::unordered_map<std::string, ELFIO::Elf_Word> build(std::string &data) const;
+
+private:
+  std::vector<std::string> _strings;
+};
+
 ELFIO::section *addStrTab(ELFIO::elfio &elf);
 void writeSymtab(ELFIO::elfio &elf, symbol::Table &table, QString prefix);
+// Rebuild the section name table so that names are pooled by StringPool. Must be called after adding sections.
+void poolSectionNames(ELFIO::elfio &elf);
 template <typename ISA> void writeTree(ELFIO::elfio &elf, pas::ast::Node &node, QString prefix, bool isOS) {
   using namespace pas;
   using namespace Qt::StringLiterals;
@@ -79,10 +79,12 @@ void pas::obj::pep10::writeOS(ELFIO::elfio &elf, ast::Node &os) {
   }
   Q_ASSERT(symTab != nullptr);
   ::obj::addMMIODeclarations(elf, symTab, mmios);
+  common::poolSectionNames(elf);
 }
 
 void pas::obj::pep10::writeUser(ELFIO::elfio &elf, ast::Node &user) {
   common::writeTree<isa::Pep10>(elf, user, "usr", false);
+  common::poolSectionNames(elf);
 }
 
 void pas::obj::pep10::writeUser(ELFIO::elfio &elf, QList<quint8> bytes) {
@@ -97,4 +99,5 @@ void pas::obj::pep10::writeUser(ELFIO::elfio &elf, QList<quint8> bytes) {
   sec->set_data((const char *)bytes.constData(), size);
   auto seg = elf.segments[0];
   seg->add_section(sec, 1);
+  common::poolSectionNames(elf);
 }
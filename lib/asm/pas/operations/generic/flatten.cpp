@@ -26,7 +26,7 @@ void pas::ops::generic::flattenMacros(ast::Node &node) {
     for (auto &child : node.take<ast::generic::Children>().value) {
       flattenMacros(*child);
       if (isMacro()(*child)) {
-        for (auto &macroChild : child->get<ast::generic::Children>().value) newChildren.append(macroChild);
+        for (auto &macroChild : ast::children(*child)) newChildren.append(macroChild);
       } else newChildren.append(child);
     }
 
@@ -21,18 +21,23 @@
 #include "asm/pas/ast/generic/attr_comment_indent.hpp"
 #include "asm/pas/ast/generic/attr_directive.hpp"
 #include "asm/pas/ast/generic/attr_macro.hpp"
+#include "asm/pas/ast/generic/attr_parent.hpp"
 #include "asm/pas/ast/generic/attr_symbol.hpp"
+#include "asm/pas/ast/generic/attr_type.hpp"
 #include "asm/pas/ast/node.hpp"
 #include "asm/pas/ast/value/base.hpp"
 #include "asm/pas/ast/value/decimal.hpp"
+#include "asm/pas/ast/value/symbolic.hpp"
 #include "asm/pas/driver/common.hpp"
 #include "asm/pas/errors.hpp"
 #include "asm/pas/operations/generic/errors.hpp"
+#include "asm/pas/operations/generic/instantiate.hpp"
 #include "asm/pas/operations/generic/string.hpp"
 #include "is.hpp"
 #include "macro/macro.hpp"
 #include "macro/registered.hpp"
 #include "macro/registry.hpp"
+#include "asm/symbol/table.hpp"
 
 #include <asm/pas/ast/generic/attr_comment.hpp>
 
@@ -44,18 +49,52 @@ void appendError(pas::ast::Node &node, QString message) {
   node.set(err);
 }
 
-bool pas::ops::generic::IncludeMacros::operator()(ast::Node &node) {
+namespace {
+QString substitute(QString body, const QStringList &args) {
   using namespace Qt::StringLiterals;
+  for (int it = 0; it < args.size(); it++) body = body.replace(u"$"_s + QString::number(it + 1), args[it]);
+  return body;
+}
+
+// Number of placeholders in node and its children which can be replaced after parsing without changing the parse:
+// instruction operands, macro arguments, and comments.
+qsizetype countSubstitutable(const pas::ast::Node &node, const QStringList &placeholders) {
+  using namespace pas::ast::generic;
+  auto isPlaceholder = [&](const QSharedPointer<pas::ast::value::Base> &value) {
+    auto symbolic = dynamic_cast<const pas::ast::value::Symbolic *>(value.data());
+    return symbolic != nullptr && placeholders.contains(symbolic->symbol()->name);
+  };
+  qsizetype ret = 0;
+  auto type = node.get<Type>().value;
+  if (type == Type::Instruction && node.has<Argument>()) ret += isPlaceholder(node.get<Argument>().value);
+  else if (type == Type::MacroInvoke && node.has<ArgumentList>()) {
+    auto args = node.get<ArgumentList>().value;
+    ret += std::count_if(args.cbegin(), args.cend(), isPlaceholder);
+  }
+  if (node.has<Comment>())
+    for (const auto &placeholder : placeholders) ret += node.get<Comment>().value.count(placeholder);
+  for (const auto &child : pas::ast::children(node)) ret += countSubstitutable(*child, placeholders);
+  return ret;
+}
+
+// Operands which the parser would have accepted in place of an instruction's placeholder.
+bool fitsOperand(const QSharedPointer<pas::ast::value::Base> &value) {
+  return value->isFixedSize() && value->isNumeric() && value->requiredBytes() <= 2;
+}
+} // namespace
+
+bool pas::ops::generic::IncludeMacros::operator()(ast::Node &node) {
   // Node should be a macro
   if (!node.has<ast::generic::Macro>()) {
     appendError(node, errors::pepp::expectedAMacro);
     return false;
   }
   auto macroName = node.get<ast::generic::Macro>().value;
+  QList<QSharedPointer<ast::value::Base>> argValues = {};
+  if (node.has<ast::generic::ArgumentList>()) argValues = node.get<ast::generic::ArgumentList>().value;
+  else if (node.has<ast::generic::Argument>()) argValues.push_back(node.get<ast::generic::Argument>().value);
   QStringList args = {};
-  if (node.has<ast::generic::ArgumentList>()) {
-    for (auto &arg : node.get<ast::generic::ArgumentList>().value) args.push_back(arg->string());
-  } else if (node.has<ast::generic::Argument>()) args.push_back(node.get<ast::generic::Argument>().value->string());
+  for (const auto &arg : argValues) args.push_back(arg->string());
 
   auto macroInvoke = MacroInvocation{.macroName = macroName, .args = args};
   if (!pushMacroInvocation(macroInvoke)) {
@@ -72,13 +111,20 @@ bool pas::ops::generic::IncludeMacros::operator()(ast::Node &node) {
     appendError(node, errors::pepp::macroWrongArity.arg(macroName).arg(macroContents->argCount()).arg(args.size()));
     return false;
   }
-  // Perform macro arg substitution on body.
-  auto macroText = macroContents->body();
-  for (int it = 0; it < args.size(); it++) macroText = macroText.replace(u"$"_s + QString::number(it + 1), args[it]);
-
-  // Function handles parenting macroText's nodes as node's children.
-  // Parent/child relationships also established.
-  auto converted = convertFn(macroText, node.sharedFromThis());
+  driver::ParseResult converted;
+  const Template *tmpl = nullptr;
+  if (node.has<ast::generic::SymbolTable>()) tmpl = &parseTemplate(macroName, macroContents->body(), args.size());
+  if (tmpl != nullptr && tmpl->substitutable && std::all_of(argValues.cbegin(), argValues.cend(), fitsOperand)) {
+    converted = tmpl->parse;
+    Operands operands;
+    for (int it = 0; it < argValues.size(); it++) operands[tmpl->placeholders[it]] = argValues[it];
+    auto symtab = node.get<ast::generic::SymbolTable>().value;
+    for (const auto &child : ast::children(*converted.root)) instantiate(*child, node, symtab, operands);
+  } else {
+    // Function handles parenting macroText's nodes as node's children.
+    // Parent/child relationships also established.
+    converted = convertFn(substitute(macroContents->body(), args), node.sharedFromThis());
+  }
 
   if (converted.hadError) {
     for (auto &error : converted.errors) appendError(node, error);
@@ -101,6 +147,27 @@ bool pas::ops::generic::IncludeMacros::pushMacroInvocation(MacroInvocation invok
 
 void pas::ops::generic::IncludeMacros::popMacroInvocation(MacroInvocation invoke) { _chain.remove(invoke); }
 
+const pas::ops::generic::IncludeMacros::Template &
+pas::ops::generic::IncludeMacros::parseTemplate(const QString &macroName, const QString &body, int argCount) {
+  using namespace Qt::StringLiterals;
+  if (auto it = _templates.constFind(macroName); it != _templates.cend()) return *it;
+  static const auto structuralType = ast::generic::Type{.value = ast::generic::Type::Structural};
+  Template ret;
+  // Placeholders must lex as identifiers so that they parse wherever a symbol may appear.
+  for (int it = 0; it < argCount; it++) ret.placeholders.push_back(u"__macro_arg%1__"_s.arg(it + 1));
+  auto root = QSharedPointer<ast::Node>::create(structuralType);
+  // Symbols are only ever referenced by name from this table, so its pointer size is irrelevant.
+  root->set(ast::generic::SymbolTable{.value = QSharedPointer<symbol::Table>::create(2)});
+  auto text = substitute(body, ret.placeholders);
+  ret.parse = convertFn(text, root);
+  ret.parse.root = root;
+  // Every placeholder in the text must have been parsed somewhere it can be replaced.
+  qsizetype occurrences = 0;
+  for (const auto &placeholder : ret.placeholders) occurrences += text.count(placeholder);
+  ret.substitutable = !ret.parse.hadError && occurrences == countSubstitutable(*root, ret.placeholders);
+  return *_templates.insert(macroName, ret);
+}
+
 void pas::ops::generic::IncludeMacros::addExtraChildren(ast::Node &node) {
   using namespace Qt::StringLiterals;
   auto children = ast::children(node);
@@ -19,13 +19,10 @@
 #include <QtCore>
 #include "asm/pas/ast/node.hpp"
 #include "asm/pas/ast/op.hpp"
+#include "asm/pas/driver/common.hpp"
 #include "errors.hpp"
 #include "is.hpp"
 
-namespace pas::driver {
-class ParseResult;
-}
-
 namespace pas::ast {
 class Node;
 } // namespace pas::ast
@@ -56,6 +53,18 @@ struct IncludeMacros : public pas::ops::MutatingOp<bool> {
 
 private:
   QSet<MacroInvocation> _chain = {};
+  // Each macro's body is parsed once, with placeholder symbols for its arguments, beneath a detached root with a private
+  // symbol table. Invocations clone the template's nodes, replacing placeholders by their arguments and rebinding
+  // symbols to the invoking node's table.
+  struct Template {
+    driver::ParseResult parse;
+    QStringList placeholders;
+    // False if any argument appears somewhere the parse depends on its text, e.g., in an addressing mode or directive.
+    // Such macros are substituted and parsed per invocation.
+    bool substitutable = false;
+  };
+  QHash<QString, Template> _templates = {};
+  const Template &parseTemplate(const QString &macroName, const QString &body, int argCount);
 };
 
 // BUG: Shouldn't be inline, but MSVC refuses to find this function in a CPP file, when GCC and clang can.
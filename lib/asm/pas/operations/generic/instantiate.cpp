@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "./instantiate.hpp"
+#include "asm/pas/ast/generic/attr_argument.hpp"
+#include "asm/pas/ast/generic/attr_children.hpp"
+#include "asm/pas/ast/generic/attr_comment.hpp"
+#include "asm/pas/ast/generic/attr_parent.hpp"
+#include "asm/pas/ast/generic/attr_symbol.hpp"
+#include "asm/pas/ast/generic/attr_type.hpp"
+#include "asm/pas/ast/node.hpp"
+#include "asm/pas/ast/value/symbolic.hpp"
+#include "asm/symbol/entry.hpp"
+#include "asm/symbol/table.hpp"
+
+namespace {
+QSharedPointer<pas::ast::value::Base> rebind(const QSharedPointer<pas::ast::value::Base> &value, symbol::Table &table,
+                                             const pas::ops::generic::Operands &operands) {
+  if (auto symbolic = dynamic_cast<const pas::ast::value::Symbolic *>(value.data()); symbolic != nullptr) {
+    const auto &name = symbolic->symbol()->name;
+    if (auto it = operands.constFind(name); it != operands.cend()) return rebind(*it, table, {});
+    return QSharedPointer<pas::ast::value::Symbolic>::create(table.reference(name));
+  }
+  return value->clone();
+}
+} // namespace
+
+QSharedPointer<pas::ast::Node> pas::ops::generic::instantiate(const ast::Node &tmpl, ast::Node &parent,
+                                                              QSharedPointer<symbol::Table> table,
+                                                              const Operands &operands) {
+  using namespace ast::generic;
+  auto copy = QSharedPointer<ast::Node>::create(tmpl.get<Type>(), parent.sharedFromThis());
+  auto attributes = tmpl.attributes();
+  attributes.remove(Parent::attribute), attributes.remove(Children::attribute);
+  copy->fromAttributes(attributes);
+  if (copy->has<SymbolDeclaration>())
+    copy->set(SymbolDeclaration{.value = table->define(copy->get<SymbolDeclaration>().value->name)});
+  if (copy->has<Argument>()) copy->set(Argument{.value = rebind(copy->get<Argument>().value, *table, operands)});
+  if (copy->has<ArgumentList>()) {
+    auto args = copy->get<ArgumentList>().value;
+    for (auto &arg : args) arg = rebind(arg, *table, operands);
+    copy->set(ArgumentList{.value = args});
+  }
+  if (copy->has<Comment>() && !operands.isEmpty()) {
+    auto comment = copy->get<Comment>().value;
+    for (auto it = operands.cbegin(); it != operands.cend(); ++it) comment.replace(it.key(), it.value()->string());
+    copy->set(Comment{.value = comment});
+  }
+  // Nested macro invocations share the root symbol table, see PeppASTConverter::visitMacroInvokeLine.
+  if (copy->has<SymbolTable>()) copy->set(SymbolTable{.value = table});
+  ast::addChild(parent, copy);
+  for (const auto &child : ast::children(tmpl)) instantiate(*child, *copy, table, operands);
+  return copy;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+
+namespace pas::ast {
+class Node;
+namespace value {
+class Base;
+}
+} // namespace pas::ast
+namespace symbol {
+class Table;
+} // namespace symbol
+
+namespace pas::ops::generic {
+// Deep copy tmpl (and its children) as the last child of parent. Symbols declared or referenced by tmpl are replaced by
+// the same-named symbols in table, so the copy is indistinguishable from parsing tmpl's source directly beneath parent.
+// Symbolic arguments named by a key of operands are replaced by that key's value instead, and comments have each key
+// replaced by its value's text.
+using Operands = QHash<QString, QSharedPointer<ast::value::Base>>;
+QSharedPointer<ast::Node> instantiate(const ast::Node &tmpl, ast::Node &parent, QSharedPointer<symbol::Table> table,
+                                      const Operands &operands = {});
+} // namespace pas::ops::generic
@@ -52,7 +52,7 @@ quint16 pas::ops::pepp::detail::nodeToBytes(const pas::ast::Node &node, bits::sp
     return true;
   if (pas::ops::generic::isStructural()(node)) {
     std::size_t skipped = 0;
-    for (auto &child : node.get<ast::generic::Children>().value) {
+    for (auto &child : ast::children(node)) {
       auto size = nodeToBytes<ISA>(*child, dest.subspan(skipped));
       skipped += size;
     }
@@ -73,7 +73,7 @@ template <typename ISA> qsizetype pas::ops::pepp::explicitSize(const ast::Node &
     return 0;
   } else if (generic::isMacro()(node) || generic::isStructural()(node)) {
     qsizetype ret = 0;
-    for (auto &child : node.get<ast::generic::Children>().value) {
+    for (auto &child : ast::children(node)) {
       auto innerAt = at + (direction == Direction::Forward ? ret : -ret);
       ret += explicitSize<ISA>(*child, innerAt, direction);
     }
@@ -222,7 +222,7 @@ std::any parse::PeppASTConverter::visitDirectiveLine(PeppParser::DirectiveLineCo
   using convert_fn = void (PeppASTConverter::*)(QSharedPointer<Node>, PeppParser::DirectiveLineContext *);
   using namespace std::placeholders;
   // Must pass this manually, otherwise the first instance of our AST converter will be bound into the map.
-  static QMap<QString, convert_fn> converters = {
+  static const QMap<QString, convert_fn> converters = {
       {"ALIGN", &PeppASTConverter::align},   {"ASCII", &PeppASTConverter::ascii},
       {"BLOCK", &PeppASTConverter::block},   {"BURN", &PeppASTConverter::burn},
       {"BYTE", &PeppASTConverter::byte},     {"END", &PeppASTConverter::end},
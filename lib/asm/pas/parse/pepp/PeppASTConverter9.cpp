@@ -222,7 +222,7 @@ std::any parse::PeppASTConverter9::visitDirectiveLine(PeppParser::DirectiveLineC
   using convert_fn = void (PeppASTConverter9::*)(QSharedPointer<Node>, PeppParser::DirectiveLineContext *);
   using namespace std::placeholders;
   // Must pass this manually, otherwise the first instance of our AST converter will be bound into the map.
-  static QMap<QString, convert_fn> converters = {
+  static const QMap<QString, convert_fn> converters = {
       {"ADDRSS", &PeppASTConverter9::addrss}, {"ALIGN", &PeppASTConverter9::align},
       {"ASCII", &PeppASTConverter9::ascii},   {"BLOCK", &PeppASTConverter9::block},
       {"BURN", &PeppASTConverter9::burn},     {"BYTE", &PeppASTConverter9::byte},
@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "names.hpp"
+
+symbol::NamePool::id_t symbol::NamePool::intern(const QString &name) {
+  auto it = _ids.constFind(name);
+  if (it != _ids.cend()) return *it;
+  auto id = id_t(_names.size());
+  _ids.insert(name, id);
+  _names.push_back(name);
+  return id;
+}
+
+std::optional<symbol::NamePool::id_t> symbol::NamePool::find(const QString &name) const {
+  if (auto it = _ids.constFind(name); it != _ids.cend()) return *it;
+  return std::nullopt;
+}
+
+const QString &symbol::NamePool::name(id_t id) const { return _names[id]; }
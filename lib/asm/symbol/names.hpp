@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+#include <optional>
+#include <vector>
+
+namespace symbol {
+/*!
+ * \brief Interns symbol names, so that after a name is first seen, it is compared and hashed as an integer.
+ *
+ * IDs are dense and start at 0. A pool is shared by every table in a hierarchy, and is not thread safe.
+ */
+class NamePool {
+public:
+  using id_t = quint32;
+  //! Returns the ID for name, assigning one if name has not been seen before.
+  id_t intern(const QString &name);
+  //! Like intern(), but never assigns an ID.
+  std::optional<id_t> find(const QString &name) const;
+  const QString &name(id_t id) const;
+  qsizetype size() const { return _names.size(); }
+
+private:
+  QHash<QString, id_t> _ids;
+  QList<QString> _names;
+};
+
+/*!
+ * \brief An open-addressed hash map from interned names to T.
+ *
+ * Uses linear probing over a power-of-two array, which is kept at most half full. Elements are never removed, so no
+ * tombstones are required.
+ */
+template <typename T> class IdMap {
+public:
+  using id_t = NamePool::id_t;
+  T *find(id_t id);
+  const T *find(id_t id) const { return const_cast<IdMap *>(this)->find(id); }
+  //! Returns the value for id, inserting a default constructed value if id is not present.
+  T &operator[](id_t id);
+  std::size_t size() const { return _size; }
+
+private:
+  static constexpr id_t empty = ~id_t(0);
+  struct Slot {
+    id_t key = empty;
+    T value = {};
+  };
+  std::vector<Slot> _slots;
+  std::size_t _size = 0;
+  // Fibonacci hashing spreads sequential IDs across the table.
+  std::size_t home(id_t id) const { return (quint64(id) * 0x9E3779B97F4A7C15ull >> 32) & (_slots.size() - 1); }
+  void grow();
+};
+
+template <typename T> T *IdMap<T>::find(id_t id) {
+  if (_slots.empty()) return nullptr;
+  for (auto it = home(id);; it = (it + 1) & (_slots.size() - 1)) {
+    if (_slots[it].key == id) return &_slots[it].value;
+    else if (_slots[it].key == empty) return nullptr;
+  }
+}
+
+template <typename T> T &IdMap<T>::operator[](id_t id) {
+  if (auto existing = find(id); existing) return *existing;
+  if (2 * (_size + 1) > _slots.size()) grow();
+  auto it = home(id);
+  while (_slots[it].key != empty) it = (it + 1) & (_slots.size() - 1);
+  _size++;
+  _slots[it].key = id;
+  return _slots[it].value;
+}
+
+template <typename T> void IdMap<T>::grow() {
+  auto old = std::move(_slots);
+  _slots = std::vector<Slot>(std::max<std::size_t>(16, 2 * old.size()));
+  for (auto &slot : old) {
+    if (slot.key == empty) continue;
+    auto it = home(slot.key);
+    while (_slots[it].key != empty) it = (it + 1) & (_slots.size() - 1);
+    _slots[it] = std::move(slot);
+  }
+}
+} // namespace symbol
@@ -17,9 +17,12 @@
 
 #include "table.hpp"
 #include "visit.hpp"
-symbol::Table::Table(quint16 pointerSize) : _pointerSize(pointerSize) {}
+symbol::Table::Table(quint16 pointerSize)
+    : _pointerSize(pointerSize), _names(QSharedPointer<NamePool>::create()),
+      _index(QSharedPointer<IdMap<QList<entry_ptr_t>>>::create()) {}
 
-symbol::Table::Table(QSharedPointer<Table> parent) : parent(parent), _pointerSize(parent->_pointerSize) {}
+symbol::Table::Table(QSharedPointer<Table> parent)
+    : parent(parent), _pointerSize(parent->_pointerSize), _names(parent->_names), _index(parent->_index) {}
 
 QSharedPointer<symbol::Table> symbol::Table::addChild() {
   auto child = QSharedPointer<symbol::Table>::create(this->sharedFromThis());
@@ -50,25 +53,31 @@ std::optional<symbol::Table::entry_ptr_t> symbol::Table::import(Table &other, co
 }
 
 std::optional<symbol::Table::entry_ptr_t> symbol::Table::get(const QString &name) const {
-  if (auto item = _name_to_entry.find(name); item != _name_to_entry.end()) return item.value();
+  if (auto entry = find(name); entry) return entry;
   else return std::nullopt;
 }
 
+symbol::Table::entry_ptr_t symbol::Table::find(const QString &name) const {
+  // A name which has never been interned cannot be in any table.
+  auto id = _names->find(name);
+  if (!id) return nullptr;
+  auto entry = _id_to_entry.find(*id);
+  return entry ? *entry : nullptr;
+}
+
 symbol::Table::entry_ptr_t symbol::Table::reference(const QString &name) {
   // Create a local definition if one does not already exist
-  entry_ptr_t local_definition;
-  if (auto pair = _name_to_entry.find(name); pair == _name_to_entry.end()) {
+  auto id = _names->intern(name);
+  entry_ptr_t &local_definition = _id_to_entry[id];
+  if (local_definition.isNull()) {
     //  Symbol is  new, just add to map
     local_definition = QSharedPointer<symbol::Entry>::create(*this, name);
     _name_to_entry[name] = local_definition;
-  } else {
-    //  Get pointer to existing definition
-    local_definition = pair.value();
+    (*_index)[id].push_back(local_definition);
   }
 
   // Check for the presence of other symbols with the same name
-  auto as_ptr = this->sharedFromThis();
-  auto symbols = symbol::selectByName(as_ptr, name, TraversalPolicy::kWholeTree);
+  const auto symbols = *_index->find(id);
   int global_count = 0;
   for (auto &symbol : symbols) {
     if (&symbol->parent == &*this) continue; // We will be examining our symbols later.
@@ -98,12 +107,18 @@ symbol::Table::entry_ptr_t symbol::Table::reference(const QString &name) {
   return local_definition;
 }
 
+QList<symbol::Table::entry_ptr_t> symbol::Table::selectInTree(const QString &name) const {
+  auto id = _names->find(name);
+  if (!id) return {};
+  else if (auto entries = _index->find(*id); entries) return *entries;
+  return {};
+}
+
 symbol::Table::entry_ptr_t symbol::Table::define(const QString &name) {
   auto entry = reference(name);
 
   // Check for the presence of other symbols with the same name
-  auto as_ptr = this->sharedFromThis();
-  auto same_name = symbol::selectByName(as_ptr, name, TraversalPolicy::kWholeTree);
+  auto same_name = selectInTree(name);
 
   switch (entry->binding) {
   case symbol::Binding::kImported: entry->state = DefinitionState::kExternalMultiple; break;
@@ -135,10 +150,9 @@ void symbol::Table::markGlobal(const QString &name) {
   symbol->binding = symbol::Binding::kGlobal;
 
   // Check for the presence of other symbols with the same name
-  auto as_ptr = this->sharedFromThis();
   // Must gather all symbols from entire tree, otherwise some local references
   // may not be updated.
-  auto same_name = symbol::selectByName(as_ptr, name, TraversalPolicy::kWholeTree);
+  auto same_name = selectInTree(name);
 
   for (auto other : same_name) {
     if (&other->parent == &*this) continue; // We will be examining our symbols later.
@@ -159,7 +173,7 @@ void symbol::Table::markGlobal(const QString &name) {
   }
 }
 
-bool symbol::Table::exists(const QString &name) const { return _name_to_entry.find(name) != _name_to_entry.cend(); }
+bool symbol::Table::exists(const QString &name) const { return !find(name).isNull(); }
 auto symbol::Table::entries() const -> symbol::Table::const_range {
   return detail::asConstKeyValueRange(this->_name_to_entry);
 }
@@ -23,6 +23,7 @@
 #include <iostream>
 #include <optional>
 #include "entry.hpp"
+#include "names.hpp"
 // #include "visit.hpp"
 
 namespace symbol {
@@ -137,6 +138,9 @@ public:
   //! Returns true if this table (not checking any other table in the hierarchy)
   //! contains a symbol with the matching name.
   bool exists(const QString &name) const;
+  //! Returns every symbol with the matching name in this table's hierarchy.
+  //! Uses an index maintained by the hierarchy rather than walking the tree.
+  QList<entry_ptr_t> selectInTree(const QString &name) const;
 
   //! Return all symbols contained by the table.
   auto entries() const -> const_range;
@@ -154,6 +158,13 @@ public:
 private:
   quint16 _pointerSize;
   QList<QSharedPointer<Table>> _children;
+  // Names are interned by a pool shared with all other tables in the hierarchy.
+  QSharedPointer<NamePool> _names;
+  // All entries in the hierarchy, grouped by name. Shared with all other tables in the hierarchy.
+  QSharedPointer<IdMap<QList<entry_ptr_t>>> _index;
+  IdMap<entry_ptr_t> _id_to_entry;
+  // Lookups go through _id_to_entry. This map only exists so that entries() is ordered by name.
   map_t _name_to_entry;
+  entry_ptr_t find(const QString &name) const;
 };
 } // end namespace symbol
@@ -83,6 +83,8 @@ void selectByNameImpl(QList<QSharedPointer<symbol::Entry>> &list, QSharedPointer
 }
 QList<QSharedPointer<symbol::Entry>> symbol::selectByName(QSharedPointer<Table> table, const QString &name,
                                                           TraversalPolicy policy) {
+  // Tables index every symbol in their hierarchy by name, so the whole tree need not be walked.
+  if (policy == TraversalPolicy::kWholeTree) return table->selectInTree(name);
   QList<QSharedPointer<symbol::Entry>> ret;
   selectByNameImpl(ret, policyToTargetTable(policy, table), name, policyToMode(policy));
   return ret;
@@ -99,6 +101,7 @@ void existsImpl(bool &exists, QSharedPointer<symbol::Table> table, const QString
   }
 }
 bool symbol::exists(QSharedPointer<Table> table, const QString &name, TraversalPolicy policy) {
+  if (policy == TraversalPolicy::kWholeTree) return !table->selectInTree(name).isEmpty();
   bool ret = false;
   existsImpl(ret, policyToTargetTable(policy, table), name, policyToMode(policy));
   return ret;
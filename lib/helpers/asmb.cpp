@@ -53,6 +53,20 @@ helpers::AsmHelper::AsmHelper(QSharedPointer<::macro::Registry> registry, QStrin
 
 void helpers::AsmHelper::setUserText(QString user) { _user = user; }
 
+void helpers::AsmHelper::setParseCache(ParseCache cache) { _cache = cache; }
+
+helpers::AsmHelper::ParseCache helpers::AsmHelper::ParseCache::create(builtins::Architecture arch) {
+  using pas::driver::IncrementalParser;
+  switch (arch) {
+  case builtins::Architecture::PEP10: {
+    auto parser = pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(false);
+    return {.os = QSharedPointer<IncrementalParser>::create(parser),
+            .user = QSharedPointer<IncrementalParser>::create(parser)};
+  }
+  default: return {};
+  }
+}
+
 bool helpers::AsmHelper::assemble() {
   _callViaRets.clear();
   switch (_arch) {
@@ -70,8 +84,14 @@ bool helpers::AsmHelper::assemble() {
     return result;
   };
   case builtins::Architecture::PEP10: {
-    QList<QPair<QString, pas::driver::pep10::Features>> targets = {{{_os, {.isOS = true}}}};
-    if (_user) targets.push_back({*_user, {.isOS = false}});
+    using Parser = decltype(pas::driver::pep10::Features::parser);
+    auto wrap = [](QSharedPointer<pas::driver::IncrementalParser> parser) -> Parser {
+      if (parser.isNull()) return nullptr;
+      return [parser](QString text, QSharedPointer<pas::ast::Node> parent) { return (*parser)(text, parent); };
+    };
+    auto os = _cache ? wrap(_cache->os) : nullptr, user = _cache ? wrap(_cache->user) : nullptr;
+    QList<QPair<QString, pas::driver::pep10::Features>> targets = {{{_os, {.isOS = true, .parser = os}}}};
+    if (_user) targets.push_back({*_user, {.isOS = false, .parser = user}});
     auto pipeline = pas::driver::pep10::pipeline<pas::driver::ANTLRParserTag>(targets, _reg);
     auto result = pipeline->assemble(pas::driver::pep10::Stage::End);
     auto osTarget = pipeline->pipelines[0].first;
@@ -1,6 +1,7 @@
 #pragma once
 #include <elfio/elfio.hpp>
 #include "asm/pas/ast/node.hpp"
+#include "asm/pas/driver/incremental.hpp"
 #include "builtins/book.hpp"
 #include "builtins/constants.hpp"
 #include "macro/registry.hpp"
@@ -27,9 +28,17 @@ public:
     QMap<int, quint32> _source2Addr{}, _list2Addr{};
     QMap<quint32, int> _addr2Source{}, _addr2List{};
   };
+  // Parsers which remember the lines they have parsed. Sharing a cache between helpers which assemble successive
+  // versions of the same programs (e.g., as they are edited) means only changed lines are re-parsed.
+  struct ParseCache {
+    QSharedPointer<pas::driver::IncrementalParser> os, user;
+    static ParseCache create(builtins::Architecture arch);
+  };
   AsmHelper(QSharedPointer<macro::Registry> registry, QString os,
             builtins::Architecture arch = builtins::Architecture::PEP10);
   void setUserText(QString user);
+  // Only used for Pep/10.
+  void setParseCache(ParseCache cache);
   bool assemble();
   QStringList errors();
   QList<QPair<int, QString>> errorsWithLines();
@@ -46,6 +55,7 @@ private:
   QSharedPointer<macro::Registry> _reg;
   QString _os;
   std::optional<QString> _user = std::nullopt;
+  std::optional<ParseCache> _cache = std::nullopt;
 
   QSharedPointer<pas::ast::Node> _osRoot, _userRoot;
   QSharedPointer<ELFIO::elfio> _elf;
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "os_cache.hpp"
+#include <sstream>
+#include "about/version.hpp"
+#include "asm/pas/obj/pep10.hpp"
+#include "asm/pas/obj/pep9.hpp"
+#include "asmb.hpp"
+#include "macro/macro.hpp"
+#include "macro/registered.hpp"
+
+namespace {
+QByteArray serialize(ELFIO::elfio &elf) {
+  std::stringstream s;
+  elf.save(s);
+  return QByteArray::fromStdString(s.str());
+}
+
+QSharedPointer<ELFIO::elfio> deserialize(const QByteArray &image) {
+  auto ret = QSharedPointer<ELFIO::elfio>::create();
+  std::istringstream s(image.toStdString());
+  if (!ret->load(s)) return nullptr;
+  return ret;
+}
+} // namespace
+
+helpers::OSImageCache &helpers::OSImageCache::instance() {
+  static OSImageCache cache;
+  return cache;
+}
+
+void helpers::OSImageCache::setDirectory(std::optional<QString> dir) {
+  QMutexLocker locker(&_mutex);
+  _dir = dir;
+}
+
+QSharedPointer<ELFIO::elfio> helpers::OSImageCache::elf(QSharedPointer<macro::Registry> registry, QString os,
+                                                        builtins::Architecture arch,
+                                                        std::optional<QList<quint8>> userObj) {
+  const auto hash = key(*registry, os, arch);
+  QByteArray image;
+  {
+    // Hold the lock while assembling, so that concurrent requests for the same OS only assemble it once.
+    QMutexLocker locker(&_mutex);
+    if (auto it = _images.constFind(hash); it != _images.cend()) image = *it;
+    else if (auto persisted = load(hash); persisted) image = _images[hash] = *persisted;
+    else {
+      AsmHelper helper(registry, os, arch);
+      if (!helper.assemble()) return nullptr;
+      image = _images[hash] = serialize(*helper.elf());
+      persist(hash, image);
+    }
+  }
+
+  auto ret = deserialize(image);
+  if (!ret || !userObj) return ret;
+  switch (arch) {
+  case builtins::Architecture::PEP9: pas::obj::pep9::writeUser(*ret, *userObj); break;
+  case builtins::Architecture::PEP10: pas::obj::pep10::writeUser(*ret, *userObj); break;
+  default: throw std::logic_error("Unimplemented arch");
+  }
+  // Save and load so that offsets will be correct.
+  return deserialize(serialize(*ret));
+}
+
+void helpers::OSImageCache::clear() {
+  QMutexLocker locker(&_mutex);
+  _images.clear();
+}
+
+qsizetype helpers::OSImageCache::size() const {
+  QMutexLocker locker(&_mutex);
+  return _images.size();
+}
+
+QByteArray helpers::OSImageCache::key(const macro::Registry &registry, const QString &os,
+                                      builtins::Architecture arch) {
+  QCryptographicHash hash(QCryptographicHash::Sha256);
+  // Persisted images are only valid for the assembler which produced them.
+  hash.addData(QByteArrayView(about::g_GIT_SHA1()));
+  hash.addData(QByteArray::number(static_cast<int>(arch)));
+  hash.addData(os.toUtf8());
+  using namespace macro::types;
+  for (auto type : {Core, System, User}) {
+    auto macros = registry.findMacrosByType(type);
+    // Registry iteration order is an implementation detail, so sort to keep keys stable.
+    std::sort(macros.begin(), macros.end(), [](const macro::Registered *lhs, const macro::Registered *rhs) {
+      return lhs->contents()->name() < rhs->contents()->name();
+    });
+    for (const auto *macro : macros) {
+      auto contents = macro->contents();
+      hash.addData(QByteArray::number(type));
+      // Separate fields so that moving text between a name and body changes the key.
+      for (const auto &field : {contents->name(), contents->body(), contents->architecture(), contents->family()})
+        hash.addData(field.toUtf8().append('\0'));
+      hash.addData(QByteArray::number(contents->argCount()));
+    }
+  }
+  return hash.result().toHex();
+}
+
+std::optional<QByteArray> helpers::OSImageCache::load(const QByteArray &key) const {
+  if (!_dir) return std::nullopt;
+  QFile f(QDir(*_dir).filePath(QString::fromLatin1(key) + ".elf"));
+  if (!f.open(QIODevice::ReadOnly)) return std::nullopt;
+  auto image = f.readAll();
+  // Discard truncated or otherwise corrupt images rather than simulating them.
+  if (!deserialize(image)) return std::nullopt;
+  return image;
+}
+
+void helpers::OSImageCache::persist(const QByteArray &key, const QByteArray &image) const {
+  if (!_dir || !QDir().mkpath(*_dir)) return;
+  // QSaveFile prevents a concurrent process from reading a partially written image.
+  QSaveFile f(QDir(*_dir).filePath(QString::fromLatin1(key) + ".elf"));
+  if (!f.open(QIODevice::WriteOnly)) return;
+  f.write(image);
+  f.commit();
+}
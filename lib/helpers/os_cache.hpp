@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <elfio/elfio.hpp>
+#include "builtins/constants.hpp"
+#include "macro/registry.hpp"
+
+namespace helpers {
+// Memoizes assembled operating systems, so that opening a project or starting a simulation does not re-run the
+// assembler over an OS it has already seen. Images are keyed on a hash of the OS source, the architecture, and every
+// macro in the registry, so editing either the OS or a macro yields a different image. The OS symbol table is stored in
+// the ELF, and is cached alongside the code.
+class OSImageCache {
+public:
+  // Process-wide cache, which is safe to use from multiple threads.
+  static OSImageCache &instance();
+
+  // If set, images are also read from and written to dir, so that they survive between processes.
+  void setDirectory(std::optional<QString> dir);
+  // Returns a fresh ELF containing the assembled OS, which the caller may modify. If userObj is present, it is loaded
+  // as the user program, like AsmHelper::elf. Returns nullptr if the OS does not assemble.
+  QSharedPointer<ELFIO::elfio> elf(QSharedPointer<macro::Registry> registry, QString os, builtins::Architecture arch,
+                                   std::optional<QList<quint8>> userObj = std::nullopt);
+  void clear();
+  qsizetype size() const;
+
+  static QByteArray key(const macro::Registry &registry, const QString &os, builtins::Architecture arch);
+
+private:
+  OSImageCache() = default;
+  std::optional<QByteArray> load(const QByteArray &key) const;
+  void persist(const QByteArray &key, const QByteArray &image) const;
+
+  mutable QMutex _mutex;
+  // Serialized ELF files. Each caller receives its own copy, since elfio objects are mutable and not thread-safe.
+  QHash<QByteArray, QByteArray> _images;
+  std::optional<QString> _dir = std::nullopt;
+};
+} // namespace helpers
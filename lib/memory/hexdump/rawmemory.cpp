@@ -61,19 +61,14 @@ static const auto gs = sim::api2::memory::Operation{
     .kind = sim::api2::memory::Operation::Kind::data,
 };
 
-SimulatorRawMemory::SimulatorRawMemory(sim::memory::SimpleBus<quint16> *memory,
-                                       QSharedPointer<sim::trace2::ModifiedAddressSink<quint16>> addrSink,
-                                       QObject *parent)
-    : ARawMemory(parent), _memory(memory), _sink(addrSink) {}
+SimulatorRawMemory::SimulatorRawMemory(sim::memory::SimpleBus<quint16> *memory, QObject *parent)
+    : ARawMemory(parent), _memory(memory), _shadow(byteCount(), 0), _modified(byteCount(), false) {
+  resynchronize();
+}
 
 quint32 SimulatorRawMemory::byteCount() const { return sim::api2::memory::size<quint16, false>(_memory->span()); }
 
-quint8 SimulatorRawMemory::read(quint32 address) const {
-  auto span = _memory->span();
-  quint8 ret = 0;
-  if (sim::api2::memory::contains(span, static_cast<quint16>(address))) _memory->read(address, {&ret, sizeof(ret)}, gs);
-  return ret;
-}
+quint8 SimulatorRawMemory::read(quint32 address) const { return address < _shadow.size() ? _shadow[address] : 0; }
 
 std::optional<quint8> SimulatorRawMemory::readPrevious(quint32 address) const {
   auto it = _modifiedCache.find(address);
@@ -93,52 +88,80 @@ MemoryHighlight::V SimulatorRawMemory::status(quint32 address) const {
   using sim::api2::memory::contains;
   if (contains(_PC, address)) return MemoryHighlight::PC;
   else if (contains(_SP, address)) return MemoryHighlight::SP;
-  else if (!_sink.isNull() && _sink->contains(address)) return MemoryHighlight::Modified;
+  else if (address < _modified.size() && _modified[address]) return MemoryHighlight::Modified;
   return MemoryHighlight::None;
 }
 
 void SimulatorRawMemory::write(quint32 address, quint8 value) {
   using sim::api2::memory::contains;
   auto span = _memory->span();
-  if (contains(span, static_cast<quint16>(address))) _memory->write(address, {&value, sizeof(value)}, gs);
+  if (_simulating || !contains(span, static_cast<quint16>(address))) return;
+  _memory->write(address, {&value, sizeof(value)}, gs);
+  _shadow[address] = value;
 }
 
 void SimulatorRawMemory::clear() {
+  if (_simulating) return;
   _memory->clear(0);
+  resynchronize();
   _PC = _lastPC = _SP = _lastSP = {n1, n1};
 }
 
-void SimulatorRawMemory::clearModifiedAndUpdateGUI() {
-  _sink->clear();
+void SimulatorRawMemory::setSimulating(bool simulating) { _simulating = simulating; }
+
+void SimulatorRawMemory::resynchronize() {
+  _memory->takeDirty();
+  _memory->dump({_shadow.data(), _shadow.size()});
+  std::fill(_modified.begin(), _modified.end(), false);
   _modifiedCache.clear();
+  _lastDirty.clear();
+}
+
+void SimulatorRawMemory::clearModifiedAndUpdateGUI() {
+  resynchronize();
   emit dataChanged(0, 0xffff);
 }
 
-void SimulatorRawMemory::onUpdateGUI(sim::api2::trace::FrameIterator from) {
+void SimulatorRawMemory::onUpdateGUI(sim::api2::trace::FrameIterator) {
+  // Coalesce repaints to dirty page boundaries, so that nearby changes are repainted by a single signal.
+  static constexpr quint32 block = sim::memory::SimpleBus<quint16>::dirtyPageSize;
+  sim::trace2::IntervalSet<quint32, true> repaint;
+  auto addRepaint = [&](Interval interval) {
+    if (interval.lower() == n1) return;
+    repaint.insert(interval.lower() & ~(block - 1), std::min(interval.upper() | (block - 1), byteCount() - 1));
+  };
+
   // Remove highlighted cells from previous steps.
-  auto oldHighlights = std::set{_sink->intervals()};
-  oldHighlights.insert({static_cast<quint16>(_lastSP.lower()), static_cast<quint16>(_lastSP.upper())});
-  oldHighlights.insert({static_cast<quint16>(_lastPC.lower()), static_cast<quint16>(_lastPC.upper())});
-  // Purge data from previous updates. Must be cleared before iterating and emitting events, or highlights are wrong.
-  _sink->clear();
+  for (const auto &interval : _lastDirty) {
+    std::fill(_modified.begin() + interval.lower(), _modified.begin() + interval.upper() + 1, false);
+    addRepaint(interval);
+  }
+  _lastDirty.clear();
+  _modifiedCache.clear();
+  addRepaint(_lastSP), addRepaint(_lastPC);
   // Must cache current SP/PC so that we can clear the highlighting next time.
   _lastSP = _SP, _lastPC = _PC;
 
-  // If there is no TB, then there is no data to analyze.
-  // Conservatively, we assume that all data is modified.
-  if (const auto tb = _memory->buffer(); tb == nullptr) emit dataChanged(0, 0xffff);
-  else {
-    for (auto oldHighlight : oldHighlights) emit dataChanged(oldHighlight.lower(), oldHighlight.upper());
-    for (auto frame = from; frame != tb->cend(); ++frame)
-      for (auto packet = frame.cbegin(); packet != frame.cend(); ++packet)
-        _sink->analyze(packet, sim::api2::trace::Direction::Forward);
-    for (const auto &interval : _sink->intervals())
-      // Cache the previous value of the modified addresses.
-      emit dataChanged(interval.lower(), interval.upper());
-    // And update intervals containing PC, SP to fix the highlighting.
-    emit dataChanged(this->_SP.lower(), this->_SP.upper());
-    emit dataChanged(this->_PC.lower(), this->_PC.upper());
+  // Only bytes whose value differs from the last update are highlighted.
+  quint8 page[block];
+  for (const auto &span : _memory->takeDirty()) {
+    for (quint32 base = span.lower(); base <= span.upper(); base += block) {
+      auto length = std::min<quint32>(block, span.upper() - base + 1);
+      _memory->read(base, {page, length}, gs);
+      for (quint32 offset = 0; offset < length; offset++) {
+        if (auto address = base + offset; page[offset] != _shadow[address]) {
+          _modifiedCache[address] = _shadow[address];
+          _shadow[address] = page[offset];
+          _modified[address] = true;
+        }
+      }
+    }
+    _lastDirty.emplace_back(span.lower(), span.upper());
+    addRepaint(_lastDirty.back());
   }
+  // And update intervals containing PC, SP to fix the highlighting.
+  addRepaint(_SP), addRepaint(_PC);
+  for (const auto &interval : repaint.intervals()) emit dataChanged(interval.lower(), interval.upper());
 }
 
 void SimulatorRawMemory::onRepaintAddress(quint32 start, quint32 end) { emit dataChanged(start, end); }
@@ -93,16 +93,11 @@ public:
   static QObject *create(QQmlEngine *, QJSEngine *);
 };
 
-namespace sim::trace2 {
-template <typename T> class ModifiedAddressSink;
-}
 // TODO: add access to CPU, add access to traces.
 class SimulatorRawMemory : public ARawMemory {
   Q_OBJECT
 public:
-  explicit SimulatorRawMemory(sim::memory::SimpleBus<quint16> *memory,
-                              QSharedPointer<sim::trace2::ModifiedAddressSink<quint16>> addrSink,
-                              QObject *parent = nullptr);
+  explicit SimulatorRawMemory(sim::memory::SimpleBus<quint16> *memory, QObject *parent = nullptr);
   quint32 byteCount() const override;
   quint8 read(quint32 address) const override;
   std::optional<quint8> readPrevious(quint32 address) const override;
@@ -111,20 +106,33 @@ public:
   Q_INVOKABLE quint32 pc() const override;
   Q_INVOKABLE quint32 sp() const override;
   MemoryHighlight::V status(quint32 address) const override;
+  // Writes and clears are refused while simulating, since the bus belongs to the simulation worker.
   void write(quint32 address, quint8 value) override;
   void clear() override;
+  void setSimulating(bool simulating);
 public slots:
   void clearModifiedAndUpdateGUI();
+  // Modified addresses come from the bus's dirty pages rather than the trace, so the cost of an update depends on
+  // how much memory was touched, not on how long the simulation ran.
   void onUpdateGUI(sim::api2::trace::FrameIterator from);
   // Addresses were changed, but not tracked in the trace buffer.
   // We don't want to highlight them. We just want to make sure they get re-painted.
   void onRepaintAddress(quint32 start, quint32 end);
 
 private:
+  using Interval = sim::trace2::Interval<quint32>;
   sim::memory::SimpleBus<quint16> *_memory;
+  // Contents of memory as of the last update, which are compared against dirty pages to find modified bytes.
+  // Reads are served from here, so that views never touch the bus while a slice is running.
+  std::vector<quint8> _shadow;
+  bool _simulating = false;
+  std::vector<bool> _modified;
   std::map<quint32, quint8> _modifiedCache;
-  QSharedPointer<sim::trace2::ModifiedAddressSink<quint16>> _sink;
+  // Pages which contained modified bytes, which must be repainted to remove stale highlights.
+  std::vector<Interval> _lastDirty;
   static constexpr quint32 n1 = -1;
-  sim::trace2::Interval<quint32> _PC = {n1, n1}, _SP = {n1, n1};
-  sim::trace2::Interval<quint32> _lastPC = {n1, n1}, _lastSP = {n1, n1};
+  Interval _PC = {n1, n1}, _SP = {n1, n1};
+  Interval _lastPC = {n1, n1}, _lastSP = {n1, n1};
+  // Forget all modifications, and treat the current contents of memory as unmodified.
+  void resynchronize();
 };
@@ -9,6 +9,7 @@
 namespace sim {
 namespace trace2 {
 class InfiniteBuffer;
+class BoundedBuffer;
 }
 } // namespace sim
 namespace project {
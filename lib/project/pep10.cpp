@@ -7,6 +7,7 @@
 #include "builtins/figure.hpp"
 #include "cpu/formats.hpp"
 #include "helpers/asmb.hpp"
+#include "helpers/os_cache.hpp"
 #include "isa/pep10.hpp"
 #include "sim/api2/trace/buffer.hpp"
 #include "sim/device/broadcast/mmi.hpp"
@@ -27,6 +28,8 @@ auto gs = sim::api2::memory::Operation{
     .type = sim::api2::memory::Operation::Type::Application,
     .kind = sim::api2::memory::Operation::Kind::data,
 };
+// Programs stuck in an infinite loop would otherwise grow the trace until the process (or WASM heap) runs out of memory.
+const auto traceBudget = sim::trace2::BoundedBuffer::Budget{.bytes = 32 * 1024 * 1024};
 }
 using namespace Qt::StringLiterals;
 
@@ -108,13 +111,16 @@ SystemAssembly make_isa_system(project::Environment env) {
   default: throw std::logic_error("Unimplemented");
   }
 
-  helpers::AsmHelper helper(macroRegistry, osContents, env.arch);
-  auto result = helper.assemble();
-  if (!result) qWarning() << "Default OS assembly failed";
-
   SystemAssembly ret;
-  // Need to reload to properly compute segment addresses.
-  ret.elf = helper.elf();
+  // Every project of a given architecture shares the same default OS, so only the first assembles it.
+  ret.elf = helpers::OSImageCache::instance().elf(macroRegistry, osContents, env.arch);
+  if (!ret.elf) {
+    // Failed assemblies are not cached, so fall back to whatever the assembler produced.
+    qWarning() << "Default OS assembly failed";
+    helpers::AsmHelper helper(macroRegistry, osContents, env.arch);
+    helper.assemble();
+    ret.elf = helper.elf();
+  }
   ret.system = targets::isa::systemFromElf(*ret.elf, true);
   return ret;
 }
@@ -169,8 +175,10 @@ SystemAssembly make_asmb_system(project::Environment env, QString os) {
   return ret;
 }
 
-template <typename CPU, typename ISA>
-RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes, QObject *parent = nullptr) {
+// Formatters read the state published at the end of the last slice, since the CPU belongs to the worker while it runs.
+template <typename ISA>
+RegisterModel *register_model(const project::SimulationWorker::CPUState *state, OpcodeModel *opcodes,
+                              QObject *parent = nullptr) {
   using RF = QSharedPointer<RegisterFormatter>;
   using TF = QSharedPointer<TextFormatter>;
   using AF = QSharedPointer<ASCIIFormatter>;
@@ -183,33 +191,24 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
   using VF = QSharedPointer<VariableByteLengthFormatter>;
   using VecF = QVector<RF>;
   auto ret = new RegisterModel(parent);
-  auto _register = [](typename ISA::Register r, auto *system) {
-    if (system == nullptr) return quint16{0};
-    quint16 ret = 0;
-    auto cpu = static_cast<CPU *>(system->cpu());
-    targets::isa::readRegister<ISA>(cpu->regs(), r, ret, gs);
-    return ret;
-  };
-  auto cpu = static_cast<CPU *>(system->cpu());
-  // BUG: _system seems to be getting deleted very easily. It probably shouldn't be a shared pointer.
-  // DO NOT CAPTURE _system INDIRECTLY VIA ANOTHER LAMBDA. It will crash.
-  auto A = [=]() { return _register(ISA::Register::A, system); };
-  auto X = [=]() { return _register(ISA::Register::X, system); };
-  auto SP = [=]() { return _register(ISA::Register::SP, system); };
-  auto PC = [=]() { return _register(ISA::Register::PC, system); };
-  auto IS = [=]() { return _register(ISA::Register::IS, system); };
+  auto _register = [](typename ISA::Register r, auto *state) { return state->template reg<ISA>(r); };
+  auto A = [=]() { return _register(ISA::Register::A, state); };
+  auto X = [=]() { return _register(ISA::Register::X, state); };
+  auto SP = [=]() { return _register(ISA::Register::SP, state); };
+  auto PC = [=]() { return _register(ISA::Register::PC, state); };
+  auto IS = [=]() { return _register(ISA::Register::IS, state); };
   auto IS_TEXT = [=]() {
-    int opcode = _register(ISA::Register::IS, system);
+    int opcode = _register(ISA::Register::IS, state);
     auto row = opcodes->indexFromOpcode(opcode);
     return opcodes->data(opcodes->index(row), Qt::DisplayRole).toString();
   };
-  auto OS = [=]() { return _register(ISA::Register::OS, system); };
+  auto OS = [=]() { return _register(ISA::Register::OS, state); };
   auto notU = [=]() {
-    auto is = _register(ISA::Register::IS, system);
+    auto is = _register(ISA::Register::IS, state);
     auto op = ISA::opcodeLUT[is];
     return !op.instr.unary;
   };
-  auto operand = [=]() { return cpu->currentOperand().value_or(0); };
+  auto operand = [=]() { return state->operand.value_or(0); };
   auto cf = [](std::function<int64_t()> reg, qsizetype index) {
     return QSharedPointer<ChoiceFormatter>::create(
         VecF{SF::create(reg, 2), UF::create(reg, 2), BF::create(reg, 2), AF::create(reg, 2)}, index);
@@ -222,7 +221,7 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
   ret->appendFormatters(
       {TF::create("Operand Specifier"), OF::create(HF::create(OS, 2), notU), OF::create(SF::create(OS, 2), notU)});
   auto length = [=]() {
-    auto is = _register(ISA::Register::IS, system);
+    auto is = _register(ISA::Register::IS, state);
     return ISA::operandBytes(is);
   };
   auto opr_hex = HF::create(operand, 2);
@@ -233,22 +232,15 @@ RegisterModel *register_model(targets::isa::System *system, OpcodeModel *opcodes
   return ret;
 }
 
-template <typename CPU, typename ISA> FlagModel *flag_model(targets::isa::System *system, QObject *parent = nullptr) {
+template <typename ISA>
+FlagModel *flag_model(const project::SimulationWorker::CPUState *state, QObject *parent = nullptr) {
   using F = QSharedPointer<Flag>;
   auto ret = new FlagModel(parent);
-  auto _flag = [](typename ISA::CSR s, auto *system) {
-    if (system == nullptr) return false;
-    bool ret = 0;
-    auto cpu = static_cast<CPU *>(system->cpu());
-    targets::isa::readCSR<ISA>(cpu->csrs(), s, ret, gs);
-    return ret;
-  };
-  auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
-  // See above for wanings on _system pointer.
-  auto N = [=]() { return _flag(ISA::CSR::N, system); };
-  auto Z = [=]() { return _flag(ISA::CSR::Z, system); };
-  auto V = [=]() { return _flag(ISA::CSR::V, system); };
-  auto C = [=]() { return _flag(ISA::CSR::C, system); };
+  auto _flag = [](typename ISA::CSR s, auto *state) { return state->template csr<ISA>(s); };
+  auto N = [=]() { return _flag(ISA::CSR::N, state); };
+  auto Z = [=]() { return _flag(ISA::CSR::Z, state); };
+  auto V = [=]() { return _flag(ISA::CSR::V, state); };
+  auto C = [=]() { return _flag(ISA::CSR::C, state); };
   ret->appendFlag({F::create("N", N)});
   ret->appendFlag({F::create("Z", Z)});
   ret->appendFlag({F::create("V", V)});
@@ -257,11 +249,21 @@ template <typename CPU, typename ISA> FlagModel *flag_model(targets::isa::System
 }
 
 Pep_ISA::Pep_ISA(project::Environment env, QVariant delegate, QObject *parent, bool initializeSystem)
-    : QObject(parent), _env(env), _delegate(delegate), _tb(QSharedPointer<sim::trace2::InfiniteBuffer>::create()),
+    : QObject(parent), _env(env), _delegate(delegate), _tb(QSharedPointer<sim::trace2::BoundedBuffer>::create(traceBudget)),
       _memory(nullptr), _registers(nullptr), _flags(nullptr) {
   _system.clear();
   assert(_system.isNull());
   _dbg = QSharedPointer<pepp::sim::Debugger>::create();
+  _worker = new project::SimulationWorker();
+  connect(_worker, &project::SimulationWorker::sliceFinished, this, &Pep_ISA::onSliceFinished, Qt::QueuedConnection);
+#ifdef __EMSCRIPTEN__
+  // Without thread support slices run on the GUI thread. They are still queued, so events are processed between them.
+  _worker->setParent(this);
+#else
+  _worker->moveToThread(&_simThread);
+  connect(&_simThread, &QThread::finished, _worker, &QObject::deleteLater);
+  _simThread.start();
+#endif
   if (initializeSystem) {
     auto elfsys = make_isa_system(env);
     _elf = elfsys.elf;
@@ -269,19 +271,24 @@ Pep_ISA::Pep_ISA(project::Environment env, QVariant delegate, QObject *parent, b
     _system->bus()->setBuffer(&*_tb);
     bindToSystem();
   }
-  connect(this, &Pep_ISA::deferredExecution, this, &Pep_ISA::onDeferredExecution, Qt::QueuedConnection);
 }
 
-void Pep_ISA::bindToSystem() {
+Pep_ISA::~Pep_ISA() {
+  _simThread.quit();
+  _simThread.wait();
+}
 
+void Pep_ISA::bindToSystem() {
+  _worker->setSystem(&*_system, &*_dbg);
+  _cpuState = project::SimulationWorker::capture(*_system);
   switch (_env.arch) {
   case builtins::ArchitectureHelper::Architecture::PEP9:
-    _flags = flag_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, this);
-    _registers = register_model<targets::pep9::isa::CPU, isa::Pep9>(&*_system, mnemonics(), this);
+    _flags = flag_model<isa::Pep9>(&_cpuState, this);
+    _registers = register_model<isa::Pep9>(&_cpuState, mnemonics(), this);
     break;
   case builtins::ArchitectureHelper::Architecture::PEP10:
-    _flags = flag_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, this);
-    _registers = register_model<targets::pep10::isa::CPU, isa::Pep10>(&*_system, mnemonics(), this);
+    _flags = flag_model<isa::Pep10>(&_cpuState, this);
+    _registers = register_model<isa::Pep10>(&_cpuState, mnemonics(), this);
     break;
   default: throw std::logic_error("Unimplemented");
   }
@@ -293,10 +300,7 @@ void Pep_ISA::bindToSystem() {
   connect(this, SIGNAL(updateGUI(sim::api2::trace::FrameIterator)), _registers, SLOT(onUpdateGUI()));
   QQmlEngine::setObjectOwnership(_registers, QQmlEngine::CppOwnership);
 
-  using TMAS = sim::trace2::TranslatingModifiedAddressSink<quint16>;
-  auto sink = QSharedPointer<TMAS>::create(_system->pathManager(), _system->bus());
-
-  _memory = new SimulatorRawMemory(_system->bus(), sink, this);
+  _memory = new SimulatorRawMemory(_system->bus(), this);
   connect(this, SIGNAL(updateGUI(sim::api2::trace::FrameIterator)), _memory,
           SLOT(onUpdateGUI(sim::api2::trace::FrameIterator)));
   QQmlEngine::setObjectOwnership(_memory, QQmlEngine::CppOwnership);
@@ -392,6 +396,8 @@ void Pep_ISA::setCharIn(QString value) {
 }
 
 QString Pep_ISA::charOut() const {
+  // The output device belongs to the worker until the slice finishes.
+  if (_simulating) return _charOut;
   if (auto charOut = _system->output("charOut"); charOut) {
     auto charOutEndpoint = charOut->endpoint();
     charOutEndpoint->set_to_head();
@@ -401,7 +407,7 @@ QString Pep_ISA::charOut() const {
       if (out.capacity() < index + 1) out.reserve(2 * (index + 1));
       out.append(char(*next));
     }
-    return out;
+    return _charOut = out;
   }
   using namespace Qt::StringLiterals;
   return u""_s;
@@ -412,6 +418,7 @@ bool Pep_ISA::isEmpty() const { return _objectCodeText.isEmpty(); }
 bool Pep_ISA::onSaveCurrent() { return false; }
 
 bool Pep_ISA::onLoadObject() {
+  if (_simulating) return false;
   static ObjectUtilities utils;
   _tb->clear();
   // Only enable trace while running the program to prevent spurious changed highlights.
@@ -467,20 +474,19 @@ bool Pep_ISA::onFormatObject() {
 }
 
 bool Pep_ISA::onExecute() {
+  if (_simulating) return false;
   prepareSim();
   _state = State::NormalExec;
-  _stepsSinceLastInteraction = 0;
   emit allowedDebuggingChanged();
   emit allowedStepsChanged();
   _system->bus()->trace(true);
-  emit deferredExecution([]() { return false; });
-  return true;
+  return startSimulation([]() { return false; });
 }
 
 bool Pep_ISA::onDebuggingStart() {
+  if (_simulating) return false;
   prepareSim();
   _state = State::DebugPaused;
-  _stepsSinceLastInteraction = 0;
   emit allowedDebuggingChanged();
   emit allowedStepsChanged();
   _system->bus()->trace(true);
@@ -488,18 +494,19 @@ bool Pep_ISA::onDebuggingStart() {
 }
 
 bool Pep_ISA::onDebuggingContinue() {
+  if (_simulating) return false;
   _state = State::DebugExec;
   _pendingPause = false;
-  _stepsSinceLastInteraction = 0;
   emit allowedDebuggingChanged();
   emit allowedStepsChanged();
-  emit deferredExecution([]() { return false; });
-  return true;
+  return startSimulation([]() { return false; });
 }
 
 bool Pep_ISA::onDebuggingPause() { return _pendingPause = true; }
 
 bool Pep_ISA::onDebuggingStop() {
+  // The worker owns the system until its slice finishes, at which point the stop is applied.
+  if (_simulating) return _pendingStop = true;
   _system->bus()->trace(false);
   _state = State::Halted;
   emit allowedDebuggingChanged();
@@ -508,6 +515,12 @@ bool Pep_ISA::onDebuggingStop() {
 }
 
 bool Pep_ISA::onISARemoveAllBreakpoints() {
+  if (_simulating) {
+    // Edits made before the clear are moot, and those made after it are applied after it.
+    _deferredBPs.clear();
+    _deferredClearBPs = true;
+    return true;
+  }
   _dbg->clearBPs();
   return true;
 }
@@ -552,6 +565,7 @@ bool Pep_ISA::onISAStepInto() { return stepDepthHelper(1); }
 bool Pep_ISA::onISAStepOut() { return stepDepthHelper(-1); }
 
 bool Pep_ISA::onClearCPU() {
+  if (_simulating) return false;
   switch (_env.arch) {
   case builtins::Architecture::PEP9: {
     auto cpu = static_cast<targets::pep9::isa::CPU *>(_system->cpu());
@@ -570,12 +584,14 @@ bool Pep_ISA::onClearCPU() {
 
   // Reset trace buffer, since its content is now meaningless.
   _tb->clear();
+  _cpuState = project::SimulationWorker::capture(*_system);
   _flags->onUpdateGUI();
   _registers->onUpdateGUI();
   return true;
 }
 
 bool Pep_ISA::onClearMemory() {
+  if (_simulating) return false;
   _system->bus()->clear(0);
   // Reset trace buffer, since its content is now meaningless.
   _tb->clear();
@@ -583,12 +599,10 @@ bool Pep_ISA::onClearMemory() {
   return true;
 }
 
-void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
-  auto pwrOff = _system->output("pwrOff");
-  auto endpoint = pwrOff->endpoint();
-  auto from = _tb->cend();
-  bool err = false;
-
+bool Pep_ISA::startSimulation(std::function<bool()> step) {
+  if (_simulating) return false;
+  _step = step;
+  _pendingPause = _pendingStop = false;
   State newState = _state;
   switch (_state) {
   case State::Halted: newState = State::NormalExec; break;
@@ -601,31 +615,32 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
     emit allowedDebuggingChanged();
     emit allowedStepsChanged();
   }
+  runSlice();
+  return true;
+}
 
-  // If we exceed the number of steps, do we allow another deferredExecution?
-  bool allowsResume = true;
-  try {
-    auto ending = _system->currentTick() + 1000;
-    do {
-      _system->tick(sim::api2::Scheduler::Mode::Jump);
-      if (_dbg->hit()) {
-        _dbg->clearHit();
-        _pendingPause = true;
-      }
-      _pendingPause |= step();
-    } while (_system->currentTick() < ending && endpoint->at_end() && !_pendingPause);
-  } catch (const sim::api2::memory::Error &e) {
-    err = true;
-    if (e.type() == sim::api2::memory::Error::Type::NeedsMMI) {
-      emit message("Ran out of MMI");
-    } else std::cerr << "Memory error: " << e.what() << std::endl;
-    // Handle illegal opcodes or program crashes.
-  } catch (const std::logic_error &e) {
-    err = true;
-    emit message(e.what());
-  }
-  // Only terminates if something written to endpoint or there was an error
-  if (endpoint->next_value().has_value() || err) {
+void Pep_ISA::runSlice() {
+  _simulating = true;
+  _memory->setSimulating(true);
+  _sliceFrom = _tb->cend();
+  auto worker = _worker;
+  QMetaObject::invokeMethod(_worker, [worker, step = _step]() { worker->runSlice(step); }, Qt::QueuedConnection);
+}
+
+void Pep_ISA::onSliceFinished(project::SimulationWorker::Reason reason, QString message) {
+  using Reason = project::SimulationWorker::Reason;
+  _simulating = false;
+  _memory->setSimulating(false);
+  _cpuState = _worker->published();
+  if (_deferredClearBPs) _dbg->clearBPs();
+  _deferredClearBPs = false;
+  for (const auto &[address, action] : std::as_const(_deferredBPs)) updateBPAtAddress(address, action);
+  _deferredBPs.clear();
+  if (!message.isEmpty()) emit this->message(message);
+
+  bool resume = false;
+  if (reason == Reason::Halted || reason == Reason::Error || _pendingStop) {
+    _pendingStop = false;
     switch (_state) {
     case State::NormalExec:
       _system->bus()->trace(false);
@@ -637,24 +652,16 @@ void Pep_ISA::onDeferredExecution(std::function<bool()> step) {
     case State::DebugPaused: onDebuggingStop(); break;
     default: break;
     }
-  }
-  // Trigger a BP if we exceed a resonable number of chained executions
-  else if (_stepsSinceLastInteraction++ > 10) {
-    _state = State::DebugPaused;
-    emit allowedDebuggingChanged();
-    emit allowedStepsChanged();
-    emit message("Pausing, potential infinite loop detected.");
-  }
-  // Queued connection, so it will be evaluated after the display is updated.
-  else if (allowsResume && !_pendingPause)
-    emit deferredExecution(step);
+  } else if (reason == Reason::Budget && !_pendingPause) resume = true;
   else {
     _pendingPause = false;
     _state = State::DebugPaused;
     emit allowedDebuggingChanged();
     emit allowedStepsChanged();
   }
-  prepareGUIUpdate(from);
+  // The worker is idle, so models may read the system. Resume only once they are done.
+  prepareGUIUpdate(_sliceFrom.value_or(_tb->cend()));
+  if (resume) runSlice();
 }
 
 void Pep_ISA::prepareSim() {
@@ -675,6 +682,7 @@ void Pep_ISA::prepareSim() {
   _pendingPause = false;
 
   // Repaint CPU & Memory panes
+  _cpuState = project::SimulationWorker::capture(*_system);
   _flags->onUpdateGUI();
   _registers->onUpdateGUI();
   updateMemPCSP();
@@ -718,21 +726,18 @@ void Pep_ISA::updateMemPCSP() const {
 }
 
 bool Pep_ISA::stepDepthHelper(qint16 offset) {
+  if (_simulating) return false;
   _state = State::DebugExec;
-  _stepsSinceLastInteraction = 0;
   _pendingPause = false;
   emit allowedDebuggingChanged();
   emit allowedStepsChanged();
   switch (_system->architecture()) {
   case builtins::Architecture::PEP9:
-    emit deferredExecution(generateStepCondition<targets::pep9::isa::CPU, isa::Pep9>(&*_system, offset));
-    break;
+    return startSimulation(generateStepCondition<targets::pep9::isa::CPU, isa::Pep9>(&*_system, offset));
   case builtins::Architecture::PEP10:
-    emit deferredExecution(generateStepCondition<targets::pep10::isa::CPU, isa::Pep10>(&*_system, offset));
-    break;
+    return startSimulation(generateStepCondition<targets::pep10::isa::CPU, isa::Pep10>(&*_system, offset));
   default: throw std::logic_error("Unimplemented architecture");
   }
-  return true;
 }
 
 project::DebugEnableFlags::DebugEnableFlags(QObject *parent) : QObject(parent) {}
@@ -740,7 +745,8 @@ project::DebugEnableFlags::DebugEnableFlags(QObject *parent) : QObject(parent) {
 project::StepEnableFlags::StepEnableFlags(QObject *parent) : QObject(parent) {}
 
 Pep_ASMB::Pep_ASMB(project::Environment env, QVariant delegate, QObject *parent)
-    : Pep_ISA(env, delegate, parent, false), _userModel(new SymbolModel(this)), _osModel(new SymbolModel(this)) {
+    : Pep_ISA(env, delegate, parent, false), _userModel(new SymbolModel(this)), _osModel(new SymbolModel(this)),
+      _parseCache(helpers::AsmHelper::ParseCache::create(env.arch)) {
 
   switch (_env.arch) {
   case builtins::Architecture::PEP9: _osAsmText = cs5e_os(); break;
@@ -847,6 +853,8 @@ static constexpr auto to_string = [](const QString &acc, const auto &pair) {
   return acc.isEmpty() ? pair.first : acc + "\n" + pair.first;
 };
 bool Pep_ASMB::onAssemble(bool doLoad) {
+  // Assembling replaces the system, which the worker may be using.
+  if (_simulating) return false;
   _userList = _osList = "";
   _userListAnnotations = _osListAnnotations = {};
   QSharedPointer<macro::Registry> macroRegistry = nullptr;
@@ -858,6 +866,7 @@ bool Pep_ASMB::onAssemble(bool doLoad) {
 
   helpers::AsmHelper helper(macroRegistry, _osAsmText, _env.arch);
   helper.setUserText(_userAsmText);
+  helper.setParseCache(_parseCache);
   auto ret = helper.assemble();
   _errors = helper.errorsWithLines();
   _userLines2Address = helper.address2Lines(false);
@@ -908,6 +917,7 @@ bool Pep_ASMB::onAssemble(bool doLoad) {
 }
 
 bool Pep_ASMB::onAssembleThenLoad() {
+  if (_simulating) return false;
   _system->bus()->clear(0);
   onAssemble(true);
   _system->doReloadEntries();
@@ -927,6 +937,7 @@ bool Pep_ASMB::onAssembleThenFormat() {
   }
   helpers::AsmHelper helper(macroRegistry, _osAsmText, _env.arch);
   helper.setUserText(_userAsmText);
+  helper.setParseCache(_parseCache);
   auto ret = helper.assemble();
   _errors = helper.errorsWithLines();
   _userLines2Address = helper.address2Lines(false);
@@ -1032,6 +1043,7 @@ void Pep_ASMB::prepareSim() {
   _memory->setPC(pc, pc + (isUnary ? 0 : 2));
   _memory->clearModifiedAndUpdateGUI();
   // Repaint CPU
+  _cpuState = project::SimulationWorker::capture(*_system);
   _flags->onUpdateGUI();
   _registers->onUpdateGUI();
 }
@@ -1070,8 +1082,11 @@ void Pep_ASMB::updatePCLine() {
 }
 
 void Pep_ISA::updateBPAtAddress(quint32 address, Action action) {
-
   auto as_quint16 = static_cast<quint16>(address);
+  if (_simulating) {
+    _deferredBPs.append({as_quint16, action});
+    return;
+  }
   switch (action) {
   case ScintillaAsmEditBase::Action::ToggleBP:
     if (_dbg->hasBP(as_quint16)) _dbg->removeBP(as_quint16);
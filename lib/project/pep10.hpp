@@ -2,6 +2,7 @@
 
 #include <QQmlEngine>
 #include <QStringListModel>
+#include <QThread>
 #include <qabstractitemmodel.h>
 #include "aproject.hpp"
 #include "builtins/constants.hpp"
@@ -10,6 +11,7 @@
 #include "debug/debugger.hpp"
 #include "helpers/asmb.hpp"
 #include "memory/hexdump/rawmemory.hpp"
+#include "simulationworker.hpp"
 #include "symtab/symbolmodel.hpp"
 #include "targets/isa3/system.hpp"
 #include "text/editor/scintillaasmeditbase.hpp"
@@ -45,6 +47,8 @@ public:
   };
   explicit Pep_ISA(project::Environment env, QVariant delegate, QObject *parent = nullptr,
                    bool initializeSystem = true);
+  // Waits for the simulation thread to finish its current slice.
+  ~Pep_ISA();
   virtual project::Environment env() const;
   virtual builtins::Architecture architecture() const;
   virtual builtins::Abstraction abstraction() const;
@@ -83,7 +87,7 @@ public slots:
   bool onClearCPU();
   bool onClearMemory();
 
-  void onDeferredExecution(std::function<bool()> step);
+  void onSliceFinished(project::SimulationWorker::Reason reason, QString message);
 
 signals:
   void objectCodeTextChanged();
@@ -96,13 +100,13 @@ signals:
 
   void message(QString message);
   void updateGUI(sim::api2::trace::FrameIterator from);
-  void deferredExecution(std::function<bool()> step);
   void overwriteEditors();
 
 protected:
   void bindToSystem();
-  bool _pendingPause = false;
-  int _stepsSinceLastInteraction = 0;
+  bool _pendingPause = false, _pendingStop = false;
+  // True while the worker owns the system. Nothing may touch _system, _tb, or _dbg until the slice finishes.
+  bool _simulating = false;
   enum class State {
     Halted,
     NormalExec,
@@ -110,6 +114,9 @@ protected:
     DebugPaused,
   } _state = State::Halted;
   virtual void prepareSim();
+  // Begin running slices on the worker until step returns true. Returns false if the simulation is already running.
+  bool startSimulation(std::function<bool()> step);
+  void runSlice();
   virtual void prepareGUIUpdate(sim::api2::trace::FrameIterator from);
   void updateMemPCSP() const;
   bool stepDepthHelper(qint16 offset);
@@ -117,17 +124,31 @@ protected:
   QString _charIn = {};
   QString _objectCodeText = {};
   QVariant _delegate = {};
-  QSharedPointer<sim::trace2::InfiniteBuffer> _tb = {};
+  QSharedPointer<sim::trace2::BoundedBuffer> _tb = {};
   QSharedPointer<targets::isa::System> _system = {};
   QSharedPointer<ELFIO::elfio> _elf = {};
   // Use raw pointer to avoid double-free with parent'ed QObjects.
   SimulatorRawMemory *_memory = nullptr;
   RegisterModel *_registers = nullptr;
   FlagModel *_flags = nullptr;
+  // What the register and flag models display, as of the end of the last slice or the last change between slices.
+  project::SimulationWorker::CPUState _cpuState = {};
+  // Returned by charOut() while the worker owns the output device.
+  mutable QString _charOut = {};
   qint16 _currentAddress = 0;
   using Action = ScintillaAsmEditBase::Action;
   void updateBPAtAddress(quint32 address, Action action);
   QSharedPointer<pepp::sim::Debugger> _dbg{};
+  // Breakpoints edited while simulating, which are applied once the current slice finishes.
+  QList<QPair<quint16, Action>> _deferredBPs = {};
+  // Set if all breakpoints were removed while simulating. Applied before _deferredBPs.
+  bool _deferredClearBPs = false;
+  QThread _simThread;
+  // Lives on _simThread, which deletes it.
+  project::SimulationWorker *_worker = nullptr;
+  std::function<bool()> _step = {};
+  // First frame produced by the current slice, so the GUI only highlights what changed since its last update.
+  std::optional<sim::api2::trace::FrameIterator> _sliceFrom = std::nullopt;
 };
 
 struct Error : public QObject {
@@ -206,4 +227,6 @@ protected:
   QString _userList = {}, _osList = {};
   QList<QPair<int, QString>> _errors = {}, _userListAnnotations = {}, _osListAnnotations = {};
   helpers::AsmHelper::Lines2Addresses _userLines2Address = {}, _osLines2Address = {};
+  // Persists between assemblies, so that only edited lines are re-parsed.
+  helpers::AsmHelper::ParseCache _parseCache;
 };
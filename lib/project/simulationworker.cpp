@@ -0,0 +1,83 @@
+#include "./simulationworker.hpp"
+#include <iostream>
+#include "sim/debug/debugger.hpp"
+#include "sim/device/broadcast/mmo.hpp"
+#include "targets/isa3/system.hpp"
+#include "targets/pep10/isa3/cpu.hpp"
+#include "targets/pep9/isa3/cpu.hpp"
+
+namespace {
+// Reading the clock every tick would cost as much as simulating simple instructions.
+constexpr int ticksPerClockCheck = 256;
+
+QVector<quint8> dumpTarget(const sim::api2::memory::Target<quint8> &target) {
+  QVector<quint8> ret(sim::api2::memory::size_inclusive(target.span()));
+  target.dump({ret.data(), std::size_t(ret.size())});
+  return ret;
+}
+
+template <typename CPU> project::SimulationWorker::CPUState captureCPU(CPU &cpu) {
+  return {.regs = dumpTarget(*cpu.regs()), .csrs = dumpTarget(*cpu.csrs()), .operand = cpu.currentOperand()};
+}
+} // namespace
+using namespace Qt::StringLiterals;
+
+project::SimulationWorker::SimulationWorker(QObject *parent) : QObject(parent) {}
+
+void project::SimulationWorker::setSystem(targets::isa::System *system, pepp::sim::Debugger *debugger) {
+  _system = system;
+  _dbg = debugger;
+}
+
+void project::SimulationWorker::setBudget(std::chrono::milliseconds budget) { _budget = budget; }
+
+project::SimulationWorker::CPUState project::SimulationWorker::capture(targets::isa::System &system) {
+  switch (system.architecture()) {
+  case builtins::Architecture::PEP9: return captureCPU(*static_cast<targets::pep9::isa::CPU *>(system.cpu()));
+  case builtins::Architecture::PEP10: return captureCPU(*static_cast<targets::pep10::isa::CPU *>(system.cpu()));
+  default: throw std::logic_error("Unimplemented");
+  }
+}
+
+project::SimulationWorker::CPUState project::SimulationWorker::published() const {
+  QMutexLocker lock(&_mutex);
+  return _published;
+}
+
+void project::SimulationWorker::runSlice(std::function<bool()> step) {
+  auto [reason, message] = tickUntilStopped(step);
+  if (_system != nullptr) {
+    auto state = capture(*_system);
+    QMutexLocker lock(&_mutex);
+    _published = std::move(state);
+  }
+  emit sliceFinished(reason, message);
+}
+
+std::pair<project::SimulationWorker::Reason, QString>
+project::SimulationWorker::tickUntilStopped(const std::function<bool()> &step) {
+  if (_system == nullptr) return {Reason::Error, u"No system to simulate"_s};
+  // A fresh endpoint is at the end of the channel, so any write during this slice halts the simulation.
+  auto endpoint = _system->output("pwrOff")->endpoint();
+  QElapsedTimer timer;
+  timer.start();
+  try {
+    do {
+      for (int it = 0; it < ticksPerClockCheck; it++) {
+        _system->tick(sim::api2::Scheduler::Mode::Jump);
+        if (!endpoint->at_end()) return {Reason::Halted, {}};
+        else if (_dbg && _dbg->hit()) {
+          _dbg->clearHit();
+          return {Reason::Breakpoint, {}};
+        } else if (step()) return {Reason::Step, {}};
+      }
+    } while (timer.durationElapsed() < _budget);
+  } catch (const sim::api2::memory::Error &e) {
+    if (e.type() == sim::api2::memory::Error::Type::NeedsMMI) return {Reason::Error, u"Ran out of MMI"_s};
+    std::cerr << "Memory error: " << e.what() << std::endl;
+    return {Reason::Error, {}};
+  } catch (const std::logic_error &e) {
+    return {Reason::Error, QString::fromStdString(e.what())};
+  }
+  return {Reason::Budget, {}};
+}
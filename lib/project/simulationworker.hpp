@@ -0,0 +1,68 @@
+#pragma once
+#include <QtCore>
+#include <functional>
+#include <optional>
+
+namespace targets::isa {
+class System;
+}
+namespace pepp::sim {
+class Debugger;
+}
+
+namespace project {
+// Runs a System in time-bounded slices on the thread which owns the worker (a dedicated thread in the GUI).
+// The worker only touches the system (and its trace buffer and debugger) while a slice is running. Once sliceFinished is
+// emitted, the owner may read or modify them until it requests another slice. Views must not wait for that: they read
+// the CPU state which the worker publishes at the end of each slice, and memory from their own copy.
+class SimulationWorker : public QObject {
+  Q_OBJECT
+public:
+  enum class Reason {
+    Budget,     // Ran out of time; the owner should request another slice to keep running.
+    Breakpoint, // The debugger was hit.
+    Step,       // The step condition returned true.
+    Halted,     // Something was written to pwrOff.
+    Error,      // The simulation threw. Message describes the error.
+  };
+  Q_ENUM(Reason)
+  // Copy of the register and CSR files, in the same layout (and byte order) as the CPU's own.
+  struct CPUState {
+    QVector<quint8> regs = {}, csrs = {};
+    std::optional<quint16> operand = std::nullopt;
+    template <typename ISA> quint16 reg(typename ISA::Register reg) const {
+      auto at = static_cast<quint8>(reg) * 2;
+      if (at + 1 >= regs.size()) return 0;
+      return quint16(regs[at]) << 8 | regs[at + 1];
+    }
+    template <typename ISA> bool csr(typename ISA::CSR csr) const {
+      auto at = static_cast<quint8>(csr);
+      return at < csrs.size() && csrs[at] != 0;
+    }
+  };
+  explicit SimulationWorker(QObject *parent = nullptr);
+  // Must only be called while no slice is running.
+  void setSystem(targets::isa::System *system, pepp::sim::Debugger *debugger);
+  // Time between sliceFinished signals while the simulation is unblocked.
+  void setBudget(std::chrono::milliseconds budget);
+  // Must only be called while no slice is running, e.g., after the owner modified the CPU between slices.
+  static CPUState capture(targets::isa::System &system);
+  // CPU state as of the end of the most recent slice.
+  CPUState published() const;
+
+public slots:
+  // Tick until step returns true, the debugger is hit, the system powers off, or the budget is exhausted.
+  void runSlice(std::function<bool()> step);
+
+signals:
+  void sliceFinished(project::SimulationWorker::Reason reason, QString message);
+
+private:
+  targets::isa::System *_system = nullptr;
+  pepp::sim::Debugger *_dbg = nullptr;
+  std::chrono::milliseconds _budget{20};
+  mutable QMutex _mutex;
+  CPUState _published = {};
+  std::pair<Reason, QString> tickUntilStopped(const std::function<bool()> &step);
+};
+} // namespace project
@@ -34,6 +34,9 @@ struct Trace {
   // Number of bytes to the start of the previous FrameHeader.
   // If 0, then this is the first frame in the trace.
   zpp::bits::varint<quint16> back_offset = 0;
+  // Number of ticks since the previous frame, including the tick which produced this frame.
+  // Ticks which produce no packets need not have a frame of their own; see Buffer::emitLazyFrameStart.
+  zpp::bits::varint<quint32> tick_delta = 1;
 };
 // If a single frame grows too large, its length will overflow a 16b int.
 // To avoid this, the trace buffer can automatically insert an Extender header.
@@ -45,6 +45,17 @@ template <typename Address> struct Translator {
   virtual QSharedPointer<const api2::Paths> pathManager() const = 0;
 };
 
+// Implemented by targets whose contents are ordinary host memory, and whose accesses have no side effects besides
+// tracing. Allows initiators to access memory without a virtual call per access. Accesses through the returned pointers
+// are not traced, so they must only be used when tracing is disabled.
+template <typename Address> struct Direct {
+  virtual ~Direct() = default;
+  // Returns host memory backing [address, address+length), or nullptr if the range cannot be accessed directly.
+  // Pointers are invalidated when the target's span changes or when a bus changes its mapping.
+  virtual const quint8 *directRead(Address address, std::size_t length) const = 0;
+  virtual quint8 *directWrite(Address address, std::size_t length) = 0;
+};
+
 template <typename Address> struct Initiator {
   virtual ~Initiator() = default;
   // Sets the memory backing for a particular port (i.e., set the I and D caches
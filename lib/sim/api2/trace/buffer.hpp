@@ -74,6 +74,9 @@ public:
   virtual bool traced(device::ID deviceID) const = 0;
 
   inline void emitFrameStart() { writeFragment({sim::api2::frame::header::Trace{}}); }
+  // Start a frame for a new tick, but defer writing its header until the first packet of the tick arrives.
+  // If the tick emits no packets, it is instead counted in the tick_delta of the next frame.
+  virtual void emitLazyFrameStart() { emitFrameStart(); }
   template <typename Address>
   void emitWrite(sim::api2::device::ID id, Address address, bits::span<const quint8> src, bits::span<quint8> dest) {
     using vb = decltype(api2::packet::header::Write::address);
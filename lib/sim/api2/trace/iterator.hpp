@@ -36,6 +36,9 @@ struct IteratorImpl {
   virtual sim::api2::packet::Payload payload(std::size_t loc) const = 0;
   virtual std::size_t next(std::size_t loc, Level level) const = 0;
   virtual std::size_t prev(std::size_t loc, Level level) const = 0;
+  // Bounded buffers discard their oldest frames. Returns true if loc has been discarded. For the reverse end sentinel,
+  // returns true if anything has been discarded, i.e., reverse iteration stopped short of the start of the trace.
+  virtual bool evicted(std::size_t loc) const { return false; }
 };
 
 enum class Direction {
@@ -92,6 +95,9 @@ public:
 
   std::size_t fragment_size() const { return _impl->size_at(_location, Current); }
 
+  // See IteratorImpl::evicted. Dereferencing an evicted iterator throws.
+  bool evicted() const { return _impl->evicted(_location); }
+
   value_type operator*() const {
     if constexpr (Current == Level::Frame) return _impl->frame(_location);
     else if constexpr (Current == Level::Packet) return _impl->packet(_location);
@@ -1,17 +1,59 @@
 #include "debugger.hpp"
 
-void pepp::sim::Debugger::addBP(quint16 address) { _breakpoints.insert(address); }
+void pepp::sim::Debugger::addBP(quint16 address, Condition condition) {
+  _breakpoints.set(address);
+  if (condition) _conditions[address] = condition;
+  else _conditions.remove(address);
+}
+
+void pepp::sim::Debugger::removeBP(quint16 address) {
+  _breakpoints.reset(address);
+  _conditions.remove(address);
+}
 
-void pepp::sim::Debugger::removeBP(quint16 address) { _breakpoints.remove(address); }
+bool pepp::sim::Debugger::hasBP(quint16 address) const { return _breakpoints.test(address); }
 
-bool pepp::sim::Debugger::hasBP(quint16 address) const { return _breakpoints.contains(address); }
+void pepp::sim::Debugger::clearBPs() {
+  _breakpoints.reset();
+  _conditions.clear();
+}
 
-void pepp::sim::Debugger::clearBPs() { _breakpoints.clear(); }
+void pepp::sim::Debugger::addWatchpoint(quint16 lower, quint16 upper, Access access) {
+  for (quint32 it = lower; it <= upper; it++) {
+    if (quint8(access) & quint8(Access::Read)) _watchRead.set(it);
+    if (quint8(access) & quint8(Access::Write)) _watchWrite.set(it);
+  }
+  _watchingReads = _watchRead.any(), _watchingWrites = _watchWrite.any();
+}
 
-void pepp::sim::Debugger::notifyPCChanged(quint16 newValue) {
-  if (_breakpoints.contains(newValue)) _hit = true;
+void pepp::sim::Debugger::removeWatchpoint(quint16 lower, quint16 upper, Access access) {
+  for (quint32 it = lower; it <= upper; it++) {
+    if (quint8(access) & quint8(Access::Read)) _watchRead.reset(it);
+    if (quint8(access) & quint8(Access::Write)) _watchWrite.reset(it);
+  }
+  _watchingReads = _watchRead.any(), _watchingWrites = _watchWrite.any();
 }
 
+void pepp::sim::Debugger::clearWatchpoints() {
+  _watchRead.reset(), _watchWrite.reset();
+  _watchingReads = _watchingWrites = false;
+}
+
+void pepp::sim::Debugger::notifyAccess(const Bitmap &watched, quint16 address, std::size_t length, Access access) {
+  // Accesses may wrap around the end of the address space.
+  for (std::size_t it = 0; it < length; it++) {
+    if (!watched.test(quint16(address + it))) continue;
+    _hit = true;
+    if (!_watchHit) _watchHit = WatchHit{.address = quint16(address + it), .access = access};
+    return;
+  }
+}
+
+std::optional<pepp::sim::Debugger::WatchHit> pepp::sim::Debugger::watchHit() const { return _watchHit; }
+
 bool pepp::sim::Debugger::hit() const { return _hit; }
 
-void pepp::sim::Debugger::clearHit() { _hit = false; }
+void pepp::sim::Debugger::clearHit() {
+  _hit = false;
+  _watchHit = std::nullopt;
+}
@@ -1,21 +1,56 @@
 #pragma once
 #include <QtCore>
+#include <bitset>
+#include <functional>
 
 namespace pepp::sim {
 class Debugger {
 public:
   Debugger() = default;
-  void addBP(quint16 address);
+  // Breakpoints are stored as a bitmap over the address space, so checking the PC is O(1) regardless of how many
+  // breakpoints are set. A condition is only evaluated when the PC hits its breakpoint, and the breakpoint only
+  // triggers if the condition returns true (e.g., to break when a register has a particular value).
+  using Condition = std::function<bool()>;
+  void addBP(quint16 address, Condition condition = nullptr);
   void removeBP(quint16 address);
   bool hasBP(quint16 address) const;
   void clearBPs();
-  void notifyPCChanged(quint16 newValue);
+  inline void notifyPCChanged(quint16 newValue) {
+    if (!_breakpoints.test(newValue)) return;
+    else if (auto it = _conditions.constFind(newValue); it == _conditions.cend() || (*it)()) _hit = true;
+  }
+
+  // Watchpoints trigger after a data access touches any address in [lower, upper]. Instruction fetches are ignored.
+  enum class Access : quint8 { Read = 1, Write = 2, ReadWrite = 3 };
+  void addWatchpoint(quint16 lower, quint16 upper, Access access);
+  // Stops watching every address in [lower, upper], even if it was added as part of a different range.
+  void removeWatchpoint(quint16 lower, quint16 upper, Access access);
+  void clearWatchpoints();
+  // Called by a memory port (e.g., DirectPort) before each data access.
+  inline void notifyRead(quint16 address, std::size_t length) {
+    if (_watchingReads) notifyAccess(_watchRead, address, length, Access::Read);
+  }
+  inline void notifyWrite(quint16 address, std::size_t length) {
+    if (_watchingWrites) notifyAccess(_watchWrite, address, length, Access::Write);
+  }
+  struct WatchHit {
+    quint16 address;
+    Access access;
+  };
+  // The first watchpoint triggered since the last clearHit.
+  std::optional<WatchHit> watchHit() const;
 
   bool hit() const;
   void clearHit();
 
 private:
-  QSet<quint16> _breakpoints;
+  using Bitmap = std::bitset<0x1'00'00>;
+  Bitmap _breakpoints, _watchRead, _watchWrite;
+  // Cached, since Bitmap::any is O(address space).
+  bool _watchingReads = false, _watchingWrites = false;
+  QHash<quint16, Condition> _conditions;
   bool _hit = false;
+  std::optional<WatchHit> _watchHit = std::nullopt;
+  void notifyAccess(const Bitmap &watched, quint16 address, std::size_t length, Access access);
 };
 }; // namespace pepp::sim
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "profiler.hpp"
+#include <map>
+
+pepp::sim::Profiler::Profiler() { clear(); }
+
+void pepp::sim::Profiler::notifyInstruction(quint16 pc, quint8 is) {
+  // Until the first call, instructions belong to whichever routine the simulation started in.
+  if (_instructions++ == 0) _nodes[0].function = pc;
+  _pcs[pc]++, _opcodes[is]++, _nodes[_current].self++;
+}
+
+void pepp::sim::Profiler::notifyCall(quint16 target, bool trap) {
+  quint64 key = quint64(_current) << 17 | quint64(trap) << 16 | target;
+  auto [it, inserted] = _children.try_emplace(key, quint32(_nodes.size()));
+  if (inserted) _nodes.push_back(Node{.parent = _current, .function = target, .trap = trap});
+  _current = it->second;
+  _nodes[_current].calls++;
+}
+
+void pepp::sim::Profiler::notifyReturn() { _current = _nodes[_current].parent; }
+
+void pepp::sim::Profiler::clear() {
+  _nodes.assign(1, Node{});
+  _children.clear();
+  _current = 0, _instructions = 0;
+  _pcs.assign(0x1'00'00, 0);
+  _opcodes.fill(0);
+}
+
+void pepp::sim::Profiler::setSymbols(QHash<quint16, QString> symbols) { _symbols = symbols; }
+
+QString pepp::sim::Profiler::name(quint16 function) const {
+  if (auto it = _symbols.find(function); it != _symbols.end()) return *it;
+  return QString("0x%1").arg(function, 4, 16, QChar('0'));
+}
+
+void pepp::sim::Profiler::writeFolded(QTextStream &out) const {
+  QStringList stack;
+  for (quint32 index = 0; index < _nodes.size(); index++) {
+    if (_nodes[index].self == 0) continue;
+    stack.clear();
+    for (auto it = index; it != 0; it = _nodes[it].parent) stack.push_front(name(_nodes[it].function));
+    stack.push_front(name(_nodes[0].function));
+    out << stack.join(';') << ' ' << _nodes[index].self << '\n';
+  }
+}
+
+QJsonObject pepp::sim::Profiler::summary(const std::function<QString(quint8)> &opcodeName) const {
+  QJsonArray pcs;
+  for (int pc = 0; pc < int(_pcs.size()); pc++)
+    if (_pcs[pc] != 0) pcs.append(QJsonObject{{"pc", pc}, {"count", qint64(_pcs[pc])}});
+
+  // Several specifiers may share a name, e.g., if the name omits the addressing mode.
+  QMap<QString, quint64> opcodeCounts;
+  for (int is = 0; is < int(_opcodes.size()); is++)
+    if (_opcodes[is] != 0) opcodeCounts[opcodeName ? opcodeName(is) : QString::number(is)] += _opcodes[is];
+  QJsonArray opcodes;
+  for (auto it = opcodeCounts.cbegin(); it != opcodeCounts.cend(); ++it)
+    opcodes.append(QJsonObject{{"opcode", it.key()}, {"count", qint64(it.value())}});
+
+  // Merge the calling contexts of each function, so that the call graph has one edge per caller/callee pair.
+  std::map<std::tuple<quint16, quint16, bool>, quint64> edges;
+  for (quint32 index = 1; index < _nodes.size(); index++) {
+    const auto &node = _nodes[index];
+    edges[{_nodes[node.parent].function, node.function, node.trap}] += node.calls;
+  }
+  QJsonArray calls;
+  for (const auto &[edge, count] : edges) {
+    auto [caller, callee, trap] = edge;
+    calls.append(QJsonObject{
+        {"caller", name(caller)}, {"callee", name(callee)}, {"trap", trap}, {"count", qint64(count)}});
+  }
+
+  return QJsonObject{{"instructions", qint64(_instructions)}, {"pcs", pcs}, {"opcodes", opcodes}, {"calls", calls}};
+}
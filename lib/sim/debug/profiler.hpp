@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+#include <unordered_map>
+
+namespace pepp::sim {
+// Counts executed instructions by PC and by instruction specifier, and attributes them to a calling context tree
+// built from call and return notifications. Like Debugger, a CPU notifies the profiler as it executes; every
+// notification is a handful of array increments, except for calls, which also perform one hash lookup.
+class Profiler {
+public:
+  Profiler();
+  void notifyInstruction(quint16 pc, quint8 is);
+  // trap is true for system calls (e.g., SCALL), so that they can be distinguished from subroutine calls.
+  void notifyCall(quint16 target, bool trap = false);
+  // Returns from the innermost call or trap. Unmatched returns (e.g., from before profiling began) are ignored.
+  void notifyReturn();
+  void clear();
+
+  quint64 instructions() const { return _instructions; }
+  quint64 count(quint16 pc) const { return _pcs[pc]; }
+  quint64 opcodeCount(quint8 is) const { return _opcodes[is]; }
+
+  // Used to name functions in exports. Functions without a symbol are named by their address.
+  void setSymbols(QHash<quint16, QString> symbols);
+  // One line per distinct call stack, e.g., "main;printf;putc 120", where the count is the number of instructions
+  // executed with exactly that stack. This is the folded format consumed by flame graph tools.
+  void writeFolded(QTextStream &out) const;
+  // Per-PC and per-opcode counts, and the call graph as caller/callee edges. opcodeName names an instruction
+  // specifier; if null, specifiers are written as numbers.
+  QJsonObject summary(const std::function<QString(quint8)> &opcodeName = nullptr) const;
+
+private:
+  // A function in the context of the chain of calls which reached it. The root is the code executed before any call.
+  struct Node {
+    quint32 parent = 0;
+    quint16 function = 0;
+    bool trap = false;
+    quint64 calls = 0, self = 0;
+  };
+  std::vector<Node> _nodes;
+  // Keyed by (parent << 17 | trap << 16 | function).
+  std::unordered_map<quint64, quint32> _children;
+  quint32 _current = 0;
+  quint64 _instructions = 0;
+  std::vector<quint64> _pcs;
+  std::array<quint64, 256> _opcodes;
+  QHash<quint16, QString> _symbols;
+  QString name(quint16 function) const;
+};
+} // namespace pepp::sim
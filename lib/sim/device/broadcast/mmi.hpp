@@ -54,7 +54,19 @@ public:
 
   // Helpers
   QSharedPointer<typename detail::Channel<Address, quint8>::Endpoint> endpoint();
+  // Captures the port's stream and this port's position within it. See Channel::Snapshot.
+  struct Snapshot {
+    typename detail::Channel<Address, quint8>::Snapshot channel;
+    std::size_t position;
+    quint8 fill;
+  };
+  Snapshot snapshot() const;
+  void restore(const Snapshot &snapshot);
   void setFailPolicy(api2::memory::FailPolicy policy);
+  // Called when the program reads past the end of the buffered input, so that input can be appended on demand rather
+  // than all at once. It should append values to an endpoint, and return false once no more input is available.
+  using Refill = std::function<bool()>;
+  void setRefill(Refill refill) { _refill = refill; }
 
 private:
   quint8 _fill;
@@ -63,6 +75,8 @@ private:
   QSharedPointer<detail::Channel<Address, quint8>> _channel;
   QSharedPointer<typename detail::Channel<Address, quint8>::Endpoint> _endpoint;
   api2::memory::FailPolicy _policy = api2::memory::FailPolicy::RaiseError;
+  Refill _refill = nullptr;
+  std::optional<quint8> nextValue() const;
 
   api2::trace::Buffer *_tb = nullptr;
 };
@@ -97,8 +111,24 @@ QSharedPointer<typename detail::Channel<Address, quint8>::Endpoint> Input<Addres
   return _channel->new_endpoint();
 }
 
+template <typename Address> typename Input<Address>::Snapshot Input<Address>::snapshot() const {
+  return {.channel = _channel->snapshot(), .position = _endpoint->event_id(), .fill = _fill};
+}
+
+template <typename Address> void Input<Address>::restore(const Snapshot &snapshot) {
+  _fill = snapshot.fill;
+  _channel->restore(snapshot.channel);
+  _endpoint->set_to(snapshot.position);
+}
+
 template <typename Address> void Input<Address>::setFailPolicy(api2::memory::FailPolicy policy) { _policy = policy; }
 
+template <typename Address> std::optional<quint8> Input<Address>::nextValue() const {
+  auto next = _endpoint->next_value();
+  while (!next && _refill && _refill()) next = _endpoint->next_value();
+  return next;
+}
+
 template <typename Address>
 bool Input<Address>::analyze(api2::trace::PacketIterator iter, api2::trace::Direction direction) {
   auto header = *iter;
@@ -138,7 +168,7 @@ api2::memory::Result Input<Address>::read(Address address, bits::span<quint8> de
     bits::memcpy(dest, bits::span<const quint8>{&tmp, 1});
     // Return early to avoid guard extra guard condition in trace code.
     return {};
-  } else if (auto next = _endpoint->next_value(); _policy == api2::memory::FailPolicy::RaiseError && !next) {
+  } else if (auto next = nextValue(); _policy == api2::memory::FailPolicy::RaiseError && !next) {
     throw E(E::Type::NeedsMMI, address);
   } else if (_policy == api2::memory::FailPolicy::YieldDefaultValue && !next) {
     bits::memcpy(dest, bits::span<const quint8>{&_fill, 1});
@@ -54,6 +54,14 @@ public:
 
   // Helpers
   QSharedPointer<typename detail::Channel<Address, quint8>::Endpoint> endpoint();
+  // Captures the port's stream and this port's position within it. See Channel::Snapshot.
+  struct Snapshot {
+    typename detail::Channel<Address, quint8>::Snapshot channel;
+    std::size_t position;
+    quint8 fill;
+  };
+  Snapshot snapshot() const;
+  void restore(const Snapshot &snapshot);
 
 private:
   quint8 _fill;
@@ -94,6 +102,16 @@ QSharedPointer<typename detail::Channel<Address, quint8>::Endpoint> Output<Addre
   return _channel->new_endpoint();
 }
 
+template <typename Address> typename Output<Address>::Snapshot Output<Address>::snapshot() const {
+  return {.channel = _channel->snapshot(), .position = _endpoint->event_id(), .fill = _fill};
+}
+
+template <typename Address> void Output<Address>::restore(const Snapshot &snapshot) {
+  _fill = snapshot.fill;
+  _channel->restore(snapshot.channel);
+  _endpoint->set_to(snapshot.position);
+}
+
 template <typename Address>
 bool Output<Address>::analyze(api2::trace::PacketIterator iter, api2::trace::Direction direction) {
   auto header = *iter;
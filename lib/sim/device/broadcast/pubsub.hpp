@@ -19,6 +19,7 @@
 
 #include <QtCore>
 #include <optional>
+#include <vector>
 
 namespace sim::memory::detail {
 
@@ -35,16 +36,17 @@ class Channel : public QEnableSharedFromThis<Channel<offset_t, val_size_t>> {
    * push-based updates. Inside of the WebASM runtime, we do not have this
    * luxury, mandating pull updates.
    *
-   * This class is based on a state-graph.
-   * Pointers are mantained to the root (aka head) and most distant child (aka
-   * tail). Added nodes are added as children of the most distant child, and the
-   * tail pointer is updated. In the case of a revert, the node before the
-   * selected node is set as the new tail, and all subsequent nodes are made to
-   * transition to the new tail on an empty, forced transition.
+   * Events are stored in a single contiguous array, where an event's index is
+   * its displacement from the root (aka head). The root holds the default
+   * value. Endpoints are cursors into that array, so publishing or consuming a
+   * value does not allocate once the array has grown to fit the stream.
+   * Storage is retained across clears, and a revert only truncates the array.
    *
-   * Since events are stored in shared pointers, they will be garbage collected
-   * after the last reference expires. This makes us free to fiddle with
-   * prev_node, next_node without any danger of leaking memory.
+   * In the case of a revert, all events after the selected event are
+   * discarded. Endpoints which pointed to a discarded event are moved back to
+   * the new tail, but remember the value they were pointing to. Their next
+   * step in either direction lands on the new tail. In effect, they behave as
+   * if they had been sitting on an empty node which forwards to the tail.
    */
 public:
   using version_t = uint32_t;
@@ -52,45 +54,46 @@ public:
   class Endpoint;
 
 protected:
-  class Event;
-  // Add an event to the event queue. Must track publisher in order to allow
-  // undo of writes.
-  QSharedPointer<const Event> append_event(publisher_id_t publisher, val_size_t value);
-  // Find the the most recent write by publisher in the state graph before time
-  // time. Name it N. Make all subsequent nodes prev_node and next_node point to
-  // N, and mark them as empty. Lastly, set the tail to N. In effect, this
-  // method backs out all changes made by the system until the moment before
-  // publisher's last write.
-  QSharedPointer<const Event> revert_event(publisher_id_t publisher, size_t time);
-  // Convert a displacement from the root (aka time) into a Event object.
-  // Will crash if time is greater than tail's displacement.
-  QSharedPointer<const Event> event_at(size_t time) const;
-  // Advance one logical timestep and return that event. One logical timestep
-  // differs from following a single event->next_node. If the node is marked as
-  // empty, then next node is fetched until a non-empty node is found. This
-  // "skip" mechanism allows for deeply nested reverts.
-  QSharedPointer<const Event> next_event(QSharedPointer<const Event> event) const;
-  QSharedPointer<const Event> next_event(size_t time) const;
-  // Step back one logical timestep and return that event. One logical timestep
-  // differs from following a single event->prev_node. If the node is marked as
-  // empty, then next node is fetched until a non-empty node is found. This
-  // "skip" mechanism allows for deeply nested reverts.
-  QSharedPointer<const Event> previous_event(QSharedPointer<const Event> event) const;
-  QSharedPointer<const Event> previous_event(size_t time) const;
-  // Jump forward to the most recent event.
-  QSharedPointer<const Event> latest_event() const;
+  struct Event {
+    val_size_t value;
+    publisher_id_t publisher;
+  };
+  // Find the the most recent write by publisher at or before time time. Name
+  // it N. Discard all events after the event before N, and move endpoints
+  // which pointed to discarded events to the new tail. In effect, this method
+  // backs out all changes made by the system until the moment before
+  // publisher's last write. Returns the time of the new tail.
+  size_t revert_event(publisher_id_t publisher, size_t time);
+  // Discard all events after time.
+  void truncate(size_t time);
+  // Move every endpoint to the root, as if all events had been discarded.
+  void discard_all();
+  // Discard all events before time, making the event at time the new root. Endpoints which pointed to a discarded
+  // event are moved to the root, but remember the value they were pointing to.
+  void trim(size_t time);
 
 public:
   // Pick a value for the root of the state graph.
   Channel(val_size_t default_value);
-  // Jump backward to the default-valued event.
-  QSharedPointer<const Event> clear(val_size_t default_value);
+  // Discard all events and start over with a default-valued root.
+  void clear(val_size_t default_value);
   // Create a new subscriber+publisher on the present channel.
   QSharedPointer<Endpoint> new_endpoint();
+  // Events are implicitly shared with the snapshot until either side appends or reverts, so capturing and restoring
+  // a channel is O(1). Restoring moves endpoints off of their events, as clear() does.
+  struct Snapshot {
+    QVector<Event> events;
+  };
+  Snapshot snapshot() const;
+  void restore(const Snapshot &snapshot);
 
   class Endpoint {
   public:
-    Endpoint(QSharedPointer<const Event> event, publisher_id_t id, QSharedPointer<Channel> channel);
+    Endpoint(size_t time, publisher_id_t id, QSharedPointer<Channel> channel);
+    ~Endpoint();
+    // The channel tracks endpoints by address.
+    Endpoint(const Endpoint &) = delete;
+    Endpoint &operator=(const Endpoint &) = delete;
     // Return a new endpoint which points to the same event, but with a
     // different producer ID.
     QSharedPointer<Endpoint> clone() const;
@@ -100,6 +103,8 @@ public:
     // Provide ways to seek an endpoint to the beggining or end of a stream.
     val_size_t set_to_head();
     val_size_t set_to_tail();
+    // Seek to a value previously returned by event_id. Must not be past the tail.
+    val_size_t set_to(std::size_t event_id);
     // Step forward one logical timestep through the state graph, and return the
     // value of that node. Must be const so that storage devices derived from
     // this class can have a read(...) const method.
@@ -114,259 +119,197 @@ public:
     // endpoint's last write.
     std::optional<val_size_t> unwrite();
     bool at_end() const;
+    // Discard every event before this endpoint, so that the channel's memory does not grow with the length of a
+    // stream that is never rewound. Events which other endpoints have yet to read are lost.
+    void trim_before();
 
   private:
-    // Pointer to current node must be mutable, so that next_value can be const.
-    mutable QSharedPointer<const Event> event;
+    friend class Channel;
+    // Cursor must be mutable, so that next_value can be const.
+    mutable size_t time;
+    // If the event under the cursor was discarded by a revert, its value.
+    mutable std::optional<val_size_t> discarded = std::nullopt;
     publisher_id_t id;
     // Pointer to the channel which created this endpoint.
     const QSharedPointer<Channel> channel;
   };
 
-protected:
-  struct Event {
-    // You should not instantiate this class directly. Rather, you should create
-    // one through Channel::append_value(). append_value() will ensure that
-    // class invariants are mantained. Events are always appended to the end of
-    // the state graph, so next_node is always init'ed to nullptr. All other
-    // fields cannot be automatically derived.
-    Event(val_size_t value, publisher_id_t publisher, bool empty, QSharedPointer<Event> prev_node, size_t displacement);
-
-    val_size_t value;
-    publisher_id_t publisher;
-    // If true, this node should be ignored, and its transition immediately
-    // taken.
-    bool empty;
-    // Next event in the directed event tree.
-    QSharedPointer<Event> next_node, prev_node;
-    // How many nodes between this node and the tree root.
-    size_t displacement;
-  };
-
 private:
   publisher_id_t next_id = 1;
-  QSharedPointer<Event> head{}, tail{};
-  QSharedPointer<Event> mutable_event_at(size_t time);
+  QVector<Event> events;
+  // Endpoints register themselves on construction so that reverts can move
+  // them off of discarded events.
+  std::vector<Endpoint *> endpoints;
 };
 
 template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::append_event(publisher_id_t publisher, val_size_t value) {
-  tail->next_node = QSharedPointer<Event>::create(value, publisher, false, tail, tail->displacement + 1);
-  tail = tail->next_node;
-  return tail;
-}
-
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::revert_event(publisher_id_t publisher, size_t time) {
-  QSharedPointer<Event> fixup = {}, fixup_next = {}, ptr = mutable_event_at(time);
-
-  // Find the last node which the publisher added, or the head.
-  while (ptr->prev_node && ptr->publisher != publisher) ptr = ptr->prev_node;
-  // ptr now points to the node which we want to revert or head.
-  // If it doesn't point to head, we want to go back one more step, (i.e., the
+size_t Channel<offset_t, val_size_t>::revert_event(publisher_id_t publisher, size_t time) {
+  // Find the last event which the publisher added, or the head.
+  size_t ptr = time;
+  while (ptr > 0 && events.at(ptr).publisher != publisher) ptr--;
+  // If ptr doesn't point to head, we want to go back one more step, (i.e., the
   // value to be reverted to).
-  if (ptr != head) ptr = ptr->prev_node;
-  // We want to fixup any node after ptr.
-  fixup = ptr->next_node;
-  while (fixup) {
-    // Must cache next node, or we will lose it forever.
-    fixup_next = fixup->next_node;
-    // Force the node to point to the new "latest" value in either direction.
-    fixup->prev_node = fixup->next_node = ptr;
-    // And mark the node as empty, so that next_event and previous_event will
-    // "skip" this node.
-    fixup->empty = true;
-    fixup = fixup_next;
-  }
-  // ptr no longer has any children.
-  ptr->next_node = nullptr;
-  // Reset tail to be this newly reverted node.
-  tail = ptr;
-  return tail;
-}
-
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::event_at(size_t time) const {
-  // No event can have a timestamp higher than the distance between the tail and
-  // head.
-  if (time > tail->displacement) return nullptr;
-  auto ptr = head;
-  while (ptr->displacement != time) ptr = ptr->next_node;
+  if (ptr > 0) ptr--;
+  truncate(ptr);
   return ptr;
 }
 
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::next_event(QSharedPointer<const Event> event) const {
-  // If there is no subsequent event, then return the current event.
-  if (event->next_node == nullptr) return event;
-  // Otherwise traverse the list, continuing over empty nodes.
-  // In this case, stop when the current node is non-empty, or until the end of
-  // the list.
-  do {
-    event = event->next_node;
-  } while (event->empty && event->next_node);
-  return event;
+template <typename offset_t, typename val_size_t> void Channel<offset_t, val_size_t>::truncate(size_t time) {
+  for (auto endpoint : endpoints) {
+    if (endpoint->time <= time) continue;
+    // An endpoint which was already moved by an earlier revert keeps its original value.
+    else if (!endpoint->discarded) endpoint->discarded = events.at(endpoint->time).value;
+    endpoint->time = time;
+  }
+  events.resize(time + 1);
 }
 
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::next_event(size_t time) const {
-  auto ptr = event_at(time);
-  return next_event(ptr);
+template <typename offset_t, typename val_size_t> Channel<offset_t, val_size_t>::Channel(val_size_t default_value) {
+  events.push_back({default_value, 0});
 }
 
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::previous_event(QSharedPointer<const Event> event) const {
-  // If there is no subsequent event, then return the current event.
-  if (event->prev_node == nullptr) return event;
-  // Otherwise traverse the list, continuing over empty nodes.
-  // In this case, stop when the current node is non-empty, or until the start
-  // of the list.
-  do {
-    event = event->prev_node;
-  } while (event->empty && event->prev_node);
-  return event;
+template <typename offset_t, typename val_size_t> void Channel<offset_t, val_size_t>::clear(val_size_t default_value) {
+  // Every event is discarded, including the old root. Resizing does not release the array's capacity.
+  discard_all();
+  events.resize(1);
+  events[0] = {default_value, 0};
 }
 
 template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::previous_event(size_t time) const {
-  // If we have the index of head, no need to waste time in event_at, just
-  // return head directly.
-  if (time == 0) return head;
-  auto ptr = event_at(time);
-  return previous_event(ptr);
+typename Channel<offset_t, val_size_t>::Snapshot Channel<offset_t, val_size_t>::snapshot() const {
+  return {events};
 }
 
 template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::latest_event() const {
-  return tail;
+void Channel<offset_t, val_size_t>::restore(const Snapshot &snapshot) {
+  discard_all();
+  events = snapshot.events;
 }
 
-template <typename offset_t, typename val_size_t> Channel<offset_t, val_size_t>::Channel(val_size_t default_value) {
-  this->head = this->tail = QSharedPointer<Event>::create(default_value, 0, false, nullptr, 0);
+template <typename offset_t, typename val_size_t> void Channel<offset_t, val_size_t>::discard_all() {
+  for (auto endpoint : endpoints) {
+    if (!endpoint->discarded) endpoint->discarded = events.at(endpoint->time).value;
+    endpoint->time = 0;
+  }
 }
 
-template <typename offset_t, typename val_size_t>
-QSharedPointer<const typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::clear(val_size_t default_value) {
-  // Revert to the first event in the graph, which is the default value.
-  // Depend on the fact that revert event will default to head when given an OOB
-  // time/publisher combo.
-  this->revert_event(0, 0);
-  auto temp = QSharedPointer<Event>::create(default_value, 0, false, nullptr, 0);
-  // Both head and tail will point to the same object, so we only need to update
-  // one.
-  head->next_node = head->prev_node = temp;
-  return head = tail = temp;
+template <typename offset_t, typename val_size_t> void Channel<offset_t, val_size_t>::trim(size_t time) {
+  if (time == 0) return;
+  for (auto endpoint : endpoints) {
+    if (endpoint->time >= time) endpoint->time -= time;
+    else {
+      if (!endpoint->discarded) endpoint->discarded = events.at(endpoint->time).value;
+      endpoint->time = 0;
+    }
+  }
+  events.remove(0, time);
+  // Reverts stop at the root, so it must not be attributed to a publisher.
+  events[0].publisher = 0;
 }
 
 template <typename offset_t, typename val_size_t>
 QSharedPointer<typename Channel<offset_t, val_size_t>::Endpoint> Channel<offset_t, val_size_t>::new_endpoint() {
-  return QSharedPointer<Endpoint>::create(tail, this->next_id++, this->sharedFromThis());
+  return QSharedPointer<Endpoint>::create(events.size() - 1, this->next_id++, this->sharedFromThis());
 }
 
 template <typename offset_t, typename val_size_t>
-QSharedPointer<typename Channel<offset_t, val_size_t>::Event>
-Channel<offset_t, val_size_t>::mutable_event_at(size_t time) {
-  // No event can have a timestamp higher than the distance between the tail and
-  // head.
-  if (time > tail->displacement) return nullptr;
-  auto ptr = head;
-  while (ptr->displacement != time) ptr = ptr->next_node;
-  return ptr;
+Channel<offset_t, val_size_t>::Endpoint::Endpoint(size_t time, publisher_id_t id, QSharedPointer<Channel> channel)
+    : time(time), id(id), channel(channel) {
+  channel->endpoints.push_back(this);
 }
 
-template <typename offset_t, typename val_size_t>
-Channel<offset_t, val_size_t>::Endpoint::Endpoint(QSharedPointer<const Event> event, publisher_id_t id,
-                                                  QSharedPointer<Channel> channel)
-    : event(event), id(id), channel(channel) {}
+template <typename offset_t, typename val_size_t> Channel<offset_t, val_size_t>::Endpoint::~Endpoint() {
+  std::erase(channel->endpoints, this);
+}
 
 template <typename offset_t, typename val_size_t>
 QSharedPointer<typename Channel<offset_t, val_size_t>::Endpoint>
 Channel<offset_t, val_size_t>::Endpoint::clone() const {
   auto ret = channel->new_endpoint();
-  ret->event = channel->event_at(event->displacement);
+  ret->time = time;
   return ret;
 }
 
 template <typename offset_t, typename val_size_t>
 std::optional<val_size_t> Channel<offset_t, val_size_t>::Endpoint::current_value() const {
-  return this->event->value;
+  if (discarded) return discarded;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t>
 std::size_t Channel<offset_t, val_size_t>::Endpoint::event_id() const {
-  return reinterpret_cast<std::size_t>((void *)this->event.get());
+  return time;
 }
 
 template <typename offset_t, typename val_size_t> val_size_t Channel<offset_t, val_size_t>::Endpoint::set_to_head() {
   // Even if we are at head, return the value.
-  auto new_event = channel->event_at(0);
-  this->event = new_event;
-  return event->value;
+  discarded = std::nullopt;
+  time = 0;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t> val_size_t Channel<offset_t, val_size_t>::Endpoint::set_to_tail() {
   // Even if we are at tail, return the value.
-  auto new_event = channel->latest_event();
-  this->event = new_event;
-  return event->value;
+  discarded = std::nullopt;
+  time = channel->events.size() - 1;
+  return channel->events.at(time).value;
+}
+
+template <typename offset_t, typename val_size_t>
+val_size_t Channel<offset_t, val_size_t>::Endpoint::set_to(std::size_t event_id) {
+  if (event_id >= std::size_t(channel->events.size())) throw std::logic_error("Event does not exist");
+  discarded = std::nullopt;
+  time = event_id;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t>
 std::optional<val_size_t> Channel<offset_t, val_size_t>::Endpoint::next_value() const {
-  // If we pass next_event the index of the last event, it'll return the last
-  // event. In this case, there is no new value to read, so return a nullopt and
-  // don't modify time.
-  auto new_event = channel->next_event(event);
-  if (event == new_event) return std::nullopt;
-  this->event = new_event;
-  return event->value;
+  // A revert already moved us to the new tail, so the step forward is the tail itself.
+  if (discarded) discarded = std::nullopt;
+  // If we are at the last event, there is no new value to read, so return a
+  // nullopt and don't modify time.
+  else if (time + 1 >= std::size_t(channel->events.size())) return std::nullopt;
+  else time++;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t>
 void Channel<offset_t, val_size_t>::Endpoint::append_value(val_size_t new_value) {
-  this->event = channel->append_event(id, new_value);
+  channel->events.push_back({new_value, id});
+  discarded = std::nullopt;
+  time = channel->events.size() - 1;
 }
 
 template <typename offset_t, typename val_size_t>
 std::optional<val_size_t> Channel<offset_t, val_size_t>::Endpoint::unread() {
-  // The only way the previous node of event is event is if we are at head.
-  // In that case, return nullopt to indicate that you should stop calling this
-  // function.
-  auto old_event = channel->previous_event(event);
-  if (event == old_event) return std::nullopt;
-  this->event = old_event;
-  return event->value;
+  // As in next_value, a revert already moved us one logical step.
+  if (discarded) discarded = std::nullopt;
+  // If we are at head, return nullopt to indicate that you should stop calling
+  // this function.
+  else if (time == 0) return std::nullopt;
+  else time--;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t>
 std::optional<val_size_t> Channel<offset_t, val_size_t>::Endpoint::unwrite() {
-  // The only way the previous node of event is event is if we are at head.
-  // In that case, return nullopt to indicate that you should stop calling this
-  // function. If there is no previous write by this endpoint, old_event will be
-  // set to head.
-  auto old_event = channel->revert_event(this->id, event->displacement);
-  if (event == old_event) return std::nullopt;
-  this->event = old_event;
-  return event->value;
+  // If there is no previous write by this endpoint, the channel is reverted to
+  // head. If we were already at head, return nullopt to indicate that you
+  // should stop calling this function.
+  auto old_time = time;
+  time = channel->revert_event(this->id, time);
+  discarded = std::nullopt;
+  if (old_time == 0) return std::nullopt;
+  return channel->events.at(time).value;
 }
 
 template <typename offset_t, typename val_size_t> bool Channel<offset_t, val_size_t>::Endpoint::at_end() const {
-  return this->event == channel->latest_event();
+  return !discarded && time + 1 == std::size_t(channel->events.size());
 }
 
-template <typename offset_t, typename val_size_t>
-Channel<offset_t, val_size_t>::Event::Event(val_size_t value, publisher_id_t publisher, bool empty,
-                                            QSharedPointer<Event> prev_node, size_t displacement)
-    : value(value), publisher(publisher), empty(empty), next_node(nullptr), prev_node(prev_node),
-      displacement(displacement) {}
+template <typename offset_t, typename val_size_t> void Channel<offset_t, val_size_t>::Endpoint::trim_before() {
+  channel->trim(time);
+}
 
 } // namespace sim::memory::detail
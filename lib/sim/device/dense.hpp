@@ -21,7 +21,10 @@
 
 namespace sim::memory {
 template <typename Address>
-class Dense : public api2::memory::Target<Address>, public api2::trace::Source, public api2::trace::Sink {
+class Dense : public api2::memory::Target<Address>,
+              public api2::memory::Direct<Address>,
+              public api2::trace::Source,
+              public api2::trace::Sink {
 public:
   using AddressSpan = typename api2::memory::AddressSpan<Address>;
   Dense(api2::device::Descriptor device, AddressSpan span, quint8 defaultValue = 0);
@@ -43,6 +46,10 @@ public:
   void clear(quint8 fill) override;
   void dump(bits::span<quint8> dest) const override;
 
+  // Direct interface
+  const quint8 *directRead(Address address, std::size_t length) const override;
+  quint8 *directWrite(Address address, std::size_t length) override;
+
   // Sink interface
   bool analyze(const api2::trace::PacketIterator iter, api2::trace::Direction) override;
 
@@ -53,6 +60,11 @@ public:
 
   // Helpers
   const quint8 *constData() const;
+  // Storage is implicitly shared with the returned copy until either side is written, so capturing and restoring are
+  // O(1). Pointers from directRead and directWrite never alias shared storage, so they must be re-acquired after
+  // either call (e.g., by SimpleBus::invalidateDirect).
+  QVector<quint8> snapshot() const { return _data; }
+  void restore(const QVector<quint8> &data);
   // Enables re-use of memory across multiple runs.
   void setDevice(api2::device::Descriptor device) { _device = device; }
   void setSpan(AddressSpan span) {
@@ -66,7 +78,8 @@ private:
   quint8 _fill;
   AddressSpan _span;
   api2::device::Descriptor _device;
-  QVector<quint8> _data;
+  // Mutable so that directRead can detach from a snapshot before handing out a pointer.
+  mutable QVector<quint8> _data;
   api2::trace::Buffer *_tb = nullptr;
 };
 
@@ -97,9 +110,29 @@ template <typename Address> void Dense<Address>::trace(bool enabled) {
 
 template <typename Address> const quint8 *sim::memory::Dense<Address>::constData() const { return _data.constData(); }
 
+template <typename Address> void Dense<Address>::restore(const QVector<quint8> &data) {
+  if (data.size() != _data.size()) throw std::logic_error("Snapshot does not match memory size");
+  _data = data;
+}
+
+template <typename Address> const quint8 *Dense<Address>::directRead(Address address, std::size_t length) const {
+  if (address < _span.lower() || std::size_t(address - _span.lower()) + length > std::size_t(_data.size()))
+    return nullptr;
+  // Otherwise a later write would detach, leaving the returned pointer to observe the snapshot.
+  _data.detach();
+  return _data.constData() + (address - _span.lower());
+}
+
+template <typename Address> quint8 *Dense<Address>::directWrite(Address address, std::size_t length) {
+  if (address < _span.lower() || std::size_t(address - _span.lower()) + length > std::size_t(_data.size()))
+    return nullptr;
+  return _data.data() + (address - _span.lower());
+}
+
 namespace detail {
-template <typename Address> struct PayloadHelper {
-  PayloadHelper(Address address, Dense<Address> *dense) : address(address), dense(dense) {}
+// Device may be any Target<Address> whose storage is updated by XOR-ing Write payloads.
+template <typename Address, typename Device = Dense<Address>> struct PayloadHelper {
+  PayloadHelper(Address address, Device *dense) : address(address), dense(dense) {}
 
   static constexpr auto op = api2::memory::Operation{
       .type = api2::memory::Operation::Type::BufferInternal,
@@ -124,7 +157,7 @@ template <typename Address> struct PayloadHelper {
   Address operator()(const auto &frag) const { throw std::logic_error("unimplemented"); }
 
   Address address;
-  Dense<Address> *dense;
+  Device *dense;
 };
 } // namespace detail
 
@@ -155,7 +188,7 @@ api2::memory::Result Dense<Address>::read(Address address, bits::span<quint8> de
   auto maxDestAddr = (address + std::max<Address>(0, dest.size() - 1));
   if (address < _span.lower() || maxDestAddr > _span.upper()) throw E(E::Type::OOBAccess, address);
   auto offset = address - _span.lower();
-  auto src = bits::span<const quint8>{_data.data(), std::size_t(_data.size())}.subspan(offset);
+  auto src = bits::span<const quint8>{_data.constData(), std::size_t(_data.size())}.subspan(offset);
   // Ignore reads from UI, since this device only issues pure reads.
   // Ignore reads from buffer internal operations.
   if (!(op.type == Operation::Type::Application || op.type == Operation::Type::BufferInternal) && _tb)
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "bits/operations/copy.hpp"
+#include "sim/api2.hpp"
+#include "sim/debug/debugger.hpp"
+#include "sim/device/simple_bus.hpp"
+
+namespace sim::memory {
+// Memory port owned by an initiator (e.g., a CPU). Accesses have the same semantics as calling the target directly.
+// If the target is a SimpleBus without a trace buffer, accesses which fall within a single page backed by a Direct
+// device are performed on host memory, skipping the bus's address decoding and the device's bounds checks.
+// Pages which contain MMIO never resolve to host memory, so those devices keep their side effects.
+template <typename Address> class DirectPort {
+public:
+  static constexpr quint8 pageBits = 8;
+  static constexpr std::size_t pageSize = std::size_t(1) << pageBits;
+  static_assert(sizeof(Address) <= 2, "Page table must be small enough to allocate eagerly");
+  static constexpr std::size_t pageCount = (std::size_t(std::numeric_limits<Address>::max()) >> pageBits) + 1;
+
+  void setTarget(api2::memory::Target<Address> *target);
+  api2::memory::Target<Address> *target() const { return _target; }
+  // Accesses through host memory are not traced, so the owner must disable the port while it has a trace buffer.
+  void setEnabled(bool enabled);
+  bool enabled() const { return _enabled; }
+  // Forget all resolved pages. Only needed if a device's storage is reallocated without the bus being remapped.
+  void invalidate() const;
+  // Notified of data accesses made by the simulation (not fetches or UI accesses), so that watchpoints are checked
+  // regardless of whether the access takes the fast path.
+  void setDebugger(pepp::sim::Debugger *debugger) { _dbg = debugger; }
+
+  inline api2::memory::Result read(Address address, bits::span<quint8> dest, api2::memory::Operation op) const {
+    if (_dbg && watched(op)) _dbg->notifyRead(address, dest.size());
+    if (auto page = resolve(address, dest.size()); page && page->read) {
+      bits::memcpy(dest, bits::span<const quint8>{page->read + (address & (pageSize - 1)), dest.size()});
+      return {};
+    }
+    return _target->read(address, dest, op);
+  }
+  inline api2::memory::Result write(Address address, bits::span<const quint8> src, api2::memory::Operation op) {
+    if (_dbg && watched(op)) _dbg->notifyWrite(address, src.size());
+    if (auto page = resolve(address, src.size()); page && page->write) {
+      bits::memcpy(bits::span<quint8>{page->write + (address & (pageSize - 1)), src.size()}, src);
+      // Writes through host memory are invisible to the bus, so initiators which cache memory must be told explicitly.
+      _bus->notifyWrite(address, src.size());
+      return {};
+    }
+    return _target->write(address, src, op);
+  }
+
+private:
+  struct Page {
+    const quint8 *read = nullptr;
+    quint8 *write = nullptr;
+    bool resolved = false;
+  };
+  // Returns nullptr if the access must take the slow path.
+  inline const Page *resolve(Address address, std::size_t length) const {
+    if (!_enabled || !_bus || _bus->buffer() != nullptr) return nullptr;
+    // Accesses which straddle pages may straddle devices, so let the bus split them.
+    else if ((address & (pageSize - 1)) + length > pageSize) return nullptr;
+    else if (_bus->generation() != _generation) invalidate();
+    auto &page = _pages[address >> pageBits];
+    if (!page.resolved) {
+      Address base = address & ~Address(pageSize - 1);
+      page.read = _bus->directRead(base, pageSize);
+      page.write = _bus->directWrite(base, pageSize);
+      page.resolved = true;
+    }
+    return &page;
+  }
+
+  static inline bool watched(api2::memory::Operation op) {
+    return op.type == api2::memory::Operation::Type::Standard && op.kind == api2::memory::Operation::Kind::data;
+  }
+
+  api2::memory::Target<Address> *_target = nullptr;
+  SimpleBus<Address> *_bus = nullptr;
+  pepp::sim::Debugger *_dbg = nullptr;
+  bool _enabled = true;
+  mutable quint32 _generation = 0;
+  mutable std::vector<Page> _pages = std::vector<Page>(pageCount);
+};
+
+template <typename Address> void DirectPort<Address>::setTarget(api2::memory::Target<Address> *target) {
+  _target = target;
+  _bus = dynamic_cast<SimpleBus<Address> *>(target);
+  invalidate();
+}
+
+template <typename Address> void DirectPort<Address>::setEnabled(bool enabled) {
+  _enabled = enabled;
+  invalidate();
+}
+
+template <typename Address> void DirectPort<Address>::invalidate() const {
+  for (auto &page : _pages) page = Page{};
+  if (_bus) _generation = _bus->generation();
+}
+
+} // namespace sim::memory
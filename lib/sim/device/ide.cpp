@@ -58,9 +58,30 @@ void sim::memory::IDEController::execute(Commands command) {
   exec_command();
 }
 
-const sim::memory::Dense<quint32> *sim::memory::IDEController::disk() const { return &_disk; }
+const sim::api2::memory::Target<quint32> *sim::memory::IDEController::disk() const {
+  if (_image) return &*_image;
+  return &_disk;
+}
+
+sim::api2::memory::Target<quint32> *sim::memory::IDEController::disk() {
+  if (_image) return &*_image;
+  return &_disk;
+}
+
+bool sim::memory::IDEController::attachImage(QString fname) {
+  // Reuse the sparse disk's descriptor, so that the image's trace packets are attributed to the same device.
+  auto image = std::make_unique<Mapped<quint32>>(_disk.device(), _disk.span());
+  if (!image->open(fname)) return false;
+  image->setBuffer(_tb);
+  image->trace(_traced);
+  _image = std::move(image);
+  return true;
+}
 
-sim::memory::Dense<quint32> *sim::memory::IDEController::disk() { return &_disk; }
+void sim::memory::IDEController::detachImage() {
+  _image = nullptr;
+  _disk.clear(0);
+}
 
 void sim::memory::IDEController::setTarget(sim::api2::memory::Target<quint16> *target, void *port) { _target = target; }
 
@@ -93,15 +114,19 @@ void sim::memory::IDEController::clear(quint8 fill) { _regs.clear(fill); }
 void sim::memory::IDEController::dump(bits::span<quint8> dest) const { _regs.dump(dest); }
 
 void sim::memory::IDEController::setBuffer(api2::trace::Buffer *tb) {
+  _tb = tb;
   _regs.setBuffer(tb);
   _disk.setBuffer(tb);
+  if (_image) _image->setBuffer(tb);
 }
 
 const sim::api2::trace::Buffer *sim::memory::IDEController::buffer() const { return _regs.buffer(); }
 
 void sim::memory::IDEController::trace(bool enabled) {
+  _traced = enabled;
   _regs.trace(enabled);
   _disk.trace(enabled);
+  if (_image) _image->trace(enabled);
 }
 
 void sim::memory::IDEController::exec_command() {
@@ -113,14 +138,25 @@ void sim::memory::IDEController::exec_command() {
   quint32 curDiskAddress = (((quint32)regs.LBA) << 8) | regs.offLBA;
   quint16 remainingBytes = regs.lenDMA, curMemAddress = regs.addrDMA;
   bits::span<quint8> span;
+  auto disk = this->disk();
+
+  // A mapped image can transfer the whole request in one access, rather than a sector-sized chunk at a time.
+  // Accesses through host memory are not traced, so this is only possible when the disk has no trace buffer.
+  // Transfers which wrap around the end of memory keep the chunked behavior below.
+  api2::memory::Direct<quint32> *direct = nullptr;
+  if (_image && !_image->buffer() && quint32(curMemAddress) + remainingBytes <= 0x1'0000) direct = &*_image;
 
   switch (regs.ideCMD) {
   case (quint8)Commands::READ_DMA:
+    if (auto src = direct ? direct->directRead(curDiskAddress, remainingBytes) : nullptr; src) {
+      _target->write(curMemAddress, {src, remainingBytes}, rw);
+      break;
+    }
     while (remainingBytes > 0) {
       if (sizeof(_buffer) <= remainingBytes) span = bits::span<quint8>(_buffer.data(), sizeof(_buffer));
       else span = bits::span<quint8>(_buffer.data(), remainingBytes);
 
-      _disk.read(curDiskAddress, span, rw);
+      disk->read(curDiskAddress, span, rw);
       _target->write(curMemAddress, span, rw);
       remainingBytes -= span.size();
       curDiskAddress += span.size();
@@ -128,25 +164,33 @@ void sim::memory::IDEController::exec_command() {
     }
     break;
   case (quint8)Commands::WRITE_DMA:
+    if (auto dest = direct ? direct->directWrite(curDiskAddress, remainingBytes) : nullptr; dest) {
+      _target->read(curMemAddress, {dest, remainingBytes}, rw);
+      break;
+    }
     while (remainingBytes > 0) {
       if (sizeof(_buffer) <= remainingBytes) span = bits::span<quint8>(_buffer.data(), sizeof(_buffer));
       else span = bits::span<quint8>(_buffer.data(), remainingBytes);
 
       _target->read(curMemAddress, span, rw);
-      _disk.write(curDiskAddress, span, rw);
+      disk->write(curDiskAddress, span, rw);
       remainingBytes -= span.size();
       curDiskAddress += span.size();
       curMemAddress += span.size();
     }
     break;
   case (quint8)Commands::ERASE:
+    if (auto dest = direct ? direct->directWrite(curDiskAddress, remainingBytes) : nullptr; dest) {
+      std::fill_n(dest, remainingBytes, 0);
+      break;
+    }
     // Ensure buffer is 0'ed out.
     std::fill(_buffer.begin(), _buffer.end(), 0);
     while (remainingBytes > 0) {
       if (sizeof(_buffer) <= remainingBytes) span = bits::span<quint8>(_buffer.data(), sizeof(_buffer));
       else span = bits::span<quint8>(_buffer.data(), remainingBytes);
 
-      _disk.write(curDiskAddress, span, rw);
+      disk->write(curDiskAddress, span, rw);
       remainingBytes -= span.size();
       curDiskAddress += span.size();
     }
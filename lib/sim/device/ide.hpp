@@ -17,6 +17,8 @@
 
 #pragma once
 #include "dense.hpp"
+#include "mapped.hpp"
+#include "sparse.hpp"
 #include "sim/api2.hpp"
 #include "sim/trace2/modified.hpp"
 
@@ -61,8 +63,15 @@ public:
   IDERegs regs() const;
   void setRegs(IDERegs regs, bool triggerExec = false);
   void execute(Commands command);
-  const sim::memory::Dense<quint32> *disk() const;
-  sim::memory::Dense<quint32> *disk();
+  // By default, the disk is sparse, so untouched sectors do not consume host memory.
+  // If an image is attached, the disk is the image instead.
+  const sim::api2::memory::Target<quint32> *disk() const;
+  sim::api2::memory::Target<quint32> *disk();
+  // Back the disk with a memory-mapped host file, so that its contents persist across runs. See Mapped::open.
+  // Returns false if the image could not be mapped, in which case the current disk is kept.
+  bool attachImage(QString fname);
+  // Revert to an empty sparse disk.
+  void detachImage();
 
   // Initiator interface
   void setTarget(sim::api2::memory::Target<quint16> *target, void *port) override;
@@ -88,7 +97,10 @@ private:
   api2::device::Descriptor _device;
   sim::api2::memory::Target<quint16> *_target = nullptr;
   sim::memory::Dense<quint16> _regs;
-  sim::memory::Dense<quint32> _disk;
+  sim::memory::Sparse<quint32> _disk;
+  std::unique_ptr<sim::memory::Mapped<quint32>> _image = nullptr;
+  api2::trace::Buffer *_tb = nullptr;
+  bool _traced = false;
   std::array<quint8, sectorSize> _buffer;
 
   // Helper to enable RAII for _inExec.
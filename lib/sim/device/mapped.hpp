@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <QtCore>
+#include "bits/operations/copy.hpp"
+#include "dense.hpp"
+#include "sim/api2.hpp"
+#include "sim/trace2/packet_utils.hpp"
+
+namespace sim::memory {
+// Like Dense, except that storage is a host file mapped into memory. Writes are persisted to the file, and opening a
+// file does not read it, so the cost of opening an image is independent of its size.
+template <typename Address>
+class Mapped : public api2::memory::Target<Address>,
+               public api2::memory::Direct<Address>,
+               public api2::trace::Source,
+               public api2::trace::Sink {
+public:
+  using AddressSpan = typename api2::memory::AddressSpan<Address>;
+  Mapped(api2::device::Descriptor device, AddressSpan span);
+  // Closing the file unmaps it.
+  ~Mapped() = default;
+  Mapped(Mapped &&other) noexcept = default;
+  Mapped &operator=(Mapped &&other) = default;
+  // Disable copy construction and assignment, since it would be incorrect for
+  // multiple objects to share a device descriptor.
+  Mapped(const Mapped &) = delete;
+  Mapped &operator=(const Mapped &) = delete;
+
+  // Map fname, which is created if it does not exist, and grown to the size of the span if it is too small.
+  // Returns false if the file could not be opened or mapped, in which case the device remains closed.
+  bool open(QString fname);
+  bool isOpen() const { return _data != nullptr; }
+  QString fileName() const { return _file ? _file->fileName() : QString(); }
+
+  // API v2
+  // Target interface
+  sim::api2::device::ID deviceID() const override { return _device.id; }
+  sim::api2::device::Descriptor device() const override { return _device; }
+  AddressSpan span() const override { return _span; }
+  api2::memory::Result read(Address address, bits::span<quint8> dest, api2::memory::Operation op) const override;
+  api2::memory::Result write(Address address, bits::span<const quint8> src, api2::memory::Operation op) override;
+  // Overwrites the contents of the file.
+  void clear(quint8 fill) override;
+  void dump(bits::span<quint8> dest) const override;
+
+  // Direct interface
+  const quint8 *directRead(Address address, std::size_t length) const override;
+  quint8 *directWrite(Address address, std::size_t length) override;
+
+  // Sink interface
+  bool analyze(const api2::trace::PacketIterator iter, api2::trace::Direction) override;
+
+  // Source interface
+  void setBuffer(api2::trace::Buffer *tb) override { _tb = tb; }
+  const api2::trace::Buffer *buffer() const override { return _tb; }
+  void trace(bool enabled) override;
+
+private:
+  AddressSpan _span;
+  api2::device::Descriptor _device;
+  // QFile is not movable, so it is held by pointer to keep this class movable.
+  std::unique_ptr<QFile> _file = nullptr;
+  quint8 *_data = nullptr;
+  api2::trace::Buffer *_tb = nullptr;
+  bits::span<quint8> data() const;
+  // Throws if the device is closed, or if the access is out of bounds.
+  void checkAccess(Address address, std::size_t length) const;
+};
+
+template <typename Address>
+sim::memory::Mapped<Address>::Mapped(api2::device::Descriptor device, AddressSpan span)
+    : _span(span), _device(device) {}
+
+template <typename Address> bool Mapped<Address>::open(QString fname) {
+  auto file = std::make_unique<QFile>(fname);
+  qint64 size = size_inclusive(_span);
+  if (!file->open(QIODevice::ReadWrite)) return false;
+  // Most file systems grow files sparsely, so this does not write size bytes.
+  else if (file->size() < size && !file->resize(size)) return false;
+  auto data = file->map(0, size);
+  if (data == nullptr) return false;
+  _file = std::move(file);
+  _data = data;
+  return true;
+}
+
+template <typename Address> bits::span<quint8> Mapped<Address>::data() const {
+  return {_data, std::size_t(size_inclusive(_span))};
+}
+
+template <typename Address> void Mapped<Address>::checkAccess(Address address, std::size_t length) const {
+  using E = api2::memory::Error;
+  if (!isOpen()) throw std::logic_error("Disk image is not open");
+  // Length is 1-indexed, address are 0, so must offset by -1.
+  auto maxAddr = (address + std::max<Address>(0, length - 1));
+  if (address < _span.lower() || maxAddr > _span.upper()) throw E(E::Type::OOBAccess, address);
+}
+
+template <typename Address> void Mapped<Address>::clear(quint8 fill) {
+  if (isOpen()) std::fill(data().begin(), data().end(), fill);
+}
+
+template <typename Address> void Mapped<Address>::dump(bits::span<quint8> dest) const {
+  if (dest.size() <= 0) throw std::logic_error("dump requires non-0 size");
+  else if (isOpen()) bits::memcpy(dest, bits::span<const quint8>{data()});
+}
+
+template <typename Address> void Mapped<Address>::trace(bool enabled) {
+  if (this->_tb) _tb->trace(_device.id, enabled);
+}
+
+template <typename Address> const quint8 *Mapped<Address>::directRead(Address address, std::size_t length) const {
+  if (!isOpen() || address < _span.lower() || std::size_t(address - _span.lower()) + length > data().size())
+    return nullptr;
+  return _data + (address - _span.lower());
+}
+
+template <typename Address> quint8 *Mapped<Address>::directWrite(Address address, std::size_t length) {
+  if (!isOpen() || address < _span.lower() || std::size_t(address - _span.lower()) + length > data().size())
+    return nullptr;
+  return _data + (address - _span.lower());
+}
+
+template <typename Address>
+bool Mapped<Address>::analyze(api2::trace::PacketIterator iter, api2::trace::Direction direction) {
+  auto header = *iter;
+  if (!std::visit(sim::trace2::IsSameDevice{_device.id}, header)) return false;
+  // Payloads are XOR encoded, so forward and backward are handled identically. See Dense::analyze.
+  else if (std::holds_alternative<api2::packet::header::Write>(header)) {
+    auto hdr = std::get<api2::packet::header::Write>(header);
+    Address address = hdr.address.to_address<Address>();
+    for (auto payload : iter)
+      address += std::visit(detail::PayloadHelper<Address, Mapped<Address>>(address, this), payload);
+  }
+  return true;
+}
+
+template <typename Address>
+api2::memory::Result Mapped<Address>::read(Address address, bits::span<quint8> dest, api2::memory::Operation op) const {
+  using Operation = sim::api2::memory::Operation;
+  checkAccess(address, dest.size());
+  Address offset = address - _span.lower();
+  // Ignore reads from UI and buffer internal operations, as in Dense.
+  if (!(op.type == Operation::Type::Application || op.type == Operation::Type::BufferInternal) && _tb)
+    _tb->emitPureRead<Address>(_device.id, offset, dest.size());
+  bits::memcpy(dest, bits::span<const quint8>{data().subspan(offset)});
+  return {};
+}
+
+template <typename Address>
+api2::memory::Result Mapped<Address>::write(Address address, bits::span<const quint8> src,
+                                            api2::memory::Operation op) {
+  using Operation = sim::api2::memory::Operation;
+  checkAccess(address, src.size());
+  Address offset = address - _span.lower();
+  auto dest = data().subspan(offset);
+  // Record changes, even if the come from UI. Otherwise, step back fails.
+  if (op.type != Operation::Type::BufferInternal && _tb) _tb->emitWrite<Address>(_device.id, offset, src, dest);
+  bits::memcpy(dest, src);
+  return {};
+}
+
+} // namespace sim::memory
@@ -19,7 +19,9 @@
 
 namespace sim::memory {
 template <typename Address>
-class ReadOnly : public api2::memory::Target<Address>, public api2::memory::Initiator<Address> {
+class ReadOnly : public api2::memory::Target<Address>,
+                 public api2::memory::Direct<Address>,
+                 public api2::memory::Initiator<Address> {
 public:
   using AddressSpan = typename api2::memory::AddressSpan<Address>;
   ReadOnly(bool hardFail);
@@ -41,6 +43,10 @@ public:
   void clear(quint8 fill) override;
   void dump(bits::span<quint8> dest) const override;
 
+  // Direct interface. Reads are forwarded to the target, but writes must take the slow path to be discarded.
+  const quint8 *directRead(Address address, std::size_t length) const override;
+  quint8 *directWrite(Address address, std::size_t length) override { return nullptr; }
+
   // Initiator interface
 
   void setTarget(sim::api2::memory::Target<Address> *target, void *port) override;
@@ -81,6 +87,12 @@ api2::memory::Result ReadOnly<Address>::write(Address address, bits::span<const
   return {};
 }
 
+template <typename Address> const quint8 *ReadOnly<Address>::directRead(Address address, std::size_t length) const {
+  if (auto direct = dynamic_cast<const api2::memory::Direct<Address> *>(_target); direct)
+    return direct->directRead(address, length);
+  return nullptr;
+}
+
 template <typename Address> void ReadOnly<Address>::setTarget(sim::api2::memory::Target<Address> *target, void *port) {
   _target = target;
 }
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include "bits/operations/copy.hpp"
+#include "sim/api2.hpp"
+#include "sim/device/dense.hpp"
+#include "sim/trace2/packet_utils.hpp"
+
+namespace sim::memory {
+// Stores Count registers as host integers so that a CPU can access them without virtual calls, bounds checks, or
+// byteswapping. Through the Target interface, the registers appear as a big-endian byte array, where register i
+// occupies bytes [i*sizeof(Word), (i+1)*sizeof(Word)). This matches the layout targets::isa::readRegister expects,
+// so models and trace packets are unaware that the storage is not a Dense<quint8>.
+template <std::unsigned_integral Word, quint8 Count>
+class RegisterFile : public api2::memory::Target<quint8>, public api2::trace::Source, public api2::trace::Sink {
+public:
+  static constexpr quint8 wordSize = sizeof(Word);
+  static_assert(wordSize * Count <= 0x100, "Byte view must be addressable by quint8");
+  static constexpr std::size_t byteCount = wordSize * Count;
+  using AddressSpan = typename api2::memory::AddressSpan<quint8>;
+  explicit RegisterFile(api2::device::Descriptor device);
+  ~RegisterFile() = default;
+  RegisterFile(RegisterFile &&other) noexcept = default;
+  RegisterFile &operator=(RegisterFile &&other) = default;
+  // Disable copy construction and assignment, since it would be incorrect for
+  // multiple objects to share a device descriptor.
+  RegisterFile(const RegisterFile &) = delete;
+  RegisterFile &operator=(const RegisterFile &) = delete;
+
+  // Native interface. Writes which change a value are still traced, but reads never are.
+  // Skipping no-op writes allows ticks that change nothing to be elided from the trace.
+  inline Word get(quint8 index) const { return _words[index]; }
+  inline void set(quint8 index, Word value) {
+    if (_tb && _words[index] != value) emitSet(index, {&value, 1});
+    _words[index] = value;
+  }
+  // Update consecutive registers, producing a single trace packet.
+  void set(quint8 index, bits::span<const Word> values);
+
+  // Target interface
+  sim::api2::device::ID deviceID() const override { return _device.id; }
+  sim::api2::device::Descriptor device() const override { return _device; }
+  AddressSpan span() const override { return AddressSpan(0, quint8(byteCount - 1)); }
+  api2::memory::Result read(quint8 address, bits::span<quint8> dest, api2::memory::Operation op) const override;
+  api2::memory::Result write(quint8 address, bits::span<const quint8> src, api2::memory::Operation op) override;
+  void clear(quint8 fill) override;
+  void dump(bits::span<quint8> dest) const override;
+
+  // Sink interface
+  bool analyze(const api2::trace::PacketIterator iter, api2::trace::Direction) override;
+
+  // Source interface
+  void setBuffer(api2::trace::Buffer *tb) override { _tb = tb; }
+  const api2::trace::Buffer *buffer() const override { return _tb; }
+  void trace(bool enabled) override;
+
+private:
+  inline quint8 byteAt(quint8 offset) const {
+    return quint8(_words[offset / wordSize] >> (8 * (wordSize - 1 - offset % wordSize)));
+  }
+  inline void setByteAt(quint8 offset, quint8 value) {
+    const auto shift = 8 * (wordSize - 1 - offset % wordSize);
+    auto &word = _words[offset / wordSize];
+    word = static_cast<Word>((word & ~(Word(0xFF) << shift)) | (Word(value) << shift));
+  }
+  void checkBounds(quint8 address, std::size_t length) const;
+  void emitSet(quint8 index, bits::span<const Word> values);
+
+  api2::device::Descriptor _device;
+  std::array<Word, Count> _words = {};
+  api2::trace::Buffer *_tb = nullptr;
+};
+
+template <std::unsigned_integral Word, quint8 Count>
+RegisterFile<Word, Count>::RegisterFile(api2::device::Descriptor device) : _device(device) {}
+
+template <std::unsigned_integral Word, quint8 Count>
+void RegisterFile<Word, Count>::set(quint8 index, bits::span<const Word> values) {
+  if (index + values.size() > Count) throw api2::memory::Error(api2::memory::Error::Type::OOBAccess, index * wordSize);
+  if (_tb && !std::equal(values.begin(), values.end(), _words.begin() + index)) emitSet(index, values);
+  for (std::size_t it = 0; it < values.size(); it++) _words[index + it] = values[it];
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+api2::memory::Result RegisterFile<Word, Count>::read(quint8 address, bits::span<quint8> dest,
+                                                     api2::memory::Operation op) const {
+  using Operation = sim::api2::memory::Operation;
+  checkBounds(address, dest.size());
+  // Ignore reads from UI and from buffer internal operations, matching Dense.
+  if (!(op.type == Operation::Type::Application || op.type == Operation::Type::BufferInternal) && _tb)
+    _tb->emitPureRead<quint8>(_device.id, address, dest.size());
+  for (std::size_t it = 0; it < dest.size(); it++) dest[it] = byteAt(address + it);
+  return {};
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+api2::memory::Result RegisterFile<Word, Count>::write(quint8 address, bits::span<const quint8> src,
+                                                      api2::memory::Operation op) {
+  using Operation = sim::api2::memory::Operation;
+  checkBounds(address, src.size());
+  // Record changes, even if the come from UI. Otherwise, step back fails.
+  if (op.type != Operation::Type::BufferInternal && _tb) {
+    std::array<quint8, byteCount> prev;
+    for (std::size_t it = 0; it < src.size(); it++) prev[it] = byteAt(address + it);
+    _tb->emitWrite<quint8>(_device.id, address, src, bits::span<quint8>{prev.data(), src.size()});
+  }
+  for (std::size_t it = 0; it < src.size(); it++) setByteAt(address + it, src[it]);
+  return {};
+}
+
+template <std::unsigned_integral Word, quint8 Count> void RegisterFile<Word, Count>::clear(quint8 fill) {
+  for (std::size_t it = 0; it < byteCount; it++) setByteAt(it, fill);
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+void RegisterFile<Word, Count>::dump(bits::span<quint8> dest) const {
+  if (dest.size() <= 0) throw std::logic_error("dump requires non-0 size");
+  for (std::size_t it = 0; it < std::min(dest.size(), byteCount); it++) dest[it] = byteAt(it);
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+bool RegisterFile<Word, Count>::analyze(api2::trace::PacketIterator iter, api2::trace::Direction) {
+  auto header = *iter;
+  if (!std::visit(sim::trace2::IsSameDevice{_device.id}, header)) return false;
+  // Like Dense, payloads are XOR encoded, so replay is direction-agnostic.
+  else if (std::holds_alternative<api2::packet::header::Write>(header)) {
+    auto hdr = std::get<api2::packet::header::Write>(header);
+    quint8 address = hdr.address.to_address<quint8>();
+    for (auto payload : iter)
+      address += std::visit(detail::PayloadHelper<quint8, RegisterFile>(address, this), payload);
+  }
+  return true;
+}
+
+template <std::unsigned_integral Word, quint8 Count> void RegisterFile<Word, Count>::trace(bool enabled) {
+  if (this->_tb) _tb->trace(_device.id, enabled);
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+void RegisterFile<Word, Count>::checkBounds(quint8 address, std::size_t length) const {
+  using E = api2::memory::Error;
+  if (length > byteCount || address > byteCount - length) throw E(E::Type::OOBAccess, address);
+}
+
+template <std::unsigned_integral Word, quint8 Count>
+void RegisterFile<Word, Count>::emitSet(quint8 index, bits::span<const Word> values) {
+  std::array<quint8, byteCount> next, prev;
+  const quint8 address = index * wordSize, length = values.size() * wordSize;
+  for (quint8 it = 0; it < length; it++) {
+    next[it] = quint8(values[it / wordSize] >> (8 * (wordSize - 1 - it % wordSize)));
+    prev[it] = byteAt(address + it);
+  }
+  _tb->emitWrite<quint8>(_device.id, address, bits::span<const quint8>{next.data(), length},
+                         bits::span<quint8>{prev.data(), length});
+}
+
+} // namespace sim::memory
@@ -21,6 +21,7 @@
 namespace sim::memory {
 template <typename Address>
 class SimpleBus : public api2::memory::Target<Address>,
+                  public api2::memory::Direct<Address>,
                   public api2::memory::Translator<Address>,
                   public sim::api2::trace::Source {
 public:
@@ -43,6 +44,10 @@ public:
   void clear(quint8 fill) override;
   void dump(bits::span<quint8> dest) const override;
 
+  // Direct interface. Only succeeds if the whole range is mapped to a single Direct device.
+  const quint8 *directRead(Address address, std::size_t length) const override;
+  quint8 *directWrite(Address address, std::size_t length) override;
+
   // Translator interface
   std::tuple<bool, sim::api2::device::ID, Address> forward(Address address) const override;
   std::optional<Address> backward(sim::api2::device::ID child, Address address) const override;
@@ -60,6 +65,32 @@ public:
   void pushFrontTarget(AddressSpan at, api2::memory::Target<Address> *target);
   api2::memory::Target<Address> *deviceAt(Address address);
   void removeAllTargets();
+  // Called with the affected bus addresses after every write or clear, regardless of the initiator.
+  // Allows initiators that cache memory contents (e.g., decoded instructions) to remain coherent.
+  using WriteObserver = std::function<void(Address address, std::size_t length)>;
+  void setWriteObserver(WriteObserver observer);
+  // Must be called after writing through a pointer from directWrite, since the observer cannot see those writes.
+  void notifyWrite(Address address, std::size_t length) {
+    markDirty(address, length);
+    if (_observer) _observer(address, length);
+  }
+  // Every write and clear marks the pages it touched as dirty, so that views which poll memory (e.g., the hex dump) do
+  // work proportional to the number of pages touched since they last looked, rather than the number of writes.
+  static constexpr quint8 dirtyPageBits = 6;
+  static constexpr std::size_t dirtyPageSize = std::size_t(1) << dirtyPageBits;
+  inline void markDirty(Address address, std::size_t length) {
+    if (length == 0 || address < _span.lower()) return;
+    std::size_t first = std::size_t(address - _span.lower()) >> dirtyPageBits;
+    std::size_t last = std::min((std::size_t(address - _span.lower()) + length - 1) >> dirtyPageBits, _dirtyPages - 1);
+    for (auto page = first; page <= last; page++) _dirty[page / 64] |= quint64(1) << (page % 64);
+  }
+  // Returns maximal runs of dirty pages as bus addresses, and then marks every page as clean.
+  std::vector<AddressSpan> takeDirty();
+  // Incremented whenever the mapping changes, which invalidates all pointers returned by directRead/directWrite.
+  quint32 generation() const { return _generation; }
+  // Invalidate pointers from directRead/directWrite without changing the mapping, e.g., after a device's storage has
+  // been replaced.
+  void invalidateDirect() { _generation++; }
 
 private:
   const api2::memory::Target<Address> *device(sim::api2::device::ID id) const {
@@ -72,6 +103,9 @@ private:
     if (it == _devices.end() || it->first != id) return nullptr;
     return it->second;
   }
+  // Returns the Direct device backing [address, address+length), and the device address of the first byte.
+  std::optional<std::pair<api2::memory::Direct<Address> *, Address>> resolveDirect(Address address,
+                                                                                   std::size_t length) const;
   using TargetPair = std::pair<sim::api2::device::ID, api2::memory::Target<Address> *>;
   struct LBID {
     inline bool operator()(const TargetPair &V, const quint16 find) const { return V.first < find; }
@@ -82,6 +116,10 @@ private:
   sim::trace2::AddressBiMap<Address, quint16> _addrs;
   QVector<TargetPair> _devices;
   QSharedPointer<sim::api2::Paths> _paths = nullptr;
+  WriteObserver _observer = nullptr;
+  quint32 _generation = 0;
+  std::size_t _dirtyPages = 0;
+  std::vector<quint64> _dirty = {};
   mutable api2::trace::Buffer *_tb = nullptr;
   api2::trace::PathGuard makeGuard() const {
     if (!_tb || !_paths) return api2::trace::PathGuard(nullptr, -1);
@@ -91,7 +129,9 @@ private:
 };
 
 template <typename Address>
-SimpleBus<Address>::SimpleBus(api2::device::Descriptor device, AddressSpan span) : _span(span), _device(device) {}
+SimpleBus<Address>::SimpleBus(api2::device::Descriptor device, AddressSpan span)
+    : _span(span), _device(device), _dirtyPages((size_inclusive(span) + dirtyPageSize - 1) >> dirtyPageBits),
+      _dirty((_dirtyPages + 63) / 64, 0) {}
 
 template <typename Address> typename SimpleBus<Address>::AddressSpan SimpleBus<Address>::span() const { return _span; }
 
@@ -156,11 +196,67 @@ api2::memory::Result SimpleBus<Address>::write(Address address, bits::span<const
     offset += usableLength;
     length -= usableLength;
   }
+  notifyWrite(address, src.size());
   return {};
 }
 
+template <typename Address>
+const quint8 *SimpleBus<Address>::directRead(Address address, std::size_t length) const {
+  if (auto resolved = resolveDirect(address, length); resolved)
+    return resolved->first->directRead(resolved->second, length);
+  return nullptr;
+}
+
+template <typename Address> quint8 *SimpleBus<Address>::directWrite(Address address, std::size_t length) {
+  if (auto resolved = resolveDirect(address, length); resolved)
+    return resolved->first->directWrite(resolved->second, length);
+  return nullptr;
+}
+
+template <typename Address>
+std::optional<std::pair<api2::memory::Direct<Address> *, Address>>
+SimpleBus<Address>::resolveDirect(Address address, std::size_t length) const {
+  using sim::api2::memory::convert;
+  if (length == 0) return std::nullopt;
+  auto region = _addrs.region_at(address);
+  // Ranges which straddle devices must be split by the bus.
+  if (!region || std::size_t(address) + length - 1 > region->from.upper()) return std::nullopt;
+  auto it = std::lower_bound(_devices.cbegin(), _devices.cend(), region->device, LBID{});
+  if (it == _devices.cend() || it->first != region->device) return std::nullopt;
+  // MMIO devices have side effects, so they do not implement Direct.
+  auto direct = dynamic_cast<api2::memory::Direct<Address> *>(it->second);
+  if (!direct) return std::nullopt;
+  return std::make_pair(direct, convert<Address>(address, region->from, region->to));
+}
+
 template <typename Address> void SimpleBus<Address>::clear(quint8 fill) {
   for (auto dev : _devices) dev.second->clear(fill);
+  notifyWrite(_span.lower(), size_inclusive(_span));
+}
+
+template <typename Address> std::vector<typename SimpleBus<Address>::AddressSpan> SimpleBus<Address>::takeDirty() {
+  std::vector<AddressSpan> ret;
+  auto append = [&](std::size_t first, std::size_t end) {
+    std::size_t lower = std::size_t(_span.lower()) + (first << dirtyPageBits);
+    std::size_t upper = std::min<std::size_t>(_span.upper(), lower + ((end - first) << dirtyPageBits) - 1);
+    ret.emplace_back(Address(lower), Address(upper));
+  };
+  std::optional<std::size_t> runStart = std::nullopt;
+  for (std::size_t word = 0; word < _dirty.size(); word++) {
+    // Clean words only matter if they end a run, so most of the bitmap is skipped a word at a time.
+    if (_dirty[word] == 0) {
+      if (runStart) append(*runStart, word * 64), runStart = std::nullopt;
+      continue;
+    }
+    for (std::size_t bit = 0; bit < 64; bit++) {
+      bool dirty = (_dirty[word] >> bit) & 1;
+      if (dirty && !runStart) runStart = word * 64 + bit;
+      else if (!dirty && runStart) append(*runStart, word * 64 + bit), runStart = std::nullopt;
+    }
+    _dirty[word] = 0;
+  }
+  if (runStart) append(*runStart, _dirtyPages);
+  return ret;
 }
 
 template <typename Address> void SimpleBus<Address>::dump(bits::span<quint8> dest) const {
@@ -188,6 +284,7 @@ void SimpleBus<Address>::pushFrontTarget(AddressSpan at, api2::memory::Target<Ad
   _addrs.insert_or_overwrite(from, to, target->deviceID(), 0);
   _devices.push_back({target->deviceID(), target});
   std::sort(_devices.begin(), _devices.end(), detail::SortOnDeviceID<Address>{});
+  _generation++;
 }
 
 template <typename Address> sim::api2::memory::Target<Address> *SimpleBus<Address>::deviceAt(Address address) {
@@ -199,6 +296,11 @@ template <typename Address> sim::api2::memory::Target<Address> *SimpleBus<Addres
 template <typename Address> void SimpleBus<Address>::removeAllTargets() {
   _addrs.clear();
   _devices.clear();
+  _generation++;
+}
+
+template <typename Address> void SimpleBus<Address>::setWriteObserver(WriteObserver observer) {
+  _observer = observer;
 }
 
 template <typename Address>
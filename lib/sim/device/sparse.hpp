@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+#include <unordered_map>
+#include "bits/operations/copy.hpp"
+#include "dense.hpp"
+#include "sim/api2.hpp"
+#include "sim/trace2/packet_utils.hpp"
+
+namespace sim::memory {
+// Like Dense, except that storage is allocated a page at a time on the first write to that page.
+// Pages which have never been written read as the fill value. Intended for large address spaces which are mostly
+// untouched (e.g., disks), where eagerly allocating the whole span would dominate a system's memory usage.
+template <typename Address>
+class Sparse : public api2::memory::Target<Address>, public api2::trace::Source, public api2::trace::Sink {
+public:
+  static constexpr quint8 pageBits = 12;
+  static constexpr std::size_t pageSize = std::size_t(1) << pageBits;
+  using AddressSpan = typename api2::memory::AddressSpan<Address>;
+  Sparse(api2::device::Descriptor device, AddressSpan span, quint8 defaultValue = 0);
+  ~Sparse() = default;
+  Sparse(Sparse &&other) noexcept = default;
+  Sparse &operator=(Sparse &&other) = default;
+  // Disable copy construction and assignment, since it would be incorrect for
+  // multiple objects to share a device descriptor.
+  Sparse(const Sparse &) = delete;
+  Sparse &operator=(const Sparse &) = delete;
+
+  // API v2
+  // Target interface
+  sim::api2::device::ID deviceID() const override { return _device.id; }
+  sim::api2::device::Descriptor device() const override { return _device; }
+  AddressSpan span() const override;
+  api2::memory::Result read(Address address, bits::span<quint8> dest, api2::memory::Operation op) const override;
+  api2::memory::Result write(Address address, bits::span<const quint8> src, api2::memory::Operation op) override;
+  // Releases all pages, so it is O(allocated pages) rather than O(span).
+  void clear(quint8 fill) override;
+  void dump(bits::span<quint8> dest) const override;
+
+  // Sink interface
+  bool analyze(const api2::trace::PacketIterator iter, api2::trace::Direction) override;
+
+  // Source interface
+  void setBuffer(api2::trace::Buffer *tb) override;
+  const api2::trace::Buffer *buffer() const override { return _tb; }
+  void trace(bool enabled) override;
+
+  // Helpers
+  // Number of pages which have been allocated since construction or the last clear.
+  std::size_t allocatedPages() const { return _pages.size(); }
+  void setDevice(api2::device::Descriptor device) { _device = device; }
+  void setSpan(AddressSpan span) {
+    _span = span;
+    // Ensure no data leaks between configurations.
+    _pages.clear();
+  }
+
+private:
+  using Page = std::array<quint8, pageSize>;
+  quint8 _fill;
+  AddressSpan _span;
+  api2::device::Descriptor _device;
+  // Keyed by page number, relative to the start of the span.
+  std::unordered_map<std::size_t, std::unique_ptr<Page>> _pages;
+  api2::trace::Buffer *_tb = nullptr;
+  // Returns nullptr if the page has not been allocated.
+  const Page *page(std::size_t index) const;
+  Page *allocate(std::size_t index);
+  // Copy between storage and a buffer, page by page. Offsets are relative to the start of the span.
+  void copyOut(std::size_t offset, bits::span<quint8> dest) const;
+  void copyIn(std::size_t offset, bits::span<const quint8> src);
+  void checkBounds(Address address, std::size_t length) const;
+};
+
+template <typename Address>
+sim::memory::Sparse<Address>::Sparse(api2::device::Descriptor device, AddressSpan span, quint8 fill)
+    : _fill(fill), _span(span), _device(device) {}
+
+template <typename Address>
+typename sim::memory::Sparse<Address>::AddressSpan sim::memory::Sparse<Address>::span() const {
+  return _span;
+}
+
+template <typename Address> void Sparse<Address>::clear(quint8 fill) {
+  _fill = fill;
+  _pages.clear();
+}
+
+template <typename Address> void Sparse<Address>::dump(bits::span<quint8> dest) const {
+  if (dest.size() <= 0) throw std::logic_error("dump requires non-0 size");
+  auto length = std::min<std::size_t>(dest.size(), size_inclusive(_span));
+  copyOut(0, dest.first(length));
+}
+
+template <typename Address> void Sparse<Address>::trace(bool enabled) {
+  if (this->_tb) _tb->trace(_device.id, enabled);
+}
+
+template <typename Address> const typename Sparse<Address>::Page *Sparse<Address>::page(std::size_t index) const {
+  if (auto it = _pages.find(index); it != _pages.end()) return &*it->second;
+  return nullptr;
+}
+
+template <typename Address> typename Sparse<Address>::Page *Sparse<Address>::allocate(std::size_t index) {
+  auto &page = _pages[index];
+  if (!page) {
+    page = std::make_unique<Page>();
+    page->fill(_fill);
+  }
+  return &*page;
+}
+
+template <typename Address> void Sparse<Address>::copyOut(std::size_t offset, bits::span<quint8> dest) const {
+  while (!dest.empty()) {
+    auto inPage = offset & (pageSize - 1), length = std::min(dest.size(), pageSize - inPage);
+    if (auto p = page(offset >> pageBits); p)
+      bits::memcpy(dest.first(length), bits::span<const quint8>{*p}.subspan(inPage));
+    else std::fill_n(dest.begin(), length, _fill);
+    dest = dest.subspan(length), offset += length;
+  }
+}
+
+template <typename Address> void Sparse<Address>::copyIn(std::size_t offset, bits::span<const quint8> src) {
+  while (!src.empty()) {
+    auto inPage = offset & (pageSize - 1), length = std::min(src.size(), pageSize - inPage);
+    bits::memcpy(bits::span<quint8>{*allocate(offset >> pageBits)}.subspan(inPage, length), src.first(length));
+    src = src.subspan(length), offset += length;
+  }
+}
+
+template <typename Address> void Sparse<Address>::checkBounds(Address address, std::size_t length) const {
+  using E = api2::memory::Error;
+  // Length is 1-indexed, address are 0, so must offset by -1.
+  auto maxAddr = (address + std::max<Address>(0, length - 1));
+  if (address < _span.lower() || maxAddr > _span.upper()) throw E(E::Type::OOBAccess, address);
+}
+
+template <typename Address>
+bool Sparse<Address>::analyze(api2::trace::PacketIterator iter, api2::trace::Direction direction) {
+  auto header = *iter;
+  if (!std::visit(sim::trace2::IsSameDevice{_device.id}, header)) return false;
+  // Payloads are XOR encoded, so forward and backward are handled identically. See Dense::analyze.
+  else if (std::holds_alternative<api2::packet::header::Write>(header)) {
+    auto hdr = std::get<api2::packet::header::Write>(header);
+    Address address = hdr.address.to_address<Address>();
+    for (auto payload : iter)
+      address += std::visit(detail::PayloadHelper<Address, Sparse<Address>>(address, this), payload);
+  }
+  return true;
+}
+
+template <typename Address> void Sparse<Address>::setBuffer(api2::trace::Buffer *tb) { _tb = tb; }
+
+template <typename Address>
+api2::memory::Result Sparse<Address>::read(Address address, bits::span<quint8> dest, api2::memory::Operation op) const {
+  using Operation = sim::api2::memory::Operation;
+  checkBounds(address, dest.size());
+  Address offset = address - _span.lower();
+  // Ignore reads from UI and buffer internal operations, as in Dense.
+  if (!(op.type == Operation::Type::Application || op.type == Operation::Type::BufferInternal) && _tb)
+    _tb->emitPureRead<Address>(_device.id, offset, dest.size());
+  copyOut(offset, dest);
+  return {};
+}
+
+template <typename Address>
+api2::memory::Result Sparse<Address>::write(Address address, bits::span<const quint8> src,
+                                            api2::memory::Operation op) {
+  using Operation = sim::api2::memory::Operation;
+  checkBounds(address, src.size());
+  Address offset = address - _span.lower();
+  // Record changes, even if the come from UI. Otherwise, step back fails.
+  if (op.type != Operation::Type::BufferInternal && _tb && _tb->traced(_device.id)) {
+    // Write packets XOR the new bytes with the old, which may span several pages (or none at all).
+    QVarLengthArray<quint8, 256> old(src.size());
+    copyOut(offset, {old.data(), std::size_t(old.size())});
+    _tb->emitWrite<Address>(_device.id, offset, src, {old.data(), std::size_t(old.size())});
+  }
+  copyIn(offset, src);
+  return {};
+}
+
+} // namespace sim::memory
@@ -4,7 +4,7 @@
 
 using Fragment = sim::api2::trace::Fragment;
 
-sim::trace2::InfiniteBuffer::InfiniteBuffer() : _in(_data), _out(_data), _backlinks(256) {}
+sim::trace2::InfiniteBuffer::InfiniteBuffer() : _in(_data), _out(_data) {}
 
 bool sim::trace2::InfiniteBuffer::trace(sim::api2::device::ID deviceID, bool enabled) {
   if (enabled) _sinks.insert(deviceID);
@@ -15,43 +15,91 @@ bool sim::trace2::InfiniteBuffer::trace(sim::api2::device::ID deviceID, bool ena
 bool sim::trace2::InfiniteBuffer::traced(quint16 deviceID) const { return _sinks.contains(deviceID); }
 
 bool sim::trace2::InfiniteBuffer::writeFragment(const sim::api2::trace::Fragment &fragment) {
+  // Materialize a deferred frame header before its first packet.
+  if (_pendingTicks != 0 && !is_frame_header(fragment)) {
+    auto ticks = std::exchange(_pendingTicks, 0);
+    writeFragment(Fragment{api2::frame::header::Trace{.tick_delta = ticks}});
+  }
+
   if (auto hdr = std::visit(sim::trace2::AsFrameHeader{}, fragment); hdr.index() != 0) {
+    // Fold ticks which did not produce a frame into this frame.
+    if (_pendingTicks != 0) {
+      auto ticks = std::visit(sim::trace2::GetFrameTickDelta{}, hdr) + std::exchange(_pendingTicks, 0);
+      std::visit(sim::trace2::UpdateFrameTickDelta{ticks, hdr}, hdr);
+    }
+
     // Both will point to same position when header is first element to be serialized.
-    if (_lastFrameStart != _out.position()) updateFrameHeader();
+    if (_lastFrameStart != end()) updateFrameHeader();
 
     // Zero out length field of header, and set back_offset.
     std::visit(sim::trace2::UpdateFrameLength{0, hdr}, hdr);
-    quint16 back_offset = _out.position() - _lastFrameStart;
+    quint16 back_offset = end() - _lastFrameStart;
     std::visit(sim::trace2::UpdateFrameBackOffset{back_offset, hdr}, hdr);
 
     // Save current offset to enable updateFrameHeader() to overwrite length in the future.
-    _lastFrameStart = _out.position();
+    _lastFrameStart = end();
+    _ticks += std::visit(sim::trace2::GetFrameTickDelta{}, hdr);
+    if (_index.empty() || ++_framesSinceIndex == indexStride) {
+      _index.push_back({.loc = _lastFrameStart, .ticks = _ticks});
+      _framesSinceIndex = 0;
+    }
     _out(as_fragment(hdr)).or_throw();
   } else _out(Fragment(fragment)).or_throw();
   return true;
 }
 
+void sim::trace2::InfiniteBuffer::emitLazyFrameStart() { _pendingTicks++; }
+
+quint32 sim::trace2::InfiniteBuffer::pendingTicks() const { return _pendingTicks; }
+
+quint64 sim::trace2::InfiniteBuffer::ticks() const { return _ticks; }
+
+std::size_t sim::trace2::InfiniteBuffer::decodes() const { return _decodes; }
+
+sim::trace2::InfiniteBuffer::FrameIterator sim::trace2::InfiniteBuffer::seek(quint64 tick) const {
+  // Find the last indexed frame which does not include tick. The oldest retained frame is always indexed.
+  auto it = std::upper_bound(_index.cbegin(), _index.cend(), tick,
+                             [](quint64 tick, const IndexEntry &entry) { return tick < entry.ticks; });
+  if (it == _index.cbegin()) return cbegin();
+  auto [loc, ticks] = *std::prev(it);
+  while (ticks <= tick) {
+    loc = next(loc, api2::trace::Level::Frame);
+    if (loc == end()) return cend();
+    ticks += tickDelta(loc);
+  }
+  return FrameIterator(this, loc);
+}
+
+quint32 sim::trace2::InfiniteBuffer::tickDelta(std::size_t loc) const {
+  return std::visit(sim::trace2::GetFrameTickDelta{}, frame(loc));
+}
+
 bool sim::trace2::InfiniteBuffer::updateFrameHeader() {
   namespace fh = api2::frame::header;
   using Header = api2::frame::Header;
+  // There is no frame to update, which happens if every tick so far was empty.
+  if (_lastFrameStart == end()) return false;
   auto curOutPos = _out.position();
   auto curInPos = _in.position();
 
   // Read in previous frame header and update its length flag
   Fragment w;
-  _in.reset(_lastFrameStart);
+  _in.reset(_lastFrameStart - _base);
   _in(w).or_throw();
   _in.reset(curInPos);
 
   if (auto hdr = std::visit(sim::trace2::AsFrameHeader{}, w); hdr.index() != 0) {
     // TODO: Ensure that length fits in 16 bits.
-    quint32 length = curOutPos - _lastFrameStart;
+    quint32 length = end() - _lastFrameStart;
     std::visit(sim::trace2::UpdateFrameLength{static_cast<quint16>(length), hdr}, hdr);
 
     // Overwrite existing frame header to update "length" field.
-    _out.reset(_lastFrameStart);
+    _out.reset(_lastFrameStart - _base);
     _out(std::visit(sim::trace2::AsFragment{}, hdr)).or_throw();
     _out.reset(curOutPos);
+    // The decoded header's length is now stale.
+    if (_cursor.frame == _lastFrameStart) _cursor = {};
+    if (_header.loc == _lastFrameStart) _header = {.loc = std::size_t(-1)};
   } else return false;
 
   return true;
@@ -63,17 +111,55 @@ void sim::trace2::InfiniteBuffer::clear() {
   sim::api2::trace::Buffer::clear();
   _out.reset();
   _in.reset();
-  _lastFrameStart = 0;
+  _lastFrameStart = _base = 0;
+  _pendingTicks = 0;
   _data.resize(0);
-  _backlinks.clear();
+  _index.clear();
+  _ticks = _framesSinceIndex = 0;
+  _cursor = {};
+  _header = _single = {.loc = std::size_t(-1)};
+  _decodes = 0;
+}
+
+bool sim::trace2::InfiniteBuffer::evicted(std::size_t loc) const {
+  // -1 is the reverse end sentinel.
+  return loc == std::size_t(-1) ? _base != 0 : loc < _base;
+}
+
+void sim::trace2::InfiniteBuffer::evict(std::size_t loc) {
+  if (loc <= _base) return;
+  else if (loc > _lastFrameStart) throw std::logic_error("Cannot evict the current frame");
+  // Count the ticks up to loc, so that the new oldest frame can be indexed.
+  auto it = std::upper_bound(_index.cbegin(), _index.cend(), loc,
+                             [](std::size_t loc, const IndexEntry &entry) { return loc < entry.loc; });
+  auto [indexed, ticks] = *std::prev(it);
+  while (indexed != loc) {
+    indexed = next(indexed, api2::trace::Level::Frame);
+    ticks += tickDelta(indexed);
+  }
+  while (!_index.empty() && _index.front().loc <= loc) _index.pop_front();
+  _index.push_front({.loc = loc, .ticks = ticks});
+
+  auto count = loc - _base;
+  _data.erase(_data.begin(), _data.begin() + count);
+  _out.reset(_out.position() - count);
+  _in.reset(0);
+  _base = loc;
+  _cursor = {};
+  _header = _single = {.loc = std::size_t(-1)};
+}
+
+std::size_t sim::trace2::InfiniteBuffer::offset(std::size_t loc) const {
+  if (loc < _base) throw std::logic_error("Trace location has been evicted");
+  return loc - _base;
 }
 
 sim::trace2::InfiniteBuffer::FrameIterator sim::trace2::InfiniteBuffer::cbegin() const {
-  return FrameIterator(this, 0);
+  return FrameIterator(this, _base);
 }
 
 sim::trace2::InfiniteBuffer::FrameIterator sim::trace2::InfiniteBuffer::cend() const {
-  return FrameIterator(this, _out.position());
+  return FrameIterator(this, end());
 }
 
 sim::trace2::InfiniteBuffer::FrameIterator sim::trace2::InfiniteBuffer::crbegin() const {
@@ -86,143 +172,181 @@ sim::trace2::InfiniteBuffer::FrameIterator sim::trace2::InfiniteBuffer::crend()
 }
 
 std::size_t sim::trace2::InfiniteBuffer::size_at(std::size_t loc, api2::trace::Level level) const {
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  in.reset(loc);
-
-  Fragment w;
-  in(w).or_throw();
-
-  return in.position() - loc;
+  const auto &decoded = decode(loc);
+  return decoded.end - decoded.loc;
 }
 
-sim::api2::trace::Level sim::trace2::InfiniteBuffer::at(std::size_t loc) const {
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  in.reset(loc);
-
-  Fragment w;
-  in(w).or_throw();
-
-  if (std::visit(sim::trace2::IsFrameHeader{}, w)) return api2::trace::Level::Frame;
-  else if (std::visit(sim::trace2::IsPacketHeader{}, w)) return api2::trace::Level::Packet;
-  else return api2::trace::Level::Payload;
-}
+sim::api2::trace::Level sim::trace2::InfiniteBuffer::at(std::size_t loc) const { return decode(loc).level; }
 
 sim::api2::frame::Header sim::trace2::InfiniteBuffer::frame(std::size_t loc) const {
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  in.reset(loc);
-
-  Fragment w;
-  in(w).or_throw();
-  return std::visit(sim::trace2::AsFrameHeader{}, w);
+  return std::visit(sim::trace2::AsFrameHeader{}, decode(loc).fragment);
 }
 
 sim::api2::packet::Header sim::trace2::InfiniteBuffer::packet(std::size_t loc) const {
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  in.reset(loc);
-
-  Fragment w;
-  in(w).or_throw();
-  return std::visit(sim::trace2::AsPacketHeader{}, w);
+  return std::visit(sim::trace2::AsPacketHeader{}, decode(loc).fragment);
 }
 
 sim::api2::packet::Payload sim::trace2::InfiniteBuffer::payload(std::size_t loc) const {
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  in.reset(loc);
-
-  Fragment w;
-  in(w).or_throw();
-  return std::visit(sim::trace2::AsPacketPayload{}, w);
+  return std::visit(sim::trace2::AsPacketPayload{}, decode(loc).fragment);
 }
 
-std::size_t sim::trace2::InfiniteBuffer::next(std::size_t loc, api2::trace::Level level, bool allow_jumps) const {
+std::size_t sim::trace2::InfiniteBuffer::end() const { return _base + _out.position(); }
+
+std::size_t sim::trace2::InfiniteBuffer::next(std::size_t loc, api2::trace::Level level) const {
   using api2::trace::Level;
   using namespace api2::trace;
   // Prevents following condition from deref'ing an invalid iterator.
-  if (loc == _out.position()) return loc;
+  if (loc == end()) return loc;
+  // Iterators which point to discarded fragments resume from the oldest remaining frame.
+  else if (loc < _base) return _base;
   // If we are at a frame and want to go to the next frame, use the length (if not 0).
-  else if (allow_jumps && level == Level::Frame && at(loc) == Level::Frame) {
+  else if (level == Level::Frame && at(loc) == Level::Frame) {
     auto value = frame(loc);
     auto length = std::visit(trace2::GetFrameLength(), value);
     // May be 0 if this is last frame in trace.
     if (length > 0) return loc + length;
   }
 
-  // Track last visited item to enable caching.
-  auto prev = loc;
+  for (loc = decode(loc).end; loc != end(); loc = decode(loc).end)
+    if (decode(loc).level <= level) return loc;
+  return loc;
+}
 
-  typename std::remove_const<decltype(_in)>::type in(_data);
-  loc += size_at(loc, level);
-  in.reset(loc);
+std::size_t sim::trace2::InfiniteBuffer::prev(std::size_t loc, api2::trace::Level level) const {
+  using api2::trace::Level;
 
-  Fragment w;
-  while (true) {
-    if (loc == _out.position()) return loc;
-    loc = in.position();
-    auto ret = in(w);
-    if (ret.code == std::errc::result_out_of_range) return 0;
-    else if (ret.code != std::errc{}) throw std::logic_error("Unhandled");
-    // Prevent "going up" to the next level of trace by returning 0.
-    _backlinks.insert(loc, prev);
-    switch (level) {
-    case api2::trace::Level::Frame:
-      if (is_frame_header(w)) return loc;
-      break;
-    case api2::trace::Level::Packet:
-      if (is_frame_header(w) || is_packet_header(w)) return loc;
-      break;
-    case api2::trace::Level::Payload: return loc;
-    }
-    prev = loc;
-    loc = in.position();
+  // When iterating forward, we can use end() as an invalid end sentinel.
+  // If we are already at the oldest fragment, then we are at the beginning of the trace,
+  // so we should return our end sentinel, arbitrarily chosen to be -1.
+  if (loc <= _base) return -1;
+  // If we are at the end of the trace, the previous frame is the last-known frame.
+  else if (loc == end() && level == Level::Frame) return _lastFrameStart;
+  // If we are at a frame and want to go to the previous frame, use the back_offset.
+  else if (loc != end() && level == Level::Frame && at(loc) == Level::Frame) {
+    sim::api2::frame::Header value = frame(loc);
+    auto offset = std::visit(trace2::GetFrameBackOffset(), value);
+    return loc - offset;
   }
-}
 
-std::size_t sim::trace2::InfiniteBuffer::last_before(std::size_t start, std::size_t end,
-                                                     api2::trace::Level level) const {
-  auto loc = start, prev = start;
-  while (loc < end) {
-    prev = loc;
-    loc = next(loc, level, false);
+  // The previous fragment is either in the same frame, or is the last fragment of the preceding frame.
+  std::size_t frameLoc = _lastFrameStart;
+  if (loc != end() && at(loc) == Level::Frame) frameLoc = loc - std::visit(trace2::GetFrameBackOffset(), frame(loc));
+  else if (loc != end()) frameLoc = containingFrame(loc);
+  const auto &fragments = decodeFrame(frameLoc).fragments;
+  auto it = std::lower_bound(fragments.cbegin(), fragments.cend(), loc,
+                             [](const DecodedFragment &fragment, std::size_t loc) { return fragment.loc < loc; });
+  // The frame header is at or above every level, so this always terminates within the frame.
+  while (it != fragments.cbegin()) {
+    --it;
+    if (it->level <= level) return it->loc;
   }
-  return prev;
+  throw std::logic_error("Frame does not start with a frame header");
 }
 
-std::size_t sim::trace2::InfiniteBuffer::end() const { return _out.position(); }
+std::size_t sim::trace2::InfiniteBuffer::containingFrame(std::size_t loc) const {
+  if (_cursor.find(loc)) return _cursor.frame;
+  // Frame headers only link to adjacent frames, so find the following frame and step back.
+  auto following = next(loc, api2::trace::Level::Frame);
+  if (following == end()) return _lastFrameStart;
+  return following - std::visit(trace2::GetFrameBackOffset(), frame(following));
+}
 
-std::size_t sim::trace2::InfiniteBuffer::next(std::size_t loc, api2::trace::Level level) const {
-  return next(loc, level, true);
+const sim::trace2::InfiniteBuffer::FrameCursor &sim::trace2::InfiniteBuffer::decodeFrame(std::size_t frame) const {
+  // The newest frame may have grown since it was decoded.
+  if (_cursor.frame == frame && (frame != _lastFrameStart || _cursor.end == end())) return _cursor;
+  _cursor.frame = frame;
+  _cursor.fragments.clear();
+  typename std::remove_const<decltype(_in)>::type in(_data);
+  in.reset(offset(frame));
+  DecodedFragment decoded;
+  for (decoded.loc = frame; decoded.loc != end(); decoded.loc = decoded.end) {
+    in(decoded.fragment).or_throw();
+    _decodes++;
+    if (decoded.loc != frame && is_frame_header(decoded.fragment)) break;
+    decoded.end = _base + in.position();
+    if (is_frame_header(decoded.fragment)) decoded.level = api2::trace::Level::Frame;
+    else if (is_packet_header(decoded.fragment)) decoded.level = api2::trace::Level::Packet;
+    else decoded.level = api2::trace::Level::Payload;
+    _cursor.fragments.emplace_back(decoded);
+    _cursor.end = decoded.end;
+  }
+  return _cursor;
 }
 
-std::size_t sim::trace2::InfiniteBuffer::prev(std::size_t loc, api2::trace::Level level) const {
-  using api2::trace::Level;
+const sim::trace2::InfiniteBuffer::DecodedFragment *
+sim::trace2::InfiniteBuffer::FrameCursor::find(std::size_t loc) const {
+  if (frame == std::size_t(-1) || loc < frame || loc >= end) return nullptr;
+  auto it = std::lower_bound(fragments.cbegin(), fragments.cend(), loc,
+                             [](const DecodedFragment &fragment, std::size_t loc) { return fragment.loc < loc; });
+  return it != fragments.cend() && it->loc == loc ? &*it : nullptr;
+}
 
-  // When iterating forward, we can use_out.position as an invalid end sentinel.
-  // If we are already at 0, then we are at the beginning of the trace,
-  // so we should return our end sentinel, arbitrarily chosen to be -1.
-  if (loc == 0) return -1;
-  // If we are at the end of the trace, iterate forward from that last-known frame.
-  else if (loc == _out.position()) return last_before(_lastFrameStart, loc, level);
-  // If we are at a frame and want to go to the previous frame, use the back_offset.
-  else if (level == Level::Frame && at(loc) == Level::Frame) {
-    sim::api2::frame::Header value = frame(loc);
-    auto offset = std::visit(trace2::GetFrameBackOffset(), value);
-    return loc - offset;
+const sim::trace2::InfiniteBuffer::DecodedFragment &sim::trace2::InfiniteBuffer::decode(std::size_t loc) const {
+  // Fragments appended to the newest frame since it was decoded are picked up by decoding the frame again.
+  if (_cursor.frame == _lastFrameStart && _cursor.end <= loc && loc < end()) decodeFrame(_lastFrameStart);
+  if (auto decoded = _cursor.find(loc)) return *decoded;
+  else if (_header.loc == loc) return _header;
+  else if (_single.loc == loc) return _single;
+  // Stepping from a frame header into its frame, so decode the whole frame in anticipation of walking it.
+  // Walks which only visit frame headers (e.g., seek) never pay for decoding the frames' contents.
+  else if (_header.loc < loc && _header.loc != std::size_t(-1)) {
+    auto length = std::visit(trace2::GetFrameLength(), std::visit(trace2::AsFrameHeader{}, _header.fragment));
+    // The newest frame's length is 0 until the next frame starts.
+    if (length == 0 ? _header.loc == _lastFrameStart : loc < _header.loc + length)
+      if (auto decoded = decodeFrame(_header.loc).find(loc)) return *decoded;
   }
 
-  while (true) {
-    // If the item isn't in the cache, find the next frame and jump backwards
-    // to our frame header. Walk from the header to the previous fragment,
-    // filling in the cache as we go.
-    if (_backlinks.contains(loc)) loc = _backlinks[loc];
-    else if (loc == 0) return loc;
-    else {
-      auto next_frame = next(loc, Level::Frame, true);
-      auto prev_frame = prev(next_frame, Level::Frame);
-      // calls next(... , ..., false) repeatedly until we reach loc.
-      loc = last_before(prev_frame, loc, Level::Payload);
-    }
-    auto at_level = at(loc);
-    // We found our target if the packet current fragment is at or above or target level of abstraction.
-    if ((int)at_level <= (int)level) return loc;
+  typename std::remove_const<decltype(_in)>::type in(_data);
+  in.reset(offset(loc));
+  Fragment w;
+  in(w).or_throw();
+  _decodes++;
+  auto &decoded = is_frame_header(w) ? _header : _single;
+  decoded.loc = loc;
+  decoded.end = _base + in.position();
+  if (is_frame_header(w)) decoded.level = api2::trace::Level::Frame;
+  else if (is_packet_header(w)) decoded.level = api2::trace::Level::Packet;
+  else decoded.level = api2::trace::Level::Payload;
+  decoded.fragment = w;
+  return decoded;
+}
+
+sim::trace2::BoundedBuffer::BoundedBuffer(Budget budget) : InfiniteBuffer(), _budget(budget) {}
+
+sim::trace2::BoundedBuffer::Budget sim::trace2::BoundedBuffer::budget() const { return _budget; }
+
+void sim::trace2::BoundedBuffer::setBudget(Budget budget) {
+  _budget = budget;
+  enforceBudget();
+}
+
+bool sim::trace2::BoundedBuffer::writeFragment(const api2::trace::Fragment &fragment) {
+  if (!is_frame_header(fragment)) return InfiniteBuffer::writeFragment(fragment);
+  auto ret = InfiniteBuffer::writeFragment(fragment);
+  // Writing a frame header finalizes the length of the previous frame, so it is now safe to evict.
+  _frames++;
+  enforceBudget();
+  return ret;
+}
+
+void sim::trace2::BoundedBuffer::clear() {
+  InfiniteBuffer::clear();
+  _frames = 0;
+}
+
+void sim::trace2::BoundedBuffer::enforceBudget() {
+  const std::size_t bytes = _budget.bytes, frames = _budget.frames;
+  auto exceeds = [&](std::size_t loc, std::size_t byteLimit, std::size_t frameLimit) {
+    return (bytes != 0 && end() - loc > byteLimit) || (frames != 0 && _frames > frameLimit);
+  };
+  if (!exceeds(_base, bytes, frames)) return;
+
+  const std::size_t byteTarget = bytes - bytes / 4, frameTarget = std::max<std::size_t>(1, frames - frames / 4);
+  auto loc = _base;
+  // Never advance past the current frame.
+  while (_frames > 1 && exceeds(loc, byteTarget, frameTarget)) {
+    loc = next(loc, api2::trace::Level::Frame);
+    _frames--;
   }
+  evict(loc);
 }
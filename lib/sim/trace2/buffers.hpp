@@ -1,5 +1,5 @@
 #pragma once
-#include "lru/cache.hpp"
+#include <deque>
 #include "sim/api2.hpp"
 #include "sim/trace2/packet_utils.hpp"
 
@@ -30,27 +30,79 @@ public:
   bool traced(quint16 deviceID) const override;
   bool writeFragment(const api2::trace::Fragment &) override;
   bool updateFrameHeader() override;
+  void emitLazyFrameStart() override;
   void dropLast() override;
   void clear() override;
   FrameIterator cbegin() const override;
   FrameIterator cend() const override;
   FrameIterator crbegin() const override;
   FrameIterator crend() const override;
+  // Ticks started by emitLazyFrameStart which have not yet produced a frame.
+  quint32 pendingTicks() const;
+  // Ticks recorded by all frames written so far, including frames which have since been evicted.
+  quint64 ticks() const;
+  // Returns the first retained frame produced by the tick'th (0-indexed) tick or a later tick, or cend() if there is
+  // no such frame. Ticks are counted from the start of the trace, so they are unaffected by eviction.
+  // Runs in O(log n) time, plus a walk of at most indexStride frames.
+  FrameIterator seek(quint64 tick) const;
+  // Number of fragments deserialized to answer iterator queries since construction or the last clear.
+  // Walking a frame again should be served from the frame cursor, so this only grows when new frames are visited.
+  std::size_t decodes() const;
+
+protected:
+  // Locations are offsets from the start of the trace, which do not change when older fragments are discarded.
+  // _base is the location of the oldest fragment still held in _data.
+  std::size_t _base = 0;
+  // Discard all fragments before loc, which must be a frame header in a completed frame.
+  void evict(std::size_t loc);
 
 private:
   QSet<sim::api2::device::ID> _sinks = {};
   std::size_t _lastFrameStart = 0;
+  quint32 _pendingTicks = 0;
   // Need to be mutable so that IteratorImpl can read from them.
   mutable std::vector<std::byte> _data = {};
-
-  mutable LRU::Cache<std::size_t, std::size_t> _backlinks;
   zpp::bits::in<decltype(_data)> _in;
   zpp::bits::out<decltype(_data)> _out;
-  // Like normal next, except you can control if the iterator jumps between frames
-  // or walks cell-by-cell. user-facing next calls can take advantage of the speed,
-  // while internal next calls can use next to fill backlink cache.
-  std::size_t next(std::size_t loc, api2::trace::Level level, bool allow_jumps) const;
-  std::size_t last_before(std::size_t start, std::size_t end, api2::trace::Level payload) const;
+
+  // Sparse index used to seek by tick. It records the oldest retained frame and every indexStride'th frame written after
+  // it, along with the number of ticks recorded up to and including that frame.
+  struct IndexEntry {
+    std::size_t loc;
+    quint64 ticks;
+  };
+  static constexpr std::size_t indexStride = 64;
+  std::deque<IndexEntry> _index = {};
+  quint64 _ticks = 0;
+  std::size_t _framesSinceIndex = 0;
+  quint32 tickDelta(std::size_t loc) const;
+
+  // A fragment which has already been deserialized, so that walking the trace does not decode it again.
+  struct DecodedFragment {
+    std::size_t loc = 0, end = 0;
+    api2::trace::Level level = api2::trace::Level::Payload;
+    api2::trace::Fragment fragment = {};
+  };
+  // Cursor over the decoded fragments of one frame. Iterators step into a frame from its header, so the whole frame is
+  // decoded then, and every later access to its headers, payloads, sizes, or successors is served from the cursor.
+  // Fragments only link to the following fragment, so reverse iteration walks back through the cursor too.
+  struct FrameCursor {
+    std::size_t frame = -1, end = 0;
+    std::vector<DecodedFragment> fragments = {};
+    const DecodedFragment *find(std::size_t loc) const;
+  };
+  mutable FrameCursor _cursor = {};
+  mutable std::size_t _decodes = 0;
+  // The most recently decoded frame header and other fragment outside of the cursor.
+  mutable DecodedFragment _header = {.loc = std::size_t(-1)}, _single = {.loc = std::size_t(-1)};
+  const FrameCursor &decodeFrame(std::size_t frame) const;
+  // The reference is invalidated by the next call to decode or decodeFrame.
+  const DecodedFragment &decode(std::size_t loc) const;
+  // Location of the frame header for the frame containing loc.
+  std::size_t containingFrame(std::size_t loc) const;
+
+  // Convert a location to an index into _data, throwing if the location has been evicted.
+  std::size_t offset(std::size_t loc) const;
 
   // IteratorImpl interface
 public:
@@ -62,5 +114,31 @@ public:
   api2::packet::Payload payload(std::size_t loc) const override;
   std::size_t next(std::size_t loc, api2::trace::Level level) const override;
   std::size_t prev(std::size_t loc, api2::trace::Level level) const override;
+  bool evicted(std::size_t loc) const override;
+};
+
+// Caps memory usage for long-running simulations by evicting the oldest frames once a budget is exceeded.
+// Eviction moves the retained frames, so frames are evicted until the trace is within 3/4 of its budget. This
+// amortizes the cost of eviction over many frames, at the expense of sometimes retaining fewer frames than allowed.
+// The current frame is never evicted, so a single frame may exceed the byte budget.
+class BoundedBuffer : public InfiniteBuffer {
+public:
+  // A limit of 0 means that dimension is unbounded.
+  struct Budget {
+    std::size_t bytes = 0;
+    std::size_t frames = 0;
+  };
+  explicit BoundedBuffer(Budget budget);
+  Budget budget() const;
+  void setBudget(Budget budget);
+  // Buffer interface
+  bool writeFragment(const api2::trace::Fragment &) override;
+  void clear() override;
+
+private:
+  Budget _budget;
+  // Number of retained frames, including the current frame.
+  std::size_t _frames = 0;
+  void enforceBudget();
 };
 } // namespace sim::trace2
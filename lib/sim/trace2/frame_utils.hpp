@@ -76,4 +76,29 @@ struct GetFrameBackOffset {
   template <HasBackOffset Header> quint16 operator()(const Header &header) const { return header.back_offset; }
   quint16 operator()(const auto &header) const { return 0; };
 };
+
+template <typename T>
+concept HasTickDelta = requires(T t) {
+  { t.tick_delta } -> std::convertible_to<decltype(t.tick_delta)>;
+};
+class UpdateFrameTickDelta {
+public:
+  UpdateFrameTickDelta(quint32 tick_delta, sim::api2::frame::Header &out) : _tick_delta(tick_delta), _out(out){};
+  template <HasTickDelta Header> void operator()(const Header &header) {
+    Header copy = header;
+    copy.tick_delta = _tick_delta;
+    _out = copy;
+  }
+  void operator()(const auto &header){};
+
+private:
+  quint32 _tick_delta = 0;
+  sim::api2::frame::Header &_out;
+};
+
+// Extenders logically belong to the previous frame, so they do not advance time.
+struct GetFrameTickDelta {
+  template <HasTickDelta Header> quint32 operator()(const Header &header) const { return header.tick_delta; }
+  quint32 operator()(const auto &header) const { return 0; };
+};
 } // namespace sim::trace2
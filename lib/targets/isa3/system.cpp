@@ -77,8 +77,8 @@ targets::isa::System::System(builtins::Architecture arch, QList<obj::MemoryRegio
 
 std::pair<sim::api2::tick::Type, sim::api2::tick::Result> targets::isa::System::tick(sim::api2::Scheduler::Mode mode) {
   auto tb = _bus->buffer();
-  // TODO: only emit frames if something changed this cycle
-  if (tb) tb->emitFrameStart();
+  // Ticks which change nothing (e.g., branches) do not get a frame; they are counted in the next frame's tick_delta.
+  if (tb) tb->emitLazyFrameStart();
   auto res = _cpu->clock(_tick);
   if (tb) tb->updateFrameHeader();
   return {++_tick, res};
@@ -173,9 +173,102 @@ sim::memory::IDEController *targets::isa::System::ideController(QString name) {
 void targets::isa::System::doReloadEntries() {
   for (const auto &reg : _regions) {
     using size_type = bits::span<const quint8>::size_type;
-    reg.target->write(reg.base,
-                      {reinterpret_cast<const quint8 *>(reg.data.data()), static_cast<size_type>(reg.data.size())}, gs);
+    reg.target->write(reg.base, {reg.data.constData(), static_cast<size_type>(reg.data.size())}, gs);
   }
+  // Reloads write directly to memory, bypassing the bus and its write observer.
+  if (auto cpu = dynamic_cast<targets::pep10::isa::CPU *>(_cpu.data()); cpu) cpu->invalidateDecodeCache();
+}
+
+struct targets::isa::System::Snapshot {
+  builtins::Architecture arch = builtins::Architecture::NONE;
+  sim::api2::tick::Type tick = 0;
+  QVector<quint8> regs = {}, csrs = {};
+  quint16 depth = 0, startingPC = 0;
+  int status = 0;
+  // In the same order as _rawMemory.
+  QVector<QVector<quint8>> memory = {};
+  QMap<QString, sim::memory::Input<quint16>::Snapshot> inputs = {};
+  QMap<QString, sim::memory::Output<quint16>::Snapshot> outputs = {};
+  QMap<QString, sim::memory::IDEController::IDERegs> ide = {};
+};
+
+namespace {
+const auto internal = sim::api2::memory::Operation{
+    .type = sim::api2::memory::Operation::Type::BufferInternal,
+    .kind = sim::api2::memory::Operation::Kind::data,
+};
+
+QVector<quint8> dumpTarget(const sim::api2::memory::Target<quint8> &target) {
+  QVector<quint8> ret(sim::api2::memory::size_inclusive(target.span()));
+  target.dump({ret.data(), std::size_t(ret.size())});
+  return ret;
+}
+
+template <typename CPU> void captureCPU(CPU &cpu, targets::isa::System::Snapshot &snapshot) {
+  snapshot.regs = dumpTarget(*cpu.regs()), snapshot.csrs = dumpTarget(*cpu.csrs());
+  snapshot.depth = cpu.depth(), snapshot.startingPC = cpu.startingPC();
+  snapshot.status = static_cast<int>(cpu.status());
+}
+
+template <typename CPU> void restoreCPU(CPU &cpu, const targets::isa::System::Snapshot &snapshot) {
+  cpu.regs()->write(0, {snapshot.regs.constData(), std::size_t(snapshot.regs.size())}, internal);
+  cpu.csrs()->write(0, {snapshot.csrs.constData(), std::size_t(snapshot.csrs.size())}, internal);
+  cpu.restoreState(snapshot.depth, snapshot.startingPC, static_cast<typename CPU::Status>(snapshot.status));
+}
+} // namespace
+
+QSharedPointer<const targets::isa::System::Snapshot> targets::isa::System::snapshot() {
+  auto ret = QSharedPointer<Snapshot>::create();
+  ret->arch = _arch, ret->tick = _tick;
+  switch (_arch) {
+  case builtins::Architecture::PEP9: captureCPU(*dynamic_cast<targets::pep9::isa::CPU *>(_cpu.data()), *ret); break;
+  case builtins::Architecture::PEP10: captureCPU(*dynamic_cast<targets::pep10::isa::CPU *>(_cpu.data()), *ret); break;
+  default: throw std::logic_error("Unimplemented");
+  }
+  for (const auto &mem : _rawMemory) ret->memory.push_back(mem->snapshot());
+  for (auto it = _mmi.cbegin(); it != _mmi.cend(); ++it) ret->inputs[it.key()] = it.value()->snapshot();
+  for (auto it = _mmo.cbegin(); it != _mmo.cend(); ++it) ret->outputs[it.key()] = it.value()->snapshot();
+  for (auto it = _ide.cbegin(); it != _ide.cend(); ++it) ret->ide[it.key()] = it.value()->regs();
+  // Memory is now shared with the snapshot, so the CPU must not keep writing through its cached host pointers.
+  _bus->invalidateDirect();
+  return ret;
+}
+
+void targets::isa::System::restore(const Snapshot &snapshot) {
+  if (snapshot.arch != _arch || snapshot.memory.size() != _rawMemory.size() || snapshot.inputs.keys() != _mmi.keys() ||
+      snapshot.outputs.keys() != _mmo.keys() || snapshot.ide.keys() != _ide.keys())
+    throw std::logic_error("Snapshot does not match system");
+  _tick = snapshot.tick;
+  for (int it = 0; it < _rawMemory.size(); it++) _rawMemory[it]->restore(snapshot.memory[it]);
+  for (auto it = snapshot.inputs.cbegin(); it != snapshot.inputs.cend(); ++it) _mmi[it.key()]->restore(it.value());
+  for (auto it = snapshot.outputs.cbegin(); it != snapshot.outputs.cend(); ++it) _mmo[it.key()]->restore(it.value());
+  for (auto it = snapshot.ide.cbegin(); it != snapshot.ide.cend(); ++it) _ide[it.key()]->setRegs(it.value());
+  _bus->invalidateDirect();
+  switch (_arch) {
+  case builtins::Architecture::PEP9: restoreCPU(*dynamic_cast<targets::pep9::isa::CPU *>(_cpu.data()), snapshot); break;
+  case builtins::Architecture::PEP10: {
+    auto cpu = dynamic_cast<targets::pep10::isa::CPU *>(_cpu.data());
+    restoreCPU(*cpu, snapshot);
+    // Memory was replaced without passing through the bus's write observer.
+    cpu->invalidateDecodeCache();
+    break;
+  }
+  default: throw std::logic_error("Unimplemented");
+  }
+}
+
+QSharedPointer<targets::isa::System> targets::isa::System::fork(const Snapshot &snapshot) const {
+  // _memmap has no segments, so the fork's memory is allocated in the same order as ours but nothing is loaded.
+  auto ret = QSharedPointer<System>::create(_arch, _memmap, _mmios);
+  for (const auto &reg : _regions) {
+    for (int it = 0; it < _rawMemory.size(); it++) {
+      if (static_cast<sim::api2::memory::Target<quint16> *>(_rawMemory[it].data()) != reg.target.data()) continue;
+      ret->_regions.push_back(ReloadHelper{.target = ret->_rawMemory[it], .base = reg.base, .data = reg.data});
+      break;
+    }
+  }
+  ret->restore(snapshot);
+  return ret;
 }
 
 // Duplicated logic from systemFromElf to get the params to pass to reconfigure.
@@ -245,6 +338,9 @@ void targets::isa::System::reconfigure(builtins::Architecture arch, QList<obj::M
   _regions.clear();
   _nextID = _bus->deviceID() + 1;
 
+  _memmap = regions, _mmios = mmios;
+  for (auto &reg : _memmap) reg.segs.clear();
+
   // Reset bus and path management.
   _paths->clear();
   _bus->removeAllTargets();
@@ -320,6 +416,13 @@ void targets::isa::System::reconfigure(builtins::Architecture arch, QList<obj::M
     addDevice(cpu->csrs()->device());
     addDevice(cpu->regs()->device());
     cpu->setTarget(&*_bus, nullptr);
+    // Fetching from MMIO has side effects, so it must never be skipped by the decode cache.
+    QList<AddressSpan> uncacheable;
+    for (const auto &mmio : mmios) uncacheable.push_back(AddressSpan(mmio.minOffset, mmio.maxOffset));
+    cpu->setUncacheable(uncacheable);
+    cpu->setDecodeCacheEnabled(true);
+    // All writes to main memory pass through the bus, which keeps the decode cache coherent.
+    _bus->setWriteObserver([cpu](quint16 address, std::size_t length) { cpu->invalidateDecodeCache(address, length); });
     break;
   }
   default: throw std::logic_error("Unimplemented");
@@ -337,8 +440,8 @@ void targets::isa::System::appendReloadEntries(QSharedPointer<sim::api2::memory:
     auto fileData = seg->get_data();
     auto size = seg->get_file_size();
     if (fileData == nullptr) continue;
-    std::vector<quint8> data(size);
-    std::copy(fileData, fileData + size, data.data());
+    QVector<quint8> data(size);
+    std::copy(fileData, fileData + size, data.begin());
     _regions.push_back(ReloadHelper{.target = mem, .base = base, .data = std::move(data)});
     base += size;
   }
@@ -19,6 +19,7 @@
 #include <elfio/elfio.hpp>
 #include "builtins/constants.hpp"
 #include "link/memmap.hpp"
+#include "link/mmio.hpp"
 #include "sim/api2.hpp"
 
 namespace obj {
@@ -67,6 +68,16 @@ public:
   void doReloadEntries();
   void reconfigure(const ELFIO::elfio &elf);
 
+  // Captures the CPU, memory, and MMIO state of the system, but not its trace buffer or the contents of IDE disks.
+  // Memory and MMIO streams are implicitly shared with the system until either side modifies them, so taking and
+  // restoring a snapshot does not copy memory. Neither emits trace packets, so any attached buffer should be cleared.
+  struct Snapshot;
+  QSharedPointer<const Snapshot> snapshot();
+  // The snapshot must have been taken from this system or a fork of it, with no reconfigure in between.
+  void restore(const Snapshot &snapshot);
+  // Create an independent system with the same devices as this one, restored to snapshot.
+  QSharedPointer<System> fork(const Snapshot &snapshot) const;
+
 private:
   void reconfigure(builtins::Architecture arch, QList<obj::MemoryRegion> regions, QList<obj::AddressedIO> mmios);
   sim::api2::device::ID _nextID = 0;
@@ -75,11 +86,16 @@ private:
   struct ReloadHelper {
     QSharedPointer<sim::api2::memory::Target<quint16>> target;
     quint16 base;
-    std::vector<quint8> data;
+    // Implicitly shared, so that forks do not copy the loaded image.
+    QVector<quint8> data;
   };
   void appendReloadEntries(QSharedPointer<sim::api2::memory::Target<quint16>> mem, const obj::MemoryRegion &reg,
                            quint16 baseOffset = 0);
   QList<ReloadHelper> _regions;
+  // Parameters of the most recent reconfigure, so that the system can be forked. Segments are removed from the memory
+  // map, since they point into an ELF file which may not outlive the system; _regions holds their contents instead.
+  QList<obj::MemoryRegion> _memmap;
+  QList<obj::AddressedIO> _mmios;
 
   const builtins::Architecture _arch = builtins::Architecture::NONE;
   QSharedPointer<sim::api2::tick::Recipient> _cpu = nullptr;
@@ -35,12 +35,9 @@ sim::api2::memory::Operation gs_i = {
 };
 } // namespace
 
-template <typename T> using AddressSpan = sim::api2::memory::AddressSpan<T>;
 targets::pep10::isa::CPU::CPU(sim::api2::device::Descriptor device, sim::api2::device::IDGenerator gen)
-    : _device(device), _regs({.id = gen(), .baseName = "regs", .fullName = _device.fullName + "/regs"},
-                             AddressSpan<quint8>(0, quint8(::isa::Pep10::RegisterCount * 2 - 1))),
-      _csrs({.id = gen(), .baseName = "csrs", .fullName = _device.fullName + "/csrs"},
-            AddressSpan<quint8>(0, quint8(::isa::Pep10::CSRCount - 1))) {}
+    : _device(device), _regs({.id = gen(), .baseName = "regs", .fullName = _device.fullName + "/regs"}),
+      _csrs({.id = gen(), .baseName = "csrs", .fullName = _device.fullName + "/csrs"}) {}
 
 sim::api2::memory::Target<quint8> *targets::pep10::isa::CPU::regs() { return &_regs; }
 
@@ -68,6 +65,10 @@ void targets::pep10::isa::CPU::updateStartingPC() { _startingPC = readReg(::isa:
 
 quint16 targets::pep10::isa::CPU::depth() const { return _depth; }
 
+void targets::pep10::isa::CPU::restoreState(quint16 depth, quint16 startingPC, Status status) {
+  _depth = depth, _startingPC = startingPC, _status = status;
+}
+
 const sim::api2::tick::Source *targets::pep10::isa::CPU::getSource() { return _clock; }
 
 void targets::pep10::isa::CPU::setSource(sim::api2::tick::Source *clock) { _clock = clock; }
@@ -76,25 +77,30 @@ sim::api2::tick::Result targets::pep10::isa::CPU::clock(sim::api2::tick::Type cu
   using Register = ::isa::Pep10::Register;
   quint16 pc = _startingPC = readReg(Register::PC);
 
-  // Instruction specifier fetch + writeback.
-  quint8 is = 0;
-  _memory->read(pc, {&is, 1}, rw_i);
-  writeReg(Register::IS, is);
-  pc += 1;
-
-  sim::api2::tick::Result ret;
-  if (::isa::Pep10::isOpcodeUnary(is)) {
-    // Execute unary dispatch
-    ret = unaryDispatch(is, pc);
+  // Fetches must be performed when tracing so that they appear in the trace.
+  const Decoded *instr = _tb ? nullptr : cached(pc);
+  if (instr) {
+    writeReg(Register::IS, instr->is);
+    if (!instr->opcode.instr.unary) writeReg(Register::OS, instr->os);
   } else {
     // Instruction specifier fetch + writeback.
+    quint8 is = 0;
+    _memory.read(pc, {&is, 1}, rw_i);
+    writeReg(Register::IS, is);
+
     quint16 os = 0;
-    _memory->read(pc, {reinterpret_cast<quint8 *>(&os), 2}, rw_i);
-    os = bits::hostOrder() != bits::Order::BigEndian ? bits::byteswap(os) : os;
-    writeReg(Register::OS, os);
-    // Execute nonunary dispatch, which is responsible for writing back PC.
-    ret = nonunaryDispatch(is, os, pc += 2);
+    if (!::isa::Pep10::isOpcodeUnary(is)) {
+      // Operand specifier fetch + writeback.
+      _memory.read(pc + 1, {reinterpret_cast<quint8 *>(&os), 2}, rw_i);
+      os = bits::hostOrder() != bits::Order::BigEndian ? bits::byteswap(os) : os;
+      writeReg(Register::OS, os);
+    }
+    instr = decode(pc, is, os);
   }
+
+  if (_prof) _prof->notifyInstruction(pc, instr->is);
+  // Dispatch is responsible for writing back PC.
+  auto ret = (this->*instr->handler)(*instr, pc + (instr->opcode.instr.unary ? 1 : 3));
   // TODO: Check for BP's
   ret.pause = false;
   return ret;
@@ -108,6 +114,8 @@ bool targets::pep10::isa::CPU::analyze(sim::api2::trace::PacketIterator iter, si
 
 void targets::pep10::isa::CPU::setBuffer(sim::api2::trace::Buffer *tb) {
   _tb = tb;
+  // Accesses which bypass the bus are not traced.
+  _memory.setEnabled(tb == nullptr);
   _regs.setBuffer(tb);
   _csrs.setBuffer(tb);
 }
@@ -118,16 +126,87 @@ void targets::pep10::isa::CPU::trace(bool enabled) {
   _csrs.trace(enabled);
 }
 
-void targets::pep10::isa::CPU::setTarget(sim::api2::memory::Target<quint16> *target, void *port) { _memory = target; }
+void targets::pep10::isa::CPU::setTarget(sim::api2::memory::Target<quint16> *target, void *port) {
+  _memory.setTarget(target);
+}
+
+void targets::pep10::isa::CPU::setDebugger(pepp::sim::Debugger *debugger) {
+  _dbg = debugger;
+  _memory.setDebugger(debugger);
+}
+
+void targets::pep10::isa::CPU::clearDebugger() {
+  _dbg = nullptr;
+  _memory.setDebugger(nullptr);
+}
 
-void targets::pep10::isa::CPU::setDebugger(pepp::sim::Debugger *debugger) { _dbg = debugger; }
+void targets::pep10::isa::CPU::setProfiler(pepp::sim::Profiler *profiler) { _prof = profiler; }
 
-void targets::pep10::isa::CPU::clearDebugger() { _dbg = nullptr; }
+void targets::pep10::isa::CPU::clearProfiler() { _prof = nullptr; }
 
 void targets::pep10::isa::CPU::setCallsViaRet(const QSet<quint16> &calls) { _callsViaRet = calls; }
 
 void targets::pep10::isa::CPU::clearCallsViaRet() { _callsViaRet.clear(); }
 
+void targets::pep10::isa::CPU::setDecodeCacheEnabled(bool enabled) {
+  _decodeCacheEnabled = enabled;
+  // Only pay for the cache's storage when it is in use.
+  if (enabled) _decoded.resize(decodeCacheSize);
+  else _decoded = {};
+  invalidateDecodeCache();
+}
+
+bool targets::pep10::isa::CPU::decodeCacheEnabled() const { return _decodeCacheEnabled; }
+
+void targets::pep10::isa::CPU::setUncacheable(QList<sim::api2::memory::AddressSpan<quint16>> spans) {
+  _uncacheable = spans;
+  invalidateDecodeCache();
+}
+
+void targets::pep10::isa::CPU::invalidateDecodeCache() {
+  for (auto &entry : _decoded) entry.valid = false;
+}
+
+void targets::pep10::isa::CPU::invalidateDecodeCache(quint16 address, std::size_t length) {
+  if (!_decodeCacheEnabled) return;
+  else if (length >= decodeCacheSize) return invalidateDecodeCache();
+  // An instruction is up to 3 bytes long, so a write may modify an instruction starting up to 2 bytes before it.
+  for (std::size_t it = 0; it < length + 2; it++) {
+    quint16 start = address - 2 + it;
+    if (auto &entry = _decoded[start & (decodeCacheSize - 1)]; entry.valid && entry.pc == start) entry.valid = false;
+  }
+}
+
+const targets::pep10::isa::CPU::Decoded *targets::pep10::isa::CPU::cached(quint16 pc) const {
+  if (!_decodeCacheEnabled) return nullptr;
+  else if (auto &entry = _decoded[pc & (decodeCacheSize - 1)]; entry.valid && entry.pc == pc) return &entry;
+  return nullptr;
+}
+
+const targets::pep10::isa::CPU::Decoded *targets::pep10::isa::CPU::decode(quint16 pc, quint8 is, quint16 os) {
+  // When tracing, fetches are not skipped, so the cache can be re-used only if the fetched bytes still match.
+  if (auto entry = cached(pc); entry && entry->is == is && (entry->opcode.instr.unary || entry->os == os)) return entry;
+
+  Decoded instr = {.pc = pc, .os = os, .is = is, .valid = true, .opcode = ::isa::Pep10::opcodeLUT[is]};
+  if (instr.opcode.instr.unary) instr.handler = &CPU::unaryDispatch;
+  else {
+    instr.store = ::isa::Pep10::isStore(is);
+    instr.legalMode = ::isa::Pep10::isValidAddressingMode(instr.opcode.instr.mnemon, instr.opcode.mode);
+    instr.handler = &CPU::nonunaryDispatch;
+  }
+
+  bool cacheable = _decodeCacheEnabled && instr.opcode.valid;
+  for (quint16 it = 0; cacheable && it < (instr.opcode.instr.unary ? 1 : 3); it++)
+    for (const auto &span : _uncacheable) cacheable &= !sim::api2::memory::contains(span, quint16(pc + it));
+  if (!cacheable) {
+    _uncached = instr;
+    return &_uncached;
+  }
+  auto &entry = _decoded[pc & (decodeCacheSize - 1)];
+  entry = instr;
+  return &entry;
+}
+
 void targets::pep10::isa::CPU::incrDepth() {
   static const quint8 amt = 1;
   _depth++;
@@ -140,43 +219,35 @@ void targets::pep10::isa::CPU::decrDepth() {
   if (_tb) _tb->emitIncrement<quint8>(_device.id, 0, {&amt, 1});
 }
 
-quint16 targets::pep10::isa::CPU::readReg(::isa::Pep10::Register reg) {
-  quint16 ret = 0;
-  targets::isa::readRegister<::isa::Pep10, quint8>(&_regs, reg, ret, rw_d);
-  return ret;
-}
+quint16 targets::pep10::isa::CPU::readReg(::isa::Pep10::Register reg) { return _regs.get(static_cast<quint8>(reg)); }
 
 void targets::pep10::isa::CPU::writeReg(::isa::Pep10::Register reg, quint16 val) {
-  targets::isa::writeRegister<::isa::Pep10, quint8>(&_regs, reg, val, rw_d);
+  _regs.set(static_cast<quint8>(reg), val);
 }
 
-bool targets::pep10::isa::CPU::readCSR(::isa::Pep10::CSR csr) {
-  bool ret = 0;
-  targets::isa::readCSR<::isa::Pep10>(&_csrs, csr, ret, rw_d);
-  return ret;
-}
+bool targets::pep10::isa::CPU::readCSR(::isa::Pep10::CSR csr) { return _csrs.get(static_cast<quint8>(csr)); }
 
-void targets::pep10::isa::CPU::writeCSR(::isa::Pep10::CSR csr, bool val) {
-  targets::isa::writeCSR<::isa::Pep10, quint8>(&_csrs, csr, val, rw_d);
-}
+void targets::pep10::isa::CPU::writeCSR(::isa::Pep10::CSR csr, bool val) { _csrs.set(static_cast<quint8>(csr), val); }
 
 quint8 targets::pep10::isa::CPU::readPackedCSR() {
-  quint8 ret = 0;
-  targets::isa::readPackedCSR<::isa::Pep10>(&_csrs, ret, rw_d);
-  return ret;
+  return targets::isa::packCSR<::isa::Pep10>(_csrs.get(0), _csrs.get(1), _csrs.get(2), _csrs.get(3));
 }
 
 void targets::pep10::isa::CPU::writePackedCSR(quint8 val) {
-  targets::isa::writePackedCSR<::isa::Pep10>(&_csrs, val, rw_d);
+  auto [n, z, v, c] = targets::isa::unpackCSR<::isa::Pep10>(val);
+  // Update all CSRs at once so that only one trace packet is emitted.
+  const quint8 ctx[4] = {n, z, v, c};
+  _csrs.set(0, bits::span<const quint8>{ctx});
 }
 
-sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint16 pc) {
+sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(const Decoded &instr, quint16 pc) {
   using ISA = ::isa::Pep10;
   using mn = ISA::Mnemonic;
   using Register = ISA::Register;
 
   static const bool swap = bits::hostOrder() != bits::Order::BigEndian;
-  auto mnemonic = ::isa::Pep10::opcodeLUT[is];
+  const auto is = instr.is;
+  const auto &mnemonic = instr.opcode;
   quint16 a = readReg(Register::A), sp = readReg(Register::SP), x = readReg(Register::X);
   quint16 tmp = 0;
   bits::span<const quint8> tmpSpan = {reinterpret_cast<const quint8 *>(&tmp), sizeof(tmp)};
@@ -188,18 +259,22 @@ sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint
   auto [n, z, v, c] = ::targets::isa::unpackCSR<ISA>(readPackedCSR());
 
   switch (mnemonic.instr.mnemon) {
-  case mn::RET:
+  case mn::RET: {
     // Must occur before mdifying PC.
-    if (_callsViaRet.contains(pc - 1)) incrDepth();
+    const bool viaRet = _callsViaRet.contains(pc - 1);
+    if (viaRet) incrDepth();
     else decrDepth();
 
-    _memory->read(sp, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.read(sp, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     // Must byteswap tmp if on big endian host, as _memory stores in little
     // endian
     if (swap) tmp = bits::byteswap(tmp);
     pc = tmp;
     writeReg(Register::SP, sp + 2);
+    if (_prof && viaRet) _prof->notifyCall(pc);
+    else if (_prof) _prof->notifyReturn();
     break;
+  }
 
   case mn::MOVFLGA: writeReg(Register::A, readPackedCSR()); break;
   case mn::MOVAFLG: writePackedCSR(a); break;
@@ -347,22 +422,22 @@ sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint
     _regs.read(0, {ctx, tmp}, rw_d);
 
     // Reload NZVC
-    _memory->read(sp, {reinterpret_cast<quint8 *>(&tmp8), 1}, rw_d);
+    _memory.read(sp, {reinterpret_cast<quint8 *>(&tmp8), 1}, rw_d);
     writePackedCSR(tmp8);
 
     // Load A into ctx. No need for byteswap, _memory is little endian as are
     // regs.
-    _memory->read(sp + 1, {ctx + 2 * static_cast<quint8>(Register::A), 2}, rw_d);
+    _memory.read(sp + 1, {ctx + 2 * static_cast<quint8>(Register::A), 2}, rw_d);
     swap ? bits::byteswap(tmp) : tmp;
 
     // Load X into ctx
-    _memory->read(sp + 3, {ctx + 2 * static_cast<quint8>(Register::X), 2}, rw_d);
+    _memory.read(sp + 3, {ctx + 2 * static_cast<quint8>(Register::X), 2}, rw_d);
 
     // Load PC into ctx
-    _memory->read(sp + 5, {ctx + 2 * static_cast<quint8>(Register::PC), 2}, rw_d);
+    _memory.read(sp + 5, {ctx + 2 * static_cast<quint8>(Register::PC), 2}, rw_d);
 
     // Load SP into ctx
-    _memory->read(sp + 7, {ctx + 2 * static_cast<quint8>(Register::SP), 2}, rw_d);
+    _memory.read(sp + 7, {ctx + 2 * static_cast<quint8>(Register::SP), 2}, rw_d);
 
     // Bulk write-back regs, saving a number of bits on trace metadata.
     _regs.write(0, {ctx, registersBytes}, rw_d);
@@ -370,10 +445,11 @@ sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint
     tmp = sp + 10;
     // Using "host"'s variables, so byte swap if necessary.
     if (swap) tmp = bits::byteswap(tmp);
-    _memory->write(static_cast<quint16>(::isa::Pep10::MemoryVectors::SystemStackPtr),
+    _memory.write(static_cast<quint16>(::isa::Pep10::MemoryVectors::SystemStackPtr),
                    {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     // Skip "normal" return path, since we've already written to PC.
     if (_dbg) _dbg->notifyPCChanged(readReg(Register::PC));
+    if (_prof) _prof->notifyReturn();
     decrDepth();
     return {.pause = 0, .delay = 1};
 
@@ -391,20 +467,21 @@ sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint
     ctx[9] = is;
 
     // Read system stack address.
-    _memory->read(static_cast<quint16>(::isa::Pep10::MemoryVectors::SystemStackPtr),
+    _memory.read(static_cast<quint16>(::isa::Pep10::MemoryVectors::SystemStackPtr),
                   {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     if (swap) tmp = bits::byteswap(tmp);
 
     // Allocate ctx frame with -=.
-    _memory->write(tmp -= 10, {ctx, 10}, rw_d);
+    _memory.write(tmp -= 10, {ctx, 10}, rw_d);
     // And update SP with OS's SP.
     writeReg(Register::SP, tmp);
 
     // Read trap handler pc.
-    _memory->read(static_cast<quint16>(::isa::Pep10::MemoryVectors::TrapHandler), {reinterpret_cast<quint8 *>(&tmp), 2},
+    _memory.read(static_cast<quint16>(::isa::Pep10::MemoryVectors::TrapHandler), {reinterpret_cast<quint8 *>(&tmp), 2},
                   rw_d);
     if (swap) tmp = bits::byteswap(tmp);
     pc = tmp;
+    if (_prof) _prof->notifyCall(pc, true);
     incrDepth();
     break;
   default:
@@ -419,13 +496,13 @@ sim::api2::tick::Result targets::pep10::isa::CPU::unaryDispatch(quint8 is, quint
   return {.pause = 0, .delay = 1};
 }
 
-sim::api2::tick::Result targets::pep10::isa::CPU::nonunaryDispatch(quint8 is, quint16 os, quint16 pc) {
+sim::api2::tick::Result targets::pep10::isa::CPU::nonunaryDispatch(const Decoded &instr, quint16 pc) {
   using ISA = ::isa::Pep10;
   using mn = ISA::Mnemonic;
   using Register = ISA::Register;
 
   static const bool swap = bits::hostOrder() != bits::Order::BigEndian;
-  auto mnemonic = ::isa::Pep10::opcodeLUT[is];
+  const auto &mnemonic = instr.opcode;
   quint16 a = readReg(Register::A), sp = readReg(Register::SP), x = readReg(Register::X);
 
   quint16 operand = 0;
@@ -433,9 +510,8 @@ sim::api2::tick::Result targets::pep10::isa::CPU::nonunaryDispatch(quint8 is, qu
   quint16 tmp = 0;
   auto [n, z, v, c] = targets::isa::unpackCSR<ISA>(readPackedCSR());
 
-  auto instrDef = ::isa::Pep10::opcodeLUT[is];
-  if (::isa::Pep10::isValidAddressingMode(instrDef.instr.mnemon, instrDef.mode))
-    ::isa::Pep10::isStore(is) ? decodeStoreOperand(is, os, operand) : decodeLoadOperand(is, os, operand);
+  if (instr.legalMode)
+    instr.store ? decodeStoreOperand(instr.is, instr.os, operand) : decodeLoadOperand(instr.is, instr.os, operand);
   else throw std::logic_error("Invalid addressing mode");
 
   switch (mnemonic.instr.mnemon) {
@@ -451,9 +527,10 @@ sim::api2::tick::Result targets::pep10::isa::CPU::nonunaryDispatch(quint8 is, qu
   case mn::CALL:
     // Write PC to stack
     tmp = swap ? bits::byteswap(pc) : pc;
-    _memory->write(sp -= 2, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(sp -= 2, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     pc = operand;
     writeReg(Register::SP, sp);
+    if (_prof) _prof->notifyCall(pc);
     incrDepth();
     break;
 
@@ -488,20 +565,20 @@ sim::api2::tick::Result targets::pep10::isa::CPU::nonunaryDispatch(quint8 is, qu
 
   case mn::STWA:
     tmp = swap ? bits::byteswap(a) : a;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     break;
   case mn::STWX:
     tmp = swap ? bits::byteswap(x) : x;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     break;
 
   case mn::STBA:
     tmp = swap ? bits::byteswap(a) : a;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
     break;
   case mn::STBX:
     tmp = swap ? bits::byteswap(x) : x;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
     break;
 
   case mn::CPWA:
@@ -715,18 +792,18 @@ void targets::pep10::isa::CPU::decodeStoreOperand(quint8 is, quint16 os, quint16
   // case am::I:
   case am::D: decoded = os; break;
   case am::N:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::S: decoded = os + readReg(Register::SP); break;
   case am::X: decoded = os + readReg(Register::X); break;
   case am::SX: decoded = os + readReg(Register::SP) + readReg(Register::X); break;
   case am::SF:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SFX:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     decoded += readReg(Register::X);
     break;
@@ -748,51 +825,51 @@ void targets::pep10::isa::CPU::decodeLoadOperand(quint8 is, quint16 os, quint16
   switch (instruction.mode) {
   case am::I: decoded = os; break;
   case am::D:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::N:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded,
+    _memory.read(decoded,
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::S:
-    _memory->read(os + readReg(Register::SP),
+    _memory.read(os + readReg(Register::SP),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::X:
-    _memory->read(os + readReg(Register::X),
+    _memory.read(os + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SX:
-    _memory->read(os + readReg(Register::SP) + readReg(Register::X),
+    _memory.read(os + readReg(Register::SP) + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SF:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded,
+    _memory.read(decoded,
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SFX:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded + readReg(Register::X),
+    _memory.read(decoded + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
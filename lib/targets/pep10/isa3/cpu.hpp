@@ -19,7 +19,10 @@
 #include "isa/pep10.hpp"
 #include "sim/api2.hpp"
 #include "sim/debug/debugger.hpp"
+#include "sim/debug/profiler.hpp"
 #include "sim/device/dense.hpp"
+#include "sim/device/direct_port.hpp"
+#include "sim/device/register_file.hpp"
 
 namespace targets::pep10::isa {
 class CPU : public sim::api2::tick::Recipient,
@@ -51,6 +54,8 @@ public:
   // Set the starting PC to the current PC. Needed to get 1st step correct.
   void updateStartingPC();
   quint16 depth() const;
+  // Restore the state which is not held in regs() or csrs(), e.g., from a System snapshot.
+  void restoreState(quint16 depth, quint16 startingPC, Status status);
 
   // Target interface
   const sim::api2::tick::Source *getSource() override;
@@ -70,10 +75,23 @@ public:
 
   void setDebugger(pepp::sim::Debugger *debugger);
   void clearDebugger();
+  // Notified of every instruction, call, and return, including system calls.
+  void setProfiler(pepp::sim::Profiler *profiler);
+  void clearProfiler();
 
   void setCallsViaRet(const QSet<quint16> &calls);
   void clearCallsViaRet();
 
+  // Cache decoded instructions by PC. When no trace buffer is attached, a cache hit also skips the instruction fetch.
+  // Whoever enables the cache must forward every write to memory (including this CPU's own stores) to
+  // invalidateDecodeCache, or stale instructions will be executed. See SimpleBus::setWriteObserver.
+  void setDecodeCacheEnabled(bool enabled);
+  bool decodeCacheEnabled() const;
+  // Instructions which overlap these spans are never cached, since fetching from them has side effects (e.g., MMIO).
+  void setUncacheable(QList<sim::api2::memory::AddressSpan<quint16>> spans);
+  void invalidateDecodeCache();
+  void invalidateDecodeCache(quint16 address, std::size_t length);
+
 private:
   // Increment depth and emit a trace packet.
   void incrDepth();
@@ -82,12 +100,16 @@ private:
   quint16 _depth = 0, _startingPC = 0;
   Status _status = Status::Ok;
   sim::api2::device::Descriptor _device;
-  sim::memory::Dense<quint8> _regs, _csrs;
-  sim::api2::memory::Target<quint16> *_memory;
+  // Registers are the most frequently accessed state, so they are stored natively rather than in Dense memory.
+  sim::memory::RegisterFile<quint16, ::isa::Pep10::RegisterCount> _regs;
+  sim::memory::RegisterFile<quint8, ::isa::Pep10::CSRCount> _csrs;
+  // Bypasses the bus for main memory when no trace buffer is attached.
+  sim::memory::DirectPort<quint16> _memory;
 
   sim::api2::tick::Source *_clock = nullptr;
   sim::api2::trace::Buffer *_tb = nullptr;
   pepp::sim::Debugger *_dbg = nullptr;
+  pepp::sim::Profiler *_prof = nullptr;
 
   quint16 readReg(::isa::Pep10::Register reg);
   void writeReg(::isa::Pep10::Register reg, quint16 val);
@@ -96,8 +118,29 @@ private:
   quint8 readPackedCSR();
   void writePackedCSR(quint8 val);
 
-  sim::api2::tick::Result unaryDispatch(quint8 is, quint16 pc);
-  sim::api2::tick::Result nonunaryDispatch(quint8 is, quint16 os, quint16 pc);
+  // An instruction which has already been fetched and decoded. handler is the dispatch routine for the instruction,
+  // which avoids re-validating the opcode on every execution.
+  struct Decoded {
+    quint16 pc = 0, os = 0;
+    quint8 is = 0;
+    // Only cleared by invalidation, so that an instruction which overwrites itself can finish executing.
+    bool valid = false;
+    bool store = false, legalMode = false;
+    ::isa::Pep10::Opcode opcode = {};
+    sim::api2::tick::Result (CPU::*handler)(const Decoded &, quint16) = nullptr;
+  };
+  // Direct-mapped; must be a power of 2.
+  static constexpr quint16 decodeCacheSize = 2048;
+  bool _decodeCacheEnabled = false;
+  std::vector<Decoded> _decoded = {};
+  QList<sim::api2::memory::AddressSpan<quint16>> _uncacheable = {};
+  // Holds instructions that could not be placed in the cache.
+  Decoded _uncached = {};
+  const Decoded *cached(quint16 pc) const;
+  const Decoded *decode(quint16 pc, quint8 is, quint16 os);
+
+  sim::api2::tick::Result unaryDispatch(const Decoded &instr, quint16 pc);
+  sim::api2::tick::Result nonunaryDispatch(const Decoded &instr, quint16 pc);
   void decodeStoreOperand(quint8 is, quint16 os, quint16 &decoded, bool traced = true);
   void decodeLoadOperand(quint8 is, quint16 os, quint16 &decoded, bool traced = true);
   // We have an assembler-level hack to allow indirect calls via a RET mnemonic.
@@ -35,12 +35,9 @@ sim::api2::memory::Operation gs_i = {
     .kind = sim::api2::memory::Operation::Kind::instruction,
 };
 } // namespace
-template <typename T> using AddressSpan = sim::api2::memory::AddressSpan<T>;
 targets::pep9::isa::CPU::CPU(sim::api2::device::Descriptor device, sim::api2::device::IDGenerator gen)
-    : _device(device), _regs({.id = gen(), .baseName = "regs", .fullName = _device.fullName + "/regs"},
-                             AddressSpan<quint8>(0, quint8(::isa::Pep9::RegisterCount * 2 - 1))),
-      _csrs({.id = gen(), .baseName = "csrs", .fullName = _device.fullName + "/csrs"},
-            AddressSpan<quint8>(0, quint8(::isa::Pep9::CSRCount - 1))) {}
+    : _device(device), _regs({.id = gen(), .baseName = "regs", .fullName = _device.fullName + "/regs"}),
+      _csrs({.id = gen(), .baseName = "csrs", .fullName = _device.fullName + "/csrs"}) {}
 
 sim::api2::memory::Target<quint8> *targets::pep9::isa::CPU::regs() { return &_regs; }
 
@@ -70,6 +67,10 @@ void targets::pep9::isa::CPU::updateStartingPC() { _startingPC = readReg(::isa::
 
 quint16 targets::pep9::isa::CPU::depth() const { return _depth; }
 
+void targets::pep9::isa::CPU::restoreState(quint16 depth, quint16 startingPC, Status status) {
+  _depth = depth, _startingPC = startingPC, _status = status;
+}
+
 const sim::api2::tick::Source *targets::pep9::isa::CPU::getSource() { return _clock; }
 
 void targets::pep9::isa::CPU::setSource(sim::api2::tick::Source *clock) { _clock = clock; }
@@ -80,7 +81,7 @@ sim::api2::tick::Result targets::pep9::isa::CPU::clock(sim::api2::tick::Type cur
 
   // Instruction specifier fetch + writeback.
   quint8 is = 0;
-  _memory->read(pc, {&is, 1}, rw_i);
+  _memory.read(pc, {&is, 1}, rw_i);
   writeReg(Register::IS, is);
   pc += 1;
 
@@ -91,7 +92,7 @@ sim::api2::tick::Result targets::pep9::isa::CPU::clock(sim::api2::tick::Type cur
   } else {
     // Instruction specifier fetch + writeback.
     quint16 os = 0;
-    _memory->read(pc, {reinterpret_cast<quint8 *>(&os), 2}, rw_i);
+    _memory.read(pc, {reinterpret_cast<quint8 *>(&os), 2}, rw_i);
     os = bits::hostOrder() != bits::Order::BigEndian ? bits::byteswap(os) : os;
     writeReg(Register::OS, os);
     // Execute nonunary dispatch, which is responsible for writing back PC.
@@ -110,6 +111,8 @@ bool targets::pep9::isa::CPU::analyze(sim::api2::trace::PacketIterator iter, sim
 
 void targets::pep9::isa::CPU::setBuffer(sim::api2::trace::Buffer *tb) {
   _tb = tb;
+  // Accesses which bypass the bus are not traced.
+  _memory.setEnabled(tb == nullptr);
   _regs.setBuffer(tb);
   _csrs.setBuffer(tb);
 }
@@ -120,11 +123,19 @@ void targets::pep9::isa::CPU::trace(bool enabled) {
   _csrs.trace(enabled);
 }
 
-void targets::pep9::isa::CPU::setTarget(sim::api2::memory::Target<quint16> *target, void *port) { _memory = target; }
+void targets::pep9::isa::CPU::setTarget(sim::api2::memory::Target<quint16> *target, void *port) {
+  _memory.setTarget(target);
+}
 
-void targets::pep9::isa::CPU::setDebugger(pepp::sim::Debugger *debugger) { _dbg = debugger; }
+void targets::pep9::isa::CPU::setDebugger(pepp::sim::Debugger *debugger) {
+  _dbg = debugger;
+  _memory.setDebugger(debugger);
+}
 
-void targets::pep9::isa::CPU::clearDebugger() { _dbg = nullptr; }
+void targets::pep9::isa::CPU::clearDebugger() {
+  _dbg = nullptr;
+  _memory.setDebugger(nullptr);
+}
 
 void targets::pep9::isa::CPU::incrDepth() {
   static const quint8 amt = 1;
@@ -138,34 +149,25 @@ void targets::pep9::isa::CPU::decrDepth() {
   if (_tb) _tb->emitIncrement<quint8>(_device.id, 0, {&amt, 1});
 }
 
-quint16 targets::pep9::isa::CPU::readReg(::isa::Pep9::Register reg) {
-  quint16 ret = 0;
-  targets::isa::readRegister<::isa::Pep9, quint8>(&_regs, reg, ret, rw_d);
-  return ret;
-}
+quint16 targets::pep9::isa::CPU::readReg(::isa::Pep9::Register reg) { return _regs.get(static_cast<quint8>(reg)); }
 
 void targets::pep9::isa::CPU::writeReg(::isa::Pep9::Register reg, quint16 val) {
-  targets::isa::writeRegister<::isa::Pep9, quint8>(&_regs, reg, val, rw_d);
+  _regs.set(static_cast<quint8>(reg), val);
 }
 
-bool targets::pep9::isa::CPU::readCSR(::isa::Pep9::CSR csr) {
-  bool ret = 0;
-  targets::isa::readCSR<::isa::Pep9>(&_csrs, csr, ret, rw_d);
-  return ret;
-}
+bool targets::pep9::isa::CPU::readCSR(::isa::Pep9::CSR csr) { return _csrs.get(static_cast<quint8>(csr)); }
 
-void targets::pep9::isa::CPU::writeCSR(::isa::Pep9::CSR csr, bool val) {
-  targets::isa::writeCSR<::isa::Pep9, quint8>(&_csrs, csr, val, rw_d);
-}
+void targets::pep9::isa::CPU::writeCSR(::isa::Pep9::CSR csr, bool val) { _csrs.set(static_cast<quint8>(csr), val); }
 
 quint8 targets::pep9::isa::CPU::readPackedCSR() {
-  quint8 ret = 0;
-  targets::isa::readPackedCSR<::isa::Pep9>(&_csrs, ret, rw_d);
-  return ret;
+  return targets::isa::packCSR<::isa::Pep9>(_csrs.get(0), _csrs.get(1), _csrs.get(2), _csrs.get(3));
 }
 
 void targets::pep9::isa::CPU::writePackedCSR(quint8 val) {
-  targets::isa::writePackedCSR<::isa::Pep9>(&_csrs, val, rw_d);
+  auto [n, z, v, c] = targets::isa::unpackCSR<::isa::Pep9>(val);
+  // Update all CSRs at once so that only one trace packet is emitted.
+  const quint8 ctx[4] = {n, z, v, c};
+  _csrs.set(0, bits::span<const quint8>{ctx});
 }
 
 sim::api2::tick::Result targets::pep9::isa::CPU::unaryDispatch(quint8 is, quint16 pc) {
@@ -192,7 +194,7 @@ sim::api2::tick::Result targets::pep9::isa::CPU::unaryDispatch(quint8 is, quint1
     break;
 
   case mn::RET:
-    _memory->read(sp, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.read(sp, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     // Must byteswap tmp if on big endian host, as _memory stores in little
     // endian
     if (swap) tmp = bits::byteswap(tmp);
@@ -208,22 +210,22 @@ sim::api2::tick::Result targets::pep9::isa::CPU::unaryDispatch(quint8 is, quint1
     _regs.read(0, {ctx, tmp}, rw_d);
 
     // Reload NZVC
-    _memory->read(sp, {reinterpret_cast<quint8 *>(&tmp8), 1}, rw_d);
+    _memory.read(sp, {reinterpret_cast<quint8 *>(&tmp8), 1}, rw_d);
     writePackedCSR(tmp8);
 
     // Load A into ctx. No need for byteswap, _memory is little endian as are
     // regs.
-    _memory->read(sp + 1, {ctx + 2 * static_cast<quint8>(Register::A), 2}, rw_d);
+    _memory.read(sp + 1, {ctx + 2 * static_cast<quint8>(Register::A), 2}, rw_d);
     swap ? bits::byteswap(tmp) : tmp;
 
     // Load X into ctx
-    _memory->read(sp + 3, {ctx + 2 * static_cast<quint8>(Register::X), 2}, rw_d);
+    _memory.read(sp + 3, {ctx + 2 * static_cast<quint8>(Register::X), 2}, rw_d);
 
     // Load PC into ctx
-    _memory->read(sp + 5, {ctx + 2 * static_cast<quint8>(Register::PC), 2}, rw_d);
+    _memory.read(sp + 5, {ctx + 2 * static_cast<quint8>(Register::PC), 2}, rw_d);
 
     // Load SP into ctx
-    _memory->read(sp + 7, {ctx + 2 * static_cast<quint8>(Register::SP), 2}, rw_d);
+    _memory.read(sp + 7, {ctx + 2 * static_cast<quint8>(Register::SP), 2}, rw_d);
 
     // Bulk write-back regs, saving a number of bits on trace metadata.
     _regs.write(0, {ctx, registersBytes}, rw_d);
@@ -231,7 +233,7 @@ sim::api2::tick::Result targets::pep9::isa::CPU::unaryDispatch(quint8 is, quint1
     tmp = sp + 10;
     // Using "host"'s variables, so byte swap if necessary.
     if (swap) tmp = bits::byteswap(tmp);
-    _memory->write(static_cast<quint16>(::isa::Pep9::MemoryVectors::SystemStackPtr),
+    _memory.write(static_cast<quint16>(::isa::Pep9::MemoryVectors::SystemStackPtr),
                    {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     if (_dbg) _dbg->notifyPCChanged(readReg(Register::PC));
     decrDepth();
@@ -398,17 +400,17 @@ sim::api2::tick::Result targets::pep9::isa::CPU::unaryDispatch(quint8 is, quint1
     ctx[9] = is;
 
     // Read system stack address.
-    _memory->read(static_cast<quint16>(::isa::Pep9::MemoryVectors::SystemStackPtr),
+    _memory.read(static_cast<quint16>(::isa::Pep9::MemoryVectors::SystemStackPtr),
                   {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     if (swap) tmp = bits::byteswap(tmp);
 
     // Allocate ctx frame with -=.
-    _memory->write(tmp -= 10, {ctx, 10}, rw_d);
+    _memory.write(tmp -= 10, {ctx, 10}, rw_d);
     // And update SP with OS's SP.
     writeReg(Register::SP, tmp);
 
     // Read trap handler pc.
-    _memory->read(static_cast<quint16>(::isa::Pep9::MemoryVectors::TrapHandler), {reinterpret_cast<quint8 *>(&tmp), 2},
+    _memory.read(static_cast<quint16>(::isa::Pep9::MemoryVectors::TrapHandler), {reinterpret_cast<quint8 *>(&tmp), 2},
                   rw_d);
     if (swap) tmp = bits::byteswap(tmp);
     pc = tmp;
@@ -463,7 +465,7 @@ sim::api2::tick::Result targets::pep9::isa::CPU::nonunaryDispatch(quint8 is, qui
   case mn::CALL:
     // Write PC to stack
     tmp = swap ? bits::byteswap(pc) : pc;
-    _memory->write(sp -= 2, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(sp -= 2, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     pc = operand;
     writeReg(Register::SP, sp);
     incrDepth();
@@ -669,20 +671,20 @@ sim::api2::tick::Result targets::pep9::isa::CPU::nonunaryDispatch(quint8 is, qui
 
   case mn::STWA:
     tmp = swap ? bits::byteswap(a) : a;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     break;
   case mn::STWX:
     tmp = swap ? bits::byteswap(x) : x;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp), 2}, rw_d);
     break;
 
   case mn::STBA:
     tmp = swap ? bits::byteswap(a) : a;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
     break;
   case mn::STBX:
     tmp = swap ? bits::byteswap(x) : x;
-    _memory->write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
+    _memory.write(operand, {reinterpret_cast<quint8 *>(&tmp) + 1, 1}, rw_d);
     break;
   default:
     writeReg(Register::PC, pc);
@@ -708,18 +710,18 @@ void targets::pep9::isa::CPU::decodeStoreOperand(quint8 is, quint16 os, quint16
   // case am::I:
   case am::D: decoded = os; break;
   case am::N:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::S: decoded = os + readReg(Register::SP); break;
   case am::X: decoded = os + readReg(Register::X); break;
   case am::SX: decoded = os + readReg(Register::SP) + readReg(Register::X); break;
   case am::SF:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SFX:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     decoded += readReg(Register::X);
     break;
@@ -741,51 +743,51 @@ void targets::pep9::isa::CPU::decodeLoadOperand(quint8 is, quint16 os, quint16 &
   switch (instruction.mode) {
   case am::I: decoded = os; break;
   case am::D:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::N:
-    _memory->read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os, {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded,
+    _memory.read(decoded,
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::S:
-    _memory->read(os + readReg(Register::SP),
+    _memory.read(os + readReg(Register::SP),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::X:
-    _memory->read(os + readReg(Register::X),
+    _memory.read(os + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SX:
-    _memory->read(os + readReg(Register::SP) + readReg(Register::X),
+    _memory.read(os + readReg(Register::SP) + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SF:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded,
+    _memory.read(decoded,
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
     break;
   case am::SFX:
-    _memory->read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
+    _memory.read(os + readReg(Register::SP), {reinterpret_cast<quint8 *>(&decoded), 2}, acc_i);
 
     if (swap) decoded = bits::byteswap(decoded);
-    _memory->read(decoded + readReg(Register::X),
+    _memory.read(decoded + readReg(Register::X),
                   {reinterpret_cast<quint8 *>(&decoded) + int(isByte && swap ? 1 : 0), std::size_t(isByte ? 1 : 2)},
                   acc_i);
     if (swap) decoded = bits::byteswap(decoded);
@@ -20,6 +20,8 @@
 #include "sim/api2.hpp"
 #include "sim/debug/debugger.hpp"
 #include "sim/device/dense.hpp"
+#include "sim/device/direct_port.hpp"
+#include "sim/device/register_file.hpp"
 
 namespace sim::memory {
 template <typename Address> class Output;
@@ -57,6 +59,8 @@ public:
   // Set the starting PC to the current PC. Needed to get 1st step correct.
   void updateStartingPC();
   quint16 depth() const;
+  // Restore the state which is not held in regs() or csrs(), e.g., from a System snapshot.
+  void restoreState(quint16 depth, quint16 startingPC, Status status);
 
   // Target interface
   const sim::api2::tick::Source *getSource() override;
@@ -85,8 +89,11 @@ private:
   quint16 _depth = 0, _startingPC = 0;
   Status _status = Status::Ok;
   sim::api2::device::Descriptor _device;
-  sim::memory::Dense<quint8> _regs, _csrs;
-  sim::api2::memory::Target<quint16> *_memory;
+  // Registers are the most frequently accessed state, so they are stored natively rather than in Dense memory.
+  sim::memory::RegisterFile<quint16, ::isa::Pep9::RegisterCount> _regs;
+  sim::memory::RegisterFile<quint8, ::isa::Pep9::CSRCount> _csrs;
+  // Bypasses the bus for main memory when no trace buffer is attached.
+  sim::memory::DirectPort<quint16> _memory;
   sim::memory::Output<quint16> *_pwrOff = nullptr;
 
   sim::api2::tick::Source *_clock = nullptr;
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "asm/pas/ast/node.hpp"
+#include <catch.hpp>
+#include "asm/pas/ast/generic/attr_comment.hpp"
+#include "asm/pas/ast/generic/attr_comment_indent.hpp"
+#include "asm/pas/ast/generic/attr_directive.hpp"
+#include "asm/pas/ast/generic/attr_hide.hpp"
+#include "asm/pas/ast/generic/attr_macro.hpp"
+#include "asm/pas/ast/generic/attr_sec.hpp"
+#include "asm/pas/ast/value/decimal.hpp"
+#include "asm/symbol/table.hpp"
+
+using namespace Qt::StringLiterals;
+
+TEST_CASE("AST node attributes", "[scope:asm][kind:unit][arch:*]") {
+  using namespace pas::ast::generic;
+  using pas::ast::Node;
+  auto root = QSharedPointer<Node>::create(Type{.value = Type::Structural});
+  auto node = QSharedPointer<Node>::create(Type{.value = Type::Instruction}, root);
+  auto child = QSharedPointer<Node>::create(Type{.value = Type::Blank}, node);
+  auto table = QSharedPointer<symbol::Table>::create(2);
+  auto value = QSharedPointer<pas::ast::value::UnsignedDecimal>::create(5, 2);
+
+  // Slotted attributes.
+  const auto type = Type{.value = Type::Directive};
+  const auto parent = Parent{.value = root};
+  const auto children = Children{.value = {child}};
+  const auto location = SourceLocation{.value = {.line = 7, .valid = true}};
+  const auto symbol = SymbolDeclaration{.value = table->define(u"sym"_s)};
+  const auto argument = Argument{.value = value};
+  const auto address = Address{.value = {.start = 0x10, .size = 2}};
+  // Attributes stored in the map.
+  const auto arguments = ArgumentList{.value = {value, value}};
+  const auto comment = Comment{.value = u"comment"_s};
+  const auto indent = CommentIndent{.value = CommentIndent::Level::Instruction};
+  const auto directive = Directive{.value = u"BLOCK"_s};
+  const auto error = Error{.value = {Message{.severity = Message::Severity::Fatal, .message = u"error"_s}}};
+  const auto hide = Hide{.value = {.source = true, .listing = true}};
+  const auto macro = Macro{.value = u"macro"_s};
+  const auto flags = SectionFlags{.value = {.R = true, .W = false, .X = true, .Z = true}};
+  const auto section = SectionName{.value = u"data"_s};
+  const auto symtab = SymbolTable{.value = table};
+  const auto rootLocation = RootLocation{.value = {.line = 3, .valid = true}};
+  const auto listingLocation = ListingLocation{.value = {.line = 4, .valid = true}};
+
+  node->set(type), node->set(parent), node->set(children), node->set(location), node->set(symbol);
+  node->set(argument), node->set(address);
+  node->set(arguments), node->set(comment), node->set(indent), node->set(directive), node->set(error);
+  node->set(hide), node->set(macro), node->set(flags), node->set(section), node->set(symtab);
+  node->set(rootLocation), node->set(listingLocation);
+
+  SECTION("Round trip through attributes") {
+    auto attributes = node->attributes();
+    CHECK(attributes.size() == 19);
+    auto copy = QSharedPointer<Node>::create(Type{.value = Type::Blank});
+    copy->fromAttributes(attributes);
+    CHECK(copy->get<Type>() == type);
+    CHECK(copy->get<Parent>() == parent);
+    CHECK(copy->get<Children>() == children);
+    CHECK(copy->get<SourceLocation>() == location);
+    CHECK(copy->get<SymbolDeclaration>() == symbol);
+    CHECK(copy->get<Argument>() == argument);
+    CHECK(copy->get<Address>() == address);
+    CHECK(copy->get<ArgumentList>() == arguments);
+    CHECK(copy->get<Comment>() == comment);
+    CHECK(copy->get<CommentIndent>() == indent);
+    CHECK(copy->get<Directive>() == directive);
+    CHECK(copy->get<Error>() == error);
+    CHECK(copy->get<Hide>() == hide);
+    CHECK(copy->get<Macro>() == macro);
+    CHECK(copy->get<SectionFlags>() == flags);
+    CHECK(copy->get<SectionName>() == section);
+    CHECK(copy->get<SymbolTable>() == symtab);
+    CHECK(copy->get<RootLocation>() == rootLocation);
+    CHECK(copy->get<ListingLocation>() == listingLocation);
+    // Slotted attributes are also visible without copying.
+    REQUIRE(copy->find<Address>() != nullptr);
+    CHECK(*copy->find<Address>() == address);
+  }
+
+  SECTION("Take a slotted attribute") {
+    CHECK(node->take<Argument>() == argument);
+    CHECK_FALSE(node->has<Argument>());
+    CHECK(node->find<Argument>() == nullptr);
+    CHECK_FALSE(node->attributes().contains(Argument::attribute));
+    CHECK_THROWS(node->get<Argument>());
+    // Taking an attribute from the map does not disturb the slots.
+    CHECK(node->take<Comment>() == comment);
+    CHECK_FALSE(node->has<Comment>());
+    CHECK(node->has<Address>());
+  }
+
+  SECTION("Append children in place") {
+    const auto &list = pas::ast::children(*node);
+    auto second = QSharedPointer<Node>::create(Type{.value = Type::Blank}, node);
+    pas::ast::addChild(*node, second);
+    // The list is moved out of and back into its slot, so the reference still sees the appended child.
+    REQUIRE(list.size() == 2);
+    CHECK(list[0] == child);
+    CHECK(list[1] == second);
+    CHECK(&pas::ast::children(*node) == &list);
+  }
+}
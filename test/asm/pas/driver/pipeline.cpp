@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "asm/pas/driver/common.hpp"
+
+using namespace Qt::StringLiterals;
+
+namespace {
+enum class Stage { Start, Parse, Link, End };
+using Target = pas::driver::Target<Stage>;
+
+// Records when each target passes through a stage, so that tests can check the order in which transforms ran.
+struct Log {
+  QMutex mutex;
+  QStringList events;
+  void push(QString event) {
+    QMutexLocker locker(&mutex);
+    events.push_back(event);
+  }
+};
+
+class Record : public pas::driver::Transform<Stage> {
+public:
+  Record(QSharedPointer<Log> log, QString name, Stage to, bool success = true)
+      : _log(log), _name(name), _to(to), _success(success) {}
+  bool operator()(QSharedPointer<pas::driver::Globals>, QSharedPointer<Target>) override {
+    _log->push(_name);
+    return _success;
+  }
+  Stage toStage() override { return _to; }
+
+private:
+  QSharedPointer<Log> _log;
+  QString _name;
+  Stage _to;
+  bool _success;
+};
+
+auto target(QSharedPointer<Log> log, QString name, bool linkSucceeds = true) {
+  auto ret = QSharedPointer<Target>::create();
+  ret->stage = Stage::Start;
+  QList<QSharedPointer<pas::driver::Transform<Stage>>> ops = {
+      QSharedPointer<Record>::create(log, name + ":parse", Stage::Link),
+      QSharedPointer<Record>::create(log, name + ":link", Stage::End, linkSucceeds)};
+  return qMakePair(ret, ops);
+}
+} // namespace
+
+TEST_CASE("Concurrent assembly pipeline", "[scope:asm][kind:unit][arch:*]") {
+  auto log = QSharedPointer<Log>::create();
+  pas::driver::Pipeline<Stage> pipeline;
+  pipeline.globals = QSharedPointer<pas::driver::Globals>::create();
+  pipeline.concurrent = true;
+  pipeline.waitFor = {{Stage::Link, Stage::End}};
+  SECTION("Dependent stages run in target order") {
+    for (auto name : {"os", "a", "b"}) pipeline.pipelines.push_back(target(log, name));
+    REQUIRE(pipeline.assemble(Stage::End));
+    for (auto &[target, _] : pipeline.pipelines) CHECK(target->stage == Stage::End);
+    REQUIRE(log->events.size() == 6);
+    CHECK(log->events.indexOf("os:link") < log->events.indexOf("a:link"));
+    CHECK(log->events.indexOf("a:link") < log->events.indexOf("b:link"));
+    for (auto name : {"os", "a", "b"})
+      CHECK(log->events.indexOf(u"%1:parse"_s.arg(name)) < log->events.indexOf(u"%1:link"_s.arg(name)));
+  }
+  SECTION("Failures stop later dependent stages") {
+    pipeline.pipelines.push_back(target(log, "os", false));
+    pipeline.pipelines.push_back(target(log, "user"));
+    CHECK_FALSE(pipeline.assemble(Stage::End));
+    CHECK(log->events.contains("os:link"));
+    CHECK_FALSE(log->events.contains("user:link"));
+  }
+  SECTION("Stop after the target stage") {
+    for (auto name : {"os", "user"}) pipeline.pipelines.push_back(target(log, name));
+    REQUIRE(pipeline.assemble(Stage::Parse));
+    CHECK(log->events.size() == 2);
+    for (auto &[target, _] : pipeline.pipelines) CHECK(target->stage == Stage::Link);
+  }
+}
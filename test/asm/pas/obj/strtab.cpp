@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "asm/pas/obj/common.hpp"
+
+TEST_CASE("ELF string pooling", "[scope:asm][kind:unit][arch:*]") {
+  auto read = [](const std::string &data, ELFIO::Elf_Word offset) { return std::string(data.c_str() + offset); };
+  SECTION("Suffixes share storage") {
+    pas::obj::common::StringPool pool;
+    for (auto str : {"max", "x", "ax", "min", "max"}) pool.add(str);
+    std::string data;
+    auto offsets = pool.build(data);
+    CHECK(data == std::string("\0max\0min\0", 9));
+    for (auto str : {"max", "x", "ax", "min"}) CHECK(read(data, offsets.at(str)) == str);
+  }
+  SECTION("Existing contents are preserved") {
+    pas::obj::common::StringPool pool;
+    pool.add("new");
+    std::string data("\0old\0", 5);
+    auto offsets = pool.build(data);
+    CHECK(read(data, 1) == "old");
+    CHECK(read(data, offsets.at("new")) == "new");
+  }
+}
@@ -16,11 +16,19 @@
 
 #include "asm/pas/operations/generic/include_macros.hpp"
 #include <catch.hpp>
+#include "asm/pas/ast/generic/attr_argument.hpp"
 #include "asm/pas/ast/generic/attr_children.hpp"
+#include "asm/pas/ast/generic/attr_comment.hpp"
+#include "asm/pas/ast/generic/attr_macro.hpp"
+#include "asm/pas/ast/generic/attr_symbol.hpp"
+#include "asm/pas/ast/pepp/attr_addr.hpp"
+#include "asm/pas/ast/value/hexadecimal.hpp"
+#include "asm/pas/ast/value/symbolic.hpp"
 #include "asm/pas/driver/pep10.hpp"
 #include "asm/pas/driver/pepp.hpp"
 #include "asm/pas/errors.hpp"
 #include "asm/pas/operations/generic/errors.hpp"
+#include "asm/symbol/table.hpp"
 #include "isa/pep10.hpp"
 #include "macro/macro.hpp"
 #include "macro/registry.hpp"
@@ -142,5 +150,76 @@ TEST_CASE("Include macros", "[scope:asm][kind:unit][arch:pep10]") {
     smoke(registry, input, &validNesting_test, false, false);
     smoke(registry, input, &validNesting_test, true, false);
   }
+
+  // Repeated invocations clone a single parse of the macro body, which must still bind to the caller's symbols.
+  SECTION("Repeated invocation") {
+    using namespace pas::ast::generic;
+    auto registry = QSharedPointer<macro::Registry>::create();
+    auto macro = QSharedPointer<macro::Parsed>::create(u"gamma"_s, 1, u"LDWA $1,d"_s, u"pep/10"_s);
+    registry->registerMacro(macro::types::Core, macro);
+    auto parseRoot = pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(false);
+    auto res = parseRoot(u"@gamma x\n@gamma x\nx: .block 2"_s, nullptr);
+    REQUIRE(!res.hadError);
+    REQUIRE(pas::ops::generic::includeMacros(
+        *res.root, pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(true), registry));
+    auto x = res.root->get<SymbolTable>().value->get(u"x"_s);
+    REQUIRE(x.has_value());
+
+    QList<QSharedPointer<pas::ast::Node>> instructions;
+    for (const auto &child : res.root->get<Children>().value) {
+      if (!child->has<Macro>()) continue;
+      auto grandchildren = child->get<Children>().value;
+      REQUIRE(grandchildren.size() == 3);
+      instructions.push_back(grandchildren[1]);
+    }
+    REQUIRE(instructions.size() == 2);
+    CHECK(instructions[0] != instructions[1]);
+    for (const auto &instruction : instructions) {
+      REQUIRE(instruction->has<Argument>());
+      auto symbolic = dynamic_cast<pas::ast::value::Symbolic *>(instruction->get<Argument>().value.data());
+      REQUIRE(symbolic != nullptr);
+      CHECK(symbolic->symbol() == *x);
+    }
+  }
+  // Templates are shared by every invocation of a macro, so operands must be substituted in the cloned nodes.
+  SECTION("Invocations with distinct arguments") {
+    using namespace pas::ast::generic;
+    using AddressingMode = pas::ast::pepp::AddressingMode<isa::Pep10>;
+    auto registry = QSharedPointer<macro::Registry>::create();
+    auto operand = QSharedPointer<macro::Parsed>::create(u"delta"_s, 1, u"LDWA $1,d ;load $1"_s, u"pep/10"_s);
+    registry->registerMacro(macro::types::Core, operand);
+    // An addressing mode changes the parse, so it must be substituted before parsing.
+    auto mode = QSharedPointer<macro::Parsed>::create(u"eps"_s, 2, u"LDWA $1,$2"_s, u"pep/10"_s);
+    registry->registerMacro(macro::types::Core, mode);
+    auto parseRoot = pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(false);
+    auto res = parseRoot(u"@delta x\n@delta 0x0010\n@eps x,d\n@eps x,i\nx: .block 2"_s, nullptr);
+    REQUIRE(!res.hadError);
+    REQUIRE(pas::ops::generic::includeMacros(
+        *res.root, pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(true), registry));
+    auto symtab = res.root->get<SymbolTable>().value;
+    auto x = symtab->get(u"x"_s);
+    REQUIRE(x.has_value());
+    CHECK(!symtab->get(u"__macro_arg1__"_s).has_value());
+
+    QList<QSharedPointer<pas::ast::Node>> instructions;
+    for (const auto &child : res.root->get<Children>().value) {
+      if (!child->has<Macro>()) continue;
+      auto grandchildren = child->get<Children>().value;
+      REQUIRE(grandchildren.size() == 3);
+      instructions.push_back(grandchildren[1]);
+    }
+    REQUIRE(instructions.size() == 4);
+    for (const auto &instruction : instructions) REQUIRE(instruction->has<Argument>());
+    auto symbolic = dynamic_cast<pas::ast::value::Symbolic *>(instructions[0]->get<Argument>().value.data());
+    REQUIRE(symbolic != nullptr);
+    CHECK(symbolic->symbol() == *x);
+    CHECK(instructions[0]->get<Comment>().value == u"load x"_s);
+    auto hex = dynamic_cast<pas::ast::value::Hexadecimal *>(instructions[1]->get<Argument>().value.data());
+    REQUIRE(hex != nullptr);
+    CHECK(hex->string() == u"0x0010"_s);
+    CHECK(instructions[1]->get<Comment>().value == u"load 0x0010"_s);
+    CHECK(instructions[2]->get<AddressingMode>().value == isa::Pep10::AddressingMode::D);
+    CHECK(instructions[3]->get<AddressingMode>().value == isa::Pep10::AddressingMode::I);
+  }
   // TODO: Reject macro loops
 }
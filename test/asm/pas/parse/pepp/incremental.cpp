@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "asm/pas/ast/generic/attr_children.hpp"
+#include "asm/pas/ast/generic/attr_location.hpp"
+#include "asm/pas/ast/generic/attr_symbol.hpp"
+#include "asm/pas/driver/incremental.hpp"
+#include "asm/pas/driver/pepp.hpp"
+#include "asm/pas/operations/pepp/string.hpp"
+#include "asm/symbol/table.hpp"
+#include "isa/pep10.hpp"
+
+using namespace Qt::StringLiterals;
+
+namespace {
+// Compare an incremental parse against a parse of the whole program.
+void matchesWholeParse(pas::driver::IncrementalParser &incremental, QString text) {
+  using namespace pas::ast::generic;
+  auto whole = pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(false)(text, nullptr);
+  auto parsed = incremental(text, nullptr);
+  CHECK(parsed.hadError == whole.hadError);
+  auto lhs = pas::ast::children(*parsed.root), rhs = pas::ast::children(*whole.root);
+  REQUIRE(lhs.size() == rhs.size());
+  for (int it = 0; it < lhs.size(); it++) {
+    CHECK(lhs[it]->has<SourceLocation>() == rhs[it]->has<SourceLocation>());
+    if (lhs[it]->has<SourceLocation>())
+      CHECK(lhs[it]->get<SourceLocation>().value.line == rhs[it]->get<SourceLocation>().value.line);
+  }
+  CHECK(pas::ops::pepp::formatSource<isa::Pep10>(*parsed.root) ==
+        pas::ops::pepp::formatSource<isa::Pep10>(*whole.root));
+  // Symbols must be bound to the new program's table, rather than the table of a cached line.
+  auto table = parsed.root->get<SymbolTable>().value;
+  for (const auto &child : lhs)
+    if (child->has<SymbolDeclaration>()) CHECK(&child->get<SymbolDeclaration>().value->parent == &*table);
+}
+} // namespace
+
+TEST_CASE("Incremental parsing", "[scope:asm][kind:unit][arch:pep10]") {
+  pas::driver::IncrementalParser parser(pas::driver::pepp::createParser<isa::Pep10, pas::driver::ANTLRParserTag>(false));
+  QString text = u"main: LDWA x,d\n\n;comment\nSTWA y,d\r\nx: .WORD 5\ny: .BLOCK 2\n.END\n"_s;
+  matchesWholeParse(parser, text);
+  CHECK(parser.parsedLines() == 7);
+
+  SECTION("Unchanged") {
+    matchesWholeParse(parser, text);
+    CHECK(parser.parsedLines() == 0);
+  }
+  SECTION("Edited line") {
+    matchesWholeParse(parser, text.replace(u"x: .WORD 5"_s, u"x: .WORD 6"_s));
+    CHECK(parser.parsedLines() == 1);
+  }
+  SECTION("Inserted line") {
+    matchesWholeParse(parser, text.replace(u"\n\n"_s, u"\nADDA 1,i\n"_s));
+    CHECK(parser.parsedLines() == 1);
+  }
+  SECTION("Empty") {
+    matchesWholeParse(parser, u""_s);
+    matchesWholeParse(parser, u"\n"_s);
+  }
+}
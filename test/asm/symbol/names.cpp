@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "asm/symbol/names.hpp"
+#include "asm/symbol/table.hpp"
+#include "asm/symbol/visit.hpp"
+
+TEST_CASE("Symbol name interning", "[scope:asm.sym][kind:unit][arch:*]") {
+  SECTION("Pool") {
+    symbol::NamePool pool;
+    CHECK(!pool.find("hello").has_value());
+    auto hello = pool.intern("hello");
+    CHECK(pool.intern("Hello") != hello);
+    CHECK(pool.intern("hello") == hello);
+    CHECK(pool.find("hello") == hello);
+    CHECK(pool.name(hello) == "hello");
+    CHECK(pool.size() == 2);
+  }
+  SECTION("Map grows") {
+    symbol::IdMap<int> map;
+    CHECK(map.find(0) == nullptr);
+    for (int it = 0; it < 1000; it++) map[it * 7] = it;
+    CHECK(map.size() == 1000);
+    for (int it = 0; it < 1000; it++) {
+      REQUIRE(map.find(it * 7) != nullptr);
+      CHECK(*map.find(it * 7) == it);
+    }
+    CHECK(map.find(1) == nullptr);
+  }
+  SECTION("Tree index") {
+    auto root = QSharedPointer<symbol::Table>::create(2);
+    auto l1 = root->addChild(), l2 = root->addChild();
+    auto x1 = l1->reference("x"), x2 = l2->reference("x");
+    // Each leaf's index covers its siblings, but separate hierarchies do not share an index.
+    auto other = QSharedPointer<symbol::Table>::create(2);
+    other->reference("x");
+    for (const auto &table : {root, l1, l2}) {
+      auto found = table->selectInTree("x");
+      CHECK(found.size() == 2);
+      CHECK(found.contains(x1));
+      CHECK(found.contains(x2));
+    }
+    CHECK(root->selectInTree("y").isEmpty());
+    CHECK(!root->exists("x"));
+    CHECK(symbol::exists(root, "x", symbol::TraversalPolicy::kWholeTree));
+  }
+}
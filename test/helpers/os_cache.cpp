@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "builtins/figure.hpp"
+#include "helpers/asmb.hpp"
+#include "helpers/os_cache.hpp"
+#include "macro/macro.hpp"
+
+namespace {
+QString os(QSharedPointer<const builtins::Book> book) {
+  return book->findFigure("os", "pep10baremetal")->typesafeElements()["pep"]->contents;
+}
+QByteArray bytes(ELFIO::elfio &elf) {
+  std::stringstream s;
+  elf.save(s);
+  return QByteArray::fromStdString(s.str());
+}
+} // namespace
+
+TEST_CASE("OS image cache", "[scope:asm][kind:int][arch:pep10]") {
+  using Arch = builtins::Architecture;
+  auto book = helpers::book(6);
+  auto registry = helpers::registry(book, {});
+  auto &cache = helpers::OSImageCache::instance();
+  cache.clear();
+
+  SECTION("Matches uncached assembly") {
+    helpers::AsmHelper helper(registry, os(book), Arch::PEP10);
+    REQUIRE(helper.assemble());
+    auto truth = helper.elf();
+    auto cached = cache.elf(registry, os(book), Arch::PEP10);
+    REQUIRE(cached);
+    CHECK(bytes(*cached) == bytes(*truth));
+    CHECK(cache.size() == 1);
+  }
+  SECTION("Hits return independent copies") {
+    auto first = cache.elf(registry, os(book), Arch::PEP10);
+    auto second = cache.elf(registry, os(book), Arch::PEP10, QList<quint8>{0xFE, 0xED});
+    REQUIRE(first);
+    REQUIRE(second);
+    CHECK(first != second);
+    CHECK(cache.size() == 1);
+    CHECK(second->sections["usr.txt"] != nullptr);
+    CHECK(first->sections["usr.txt"] == nullptr);
+  }
+  SECTION("Keys depend on OS and macros") {
+    const auto key = helpers::OSImageCache::key(*registry, os(book), Arch::PEP10);
+    CHECK(key == helpers::OSImageCache::key(*registry, os(book), Arch::PEP10));
+    CHECK(key != helpers::OSImageCache::key(*registry, os(book) + "\n", Arch::PEP10));
+    auto macro = QSharedPointer<macro::Parsed>::create("CACHETEST", 0, "NOP\n", "PEP10");
+    registry->registerMacro(macro::types::User, macro);
+    CHECK(key != helpers::OSImageCache::key(*registry, os(book), Arch::PEP10));
+  }
+  SECTION("Failed assemblies are not cached") {
+    CHECK(cache.elf(registry, "this is not an OS", Arch::PEP10) == nullptr);
+    CHECK(cache.size() == 0);
+  }
+  SECTION("Persisted images are reused") {
+    QTemporaryDir dir;
+    REQUIRE(dir.isValid());
+    cache.setDirectory(dir.path());
+    REQUIRE(cache.elf(registry, os(book), Arch::PEP10));
+    CHECK(QDir(dir.path()).entryList(QDir::Files).size() == 1);
+    cache.clear();
+    // Served from disk rather than by re-assembling.
+    REQUIRE(cache.elf(registry, os(book), Arch::PEP10));
+    CHECK(cache.size() == 1);
+    cache.setDirectory(std::nullopt);
+  }
+  cache.clear();
+}
@@ -1,4 +1,4 @@
-import subprocess, re
+import json, subprocess, re
 
 class Term:
     def __init__(self, path):
@@ -6,9 +6,13 @@ class Term:
     def run(self, *args):
         out = subprocess.run([self.path, *args], capture_output=True)
         return out
-    def mit(self):
-        out = self.run("mit")
+    def mit(self, workload="bare-br"):
+        out = self.run("mit", "-w", workload)
         as_str = out.stdout.decode("utf-8")
+        try: return next(r["ips"] for r in json.loads(as_str)["results"] if r["name"] == workload)
+        except (json.JSONDecodeError, KeyError, StopIteration): pass
+        # Builds which predate the JSON report reject -w, and print a single human-readable line.
+        as_str = self.run("mit").stdout.decode("utf-8")
         m = re.search(r"Throughput was: (\d\.\d+)e\+(\d+)", as_str, re.RegexFlag.M)
         try: return float(m.group(1)) * 10**int(m.group(2))
         # If match fails, return 0
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "builtins/figure.hpp"
+#include "helpers/asmb.hpp"
+#include "memory/hexdump/rawmemory.hpp"
+#include "project/simulationworker.hpp"
+#include "sim/trace2/buffers.hpp"
+#include "targets/isa3/helpers.hpp"
+#include "targets/isa3/system.hpp"
+#include "targets/pep10/isa3/cpu.hpp"
+
+namespace {
+const auto gs = sim::api2::memory::Operation{
+    .type = sim::api2::memory::Operation::Type::Application,
+    .kind = sim::api2::memory::Operation::Kind::data,
+};
+} // namespace
+
+TEST_CASE("Simulation worker publishes state at the end of a slice", "[scope:project][kind:int][arch:pep10]") {
+  using Register = isa::Pep10::Register;
+  auto book = helpers::book(6);
+  auto os = book->findFigure("os", "pep10baremetal")->typesafeElements()["pep"]->contents;
+  helpers::AsmHelper helper(helpers::registry(book, {}), os, builtins::Architecture::PEP10);
+  helper.setUserText("LDWA 0x1234,i\nSTWA 0x0080,d\nLDWX 1,i\nhang: BR hang\n");
+  REQUIRE(helper.assemble());
+  auto elf = helper.elf();
+  auto system = targets::isa::systemFromElf(*elf, true);
+  REQUIRE(!system.isNull());
+  sim::trace2::InfiniteBuffer tb;
+  system->bus()->setBuffer(&tb);
+  system->init();
+  auto cpu = static_cast<targets::pep10::isa::CPU *>(system->cpu());
+  SimulatorRawMemory memory(system->bus());
+  CHECK(memory.read(0x80) == 0);
+
+  project::SimulationWorker worker;
+  worker.setSystem(&*system, nullptr);
+  std::optional<project::SimulationWorker::Reason> reason;
+  QObject::connect(&worker, &project::SimulationWorker::sliceFinished,
+                   [&](project::SimulationWorker::Reason r, QString) { reason = r; });
+  auto step = [cpu]() {
+    quint16 x = 0;
+    targets::isa::readRegister<isa::Pep10>(cpu->regs(), Register::X, x, gs);
+    return x == 1;
+  };
+  // Stale until the slice finishes; writes while simulating are refused rather than racing the worker.
+  memory.setSimulating(true);
+  worker.runSlice(step);
+  memory.write(0x80, 0xFF);
+  REQUIRE(reason == project::SimulationWorker::Reason::Step);
+  auto state = worker.published();
+  CHECK(state.reg<isa::Pep10>(Register::A) == 0x1234);
+  CHECK(state.reg<isa::Pep10>(Register::X) == 1);
+  CHECK(state.operand == 1);
+  CHECK(memory.read(0x80) == 0);
+
+  memory.setSimulating(false);
+  memory.onUpdateGUI(tb.cend());
+  CHECK(memory.read(0x80) == 0x12);
+  CHECK(memory.read(0x81) == 0x34);
+  CHECK(memory.status(0x80) == MemoryHighlight::Modified);
+  CHECK(memory.readPrevious(0x80) == 0);
+}
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "sim/api2.hpp"
+#include "sim/device/broadcast/mmo.hpp"
+#include "sim/device/dense.hpp"
+#include "sim/device/direct_port.hpp"
+#include "sim/device/readonly.hpp"
+#include "sim/device/simple_bus.hpp"
+#include "sim/trace2/buffers.hpp"
+
+namespace {
+auto rw = sim::api2::memory::Operation{
+    .type = sim::api2::memory::Operation::Type::Standard,
+    .kind = sim::api2::memory::Operation::Kind::data,
+};
+
+auto d1 = sim::api2::device::Descriptor{.id = 1, .baseName = "ram", .fullName = "/bus0/ram"};
+auto d2 = sim::api2::device::Descriptor{.id = 2, .baseName = "rom", .fullName = "/bus0/rom"};
+auto d3 = sim::api2::device::Descriptor{.id = 3, .baseName = "mmo", .fullName = "/bus0/mmo"};
+auto b1 = sim::api2::device::Descriptor{.id = 4, .baseName = "bus0", .fullName = "/bus0"};
+using Span = sim::api2::memory::AddressSpan<quint16>;
+// RAM in pages 0x00-0x7f, ROM in 0x80-0xfe, and a byte of MMIO at the end of the last page of ROM.
+auto make = []() {
+  auto ram = QSharedPointer<sim::memory::Dense<quint16>>::create(d1, Span(0, 0x7FFF));
+  auto rom = QSharedPointer<sim::memory::Dense<quint16>>::create(d2, Span(0, 0x7FFF));
+  auto ro = QSharedPointer<sim::memory::ReadOnly<quint16>>::create(false);
+  ro->setTarget(&*rom, nullptr);
+  auto mmo = QSharedPointer<sim::memory::Output<quint16>>::create(d3, Span(0, 0));
+  auto bus = QSharedPointer<sim::memory::SimpleBus<quint16>>::create(b1, Span(0, 0xFFFF));
+  bus->pushFrontTarget(Span(0, 0x7FFF), &*ram);
+  bus->pushFrontTarget(Span(0x8000, 0xFFFF), &*ro);
+  bus->pushFrontTarget(Span(0xFFFF, 0xFFFF), &*mmo);
+  return std::tuple{bus, ram, rom, ro, mmo};
+};
+} // namespace
+
+TEST_CASE("Direct port", "[scope:sim][kind:int][arch:*]") {
+  auto [bus, ram, rom, ro, mmo] = make();
+  sim::memory::DirectPort<quint16> port;
+  port.setTarget(&*bus);
+  quint8 buf[2] = {0xFE, 0xED}, out[2] = {0, 0};
+
+  SECTION("Accesses main memory") {
+    CHECK(bus->directWrite(0x1000, 2) == ram->directWrite(0x1000, 2));
+    REQUIRE_NOTHROW(port.write(0x1000, {buf}, rw));
+    CHECK(ram->constData()[0x1000] == 0xFE);
+    CHECK(ram->constData()[0x1001] == 0xED);
+    REQUIRE_NOTHROW(port.read(0x1000, {out}, rw));
+    CHECK(out[0] == 0xFE);
+    CHECK(out[1] == 0xED);
+  }
+  SECTION("Accesses which straddle pages or devices") {
+    REQUIRE_NOTHROW(port.write(0x7FFF, {buf}, rw));
+    CHECK(ram->constData()[0x7FFF] == 0xFE);
+    // ROM silently discards the byte.
+    CHECK(rom->constData()[0] == 0);
+    REQUIRE_NOTHROW(port.read(0x10FF, {out}, rw));
+  }
+  SECTION("Writes to ROM are discarded") {
+    CHECK(bus->directRead(0x8000, 2) != nullptr);
+    CHECK(bus->directWrite(0x8000, 2) == nullptr);
+    REQUIRE_NOTHROW(port.write(0x8000, {buf}, rw));
+    CHECK(rom->constData()[0] == 0);
+  }
+  SECTION("MMIO is never bypassed") {
+    CHECK(bus->directRead(0xFF00, 0x100) == nullptr);
+    auto endpoint = mmo->endpoint();
+    REQUIRE_NOTHROW(port.write(0xFFFF, {buf, 1}, rw));
+    auto value = endpoint->next_value();
+    REQUIRE(value.has_value());
+    CHECK(*value == 0xFE);
+  }
+  SECTION("Writes are observed") {
+    quint16 observed = 0;
+    bus->setWriteObserver([&observed](quint16 address, std::size_t) { observed = address; });
+    REQUIRE_NOTHROW(port.write(0x1234, {buf}, rw));
+    CHECK(observed == 0x1234);
+  }
+  SECTION("Remapping invalidates pages") {
+    REQUIRE_NOTHROW(port.read(0x1000, {out}, rw));
+    auto other = QSharedPointer<sim::memory::Dense<quint16>>::create(
+        sim::api2::device::Descriptor{.id = 5, .baseName = "ram2", .fullName = "/bus0/ram2"}, Span(0, 0xFF), 0xAA);
+    bus->pushFrontTarget(Span(0x1000, 0x10FF), &*other);
+    REQUIRE_NOTHROW(port.read(0x1000, {out}, rw));
+    CHECK(out[0] == 0xAA);
+  }
+  SECTION("Trace buffer forces slow path") {
+    auto tb = QSharedPointer<sim::trace2::InfiniteBuffer>::create();
+    bus->setPathManager(QSharedPointer<sim::api2::Paths>::create());
+    bus->setBuffer(&*tb);
+    bus->trace(true);
+    tb->emitFrameStart();
+    REQUIRE_NOTHROW(port.write(0x1000, {buf}, rw));
+    tb->emitFrameStart();
+    auto frames = tb->cbegin();
+    CHECK(frames.cbegin() != frames.cend());
+    CHECK(ram->constData()[0x1000] == 0xFE);
+  }
+}
@@ -15,6 +15,7 @@
  */
 
 #include <catch.hpp>
+#include <QtCore>
 
 #include "sim/device/ide.hpp"
 namespace {
@@ -263,3 +264,40 @@ TEST_CASE("IDE Controller WRITE command", "[scope:sim][kind:int][arch:*]") {
     }
   }
 }
+
+TEST_CASE("IDE Controller disk image", "[scope:sim][kind:int][arch:*]") {
+  int id = desc.id;
+  auto nextId = [&id]() { return ++id; };
+  QTemporaryDir dir;
+  REQUIRE(dir.isValid());
+  auto fname = dir.filePath("disk.img");
+  sim::memory::Dense<quint16> ram(dense, {0, 0xFFFF}, 0);
+
+  quint64 reg0 = -1;
+  quint8 *tmp = (quint8 *)&reg0;
+  {
+    sim::memory::IDEController dev(desc, 0x0, nextId);
+    dev.setTarget(&ram, nullptr);
+    REQUIRE(dev.attachImage(fname));
+    for (int i = 0; i < 256; i += 8) REQUIRE_NOTHROW(ram.write(0x1000 + i, {tmp, 8}, op));
+    // Whole transfer is copied from the mapped image at once.
+    dev.setRegs({.ideCMD = (int)C::WRITE_DMA, .offLBA = 0, .LBA = 2, .addrDMA = 0x1000, .lenDMA = 256}, true);
+  }
+  // The image is the full size of the disk, and retains writes after the controller is destroyed.
+  CHECK(QFileInfo(fname).size() == 256 * (1 << 16) + 1);
+
+  sim::memory::IDEController dev(desc, 0x0, nextId);
+  dev.setTarget(&ram, nullptr);
+  REQUIRE(dev.attachImage(fname));
+  dev.setRegs({.ideCMD = (int)C::READ_DMA, .offLBA = 0, .LBA = 2, .addrDMA = 0x2000, .lenDMA = 512}, true);
+  for (int i = 0; i < 512; i += 8) {
+    reg0 = 7;
+    REQUIRE_NOTHROW(ram.read(0x2000 + i, {tmp, 8}, op));
+    if (i < 256) CHECK(reg0 == quint64(-1));
+    else CHECK(reg0 == 0);
+  }
+
+  dev.detachImage();
+  REQUIRE_NOTHROW(dev.disk()->read(512, {tmp, 8}, op));
+  CHECK(reg0 == 0);
+}
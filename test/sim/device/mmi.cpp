@@ -57,3 +57,25 @@ TEST_CASE("Memory-mapped input read", "[scope:sim][kind:int][arch:*]") {
   in->setFailPolicy(sim::api2::memory::FailPolicy::RaiseError);
   REQUIRE_THROWS_AS(in->read(0, {&tmp, 1}, rw), sim::api2::memory::Error);
 }
+
+TEST_CASE("Memory-mapped input refill", "[scope:sim][kind:int][arch:*]") {
+  auto in = QSharedPointer<sim::memory::Input<quint16>>::create(desc, span, 0);
+  auto endpoint = in->endpoint();
+  // Provides two blocks of two bytes, then reports that input is exhausted.
+  int refills = 0;
+  in->setRefill([&]() {
+    if (refills == 2) return false;
+    for (int it = 0; it < 2; it++) endpoint->append_value(10 * (2 * refills + it + 1));
+    refills++;
+    return true;
+  });
+  quint8 tmp;
+  // Input is only requested once the program reads past the end of the buffered input.
+  CHECK(refills == 0);
+  for (quint8 expected : {10, 20, 30, 40}) {
+    REQUIRE_NOTHROW(in->read(0, {&tmp, 1}, rw));
+    CHECK(tmp == expected);
+  }
+  CHECK(refills == 2);
+  REQUIRE_THROWS_AS(in->read(0, {&tmp, 1}, rw), sim::api2::memory::Error);
+}
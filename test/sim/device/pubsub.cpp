@@ -100,4 +100,55 @@ TEST_CASE("Publish-subscribe", "[scope:sim][kind:unit][arch:*]") {
     REQUIRE(value.has_value());
     CHECK(*value == 0);
   }
+  SECTION("1 producer, 1 consumer. publish; read; revert; publish") {
+    auto channel = QSharedPointer<sim::memory::detail::Channel<quint8, quint8>>::create(0);
+    auto publish = channel->new_endpoint();
+    auto subscribe = channel->new_endpoint();
+    publish->append_value(0x25);
+    publish->append_value(0x26);
+    CHECK(*subscribe->next_value() == 0x25);
+    CHECK(*subscribe->next_value() == 0x26);
+
+    // The subscriber's event was discarded, but it still reports its value until it moves.
+    publish->unwrite();
+    CHECK(*subscribe->current_value() == 0x26);
+    CHECK_FALSE(subscribe->at_end());
+    publish->append_value(0x30);
+    // Its first step lands on the reverted-to event, and the next one on the new write.
+    CHECK(*subscribe->next_value() == 0x25);
+    CHECK(*subscribe->next_value() == 0x30);
+    CHECK_FALSE(subscribe->next_value().has_value());
+    CHECK(subscribe->at_end());
+  }
+  SECTION("1 producer, 1 consumer. publish; clear") {
+    auto channel = QSharedPointer<sim::memory::detail::Channel<quint8, quint8>>::create(0);
+    auto publish = channel->new_endpoint();
+    auto subscribe = channel->new_endpoint();
+    for (int it = 0; it < 1000; it++) publish->append_value(it);
+    subscribe->set_to_tail();
+    channel->clear(0xFE);
+    CHECK(*subscribe->next_value() == 0xFE);
+    CHECK_FALSE(subscribe->next_value().has_value());
+    CHECK(publish->set_to_head() == 0xFE);
+    CHECK_FALSE(publish->unwrite().has_value());
+  }
+  SECTION("1 producer, 1 consumer. publish; read; trim") {
+    auto channel = QSharedPointer<sim::memory::detail::Channel<quint8, quint8>>::create(0);
+    auto publish = channel->new_endpoint();
+    auto subscribe = channel->new_endpoint();
+    publish->append_value(0x25);
+    publish->append_value(0x10);
+    CHECK(subscribe->next_value() == 0x25);
+    subscribe->trim_before();
+    // Trimmed events are gone, but unread events and the cursors' values are kept.
+    CHECK(subscribe->event_id() == 0);
+    CHECK(subscribe->current_value() == 0x25);
+    CHECK(publish->event_id() == 1);
+    CHECK_FALSE(subscribe->unread().has_value());
+    CHECK(subscribe->next_value() == 0x10);
+    CHECK(subscribe->at_end());
+    // The root is not attributed to the producer, so reverting stops there.
+    publish->unwrite();
+    CHECK(publish->set_to_tail() == 0x25);
+  }
 }
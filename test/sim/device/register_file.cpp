@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+
+#include "sim/device/register_file.hpp"
+#include "sim/trace2/buffers.hpp"
+namespace {
+namespace api2 = sim::api2;
+auto desc = api2::device::Descriptor{.id = 0, .compatible = nullptr, .baseName = "regs", .fullName = "/regs"};
+auto op = api2::memory::Operation{
+    .type = api2::memory::Operation::Type::Standard,
+    .kind = api2::memory::Operation::Kind::data,
+};
+using Registers = sim::memory::RegisterFile<quint16, 4>;
+} // namespace
+
+TEST_CASE("Register file byte view", "[scope:sim][kind:int][arch:*]") {
+  Registers regs(desc);
+  CHECK(regs.deviceID() == desc.id);
+  CHECK(size_inclusive(regs.span()) == 8);
+
+  SECTION("Native writes are visible as big-endian bytes") {
+    regs.set(1, 0xCAFE);
+    quint8 tmp[2] = {0, 0};
+    REQUIRE_NOTHROW(regs.read(2, {tmp, 2}, op));
+    CHECK(tmp[0] == 0xCA);
+    CHECK(tmp[1] == 0xFE);
+  }
+  SECTION("Byte writes are visible natively") {
+    const quint8 truth[3] = {0x12, 0x34, 0x56};
+    // Straddle the boundary between two registers.
+    REQUIRE_NOTHROW(regs.write(3, {truth, 3}, op));
+    CHECK(regs.get(0) == 0x0000);
+    CHECK(regs.get(1) == 0x0012);
+    CHECK(regs.get(2) == 0x3456);
+    CHECK(regs.get(3) == 0x0000);
+  }
+  SECTION("Clear fills every byte") {
+    regs.clear(0xA5);
+    for (int it = 0; it < 4; it++) CHECK(regs.get(it) == 0xA5A5);
+  }
+  SECTION("Out-of-bounds access throws") {
+    quint8 tmp[2] = {0, 0};
+    CHECK_THROWS(regs.read(7, {tmp, 2}, op));
+    CHECK_THROWS(regs.write(8, {tmp, 1}, op));
+  }
+}
+
+TEST_CASE("Register file trace replay", "[scope:sim][kind:int][arch:*]") {
+  sim::trace2::InfiniteBuffer buf;
+  Registers regs(desc);
+  regs.setBuffer(&buf);
+  regs.trace(true);
+  buf.trace(desc.id, true);
+
+  buf.emitFrameStart();
+  regs.set(0, 0x1234);
+  buf.emitFrameStart();
+  const quint16 values[2] = {0xBEEF, 0x0102};
+  regs.set(2, bits::span<const quint16>{values});
+  buf.updateFrameHeader();
+
+  // The second frame contains a single packet, from the bulk write.
+  auto frame = ++buf.cbegin();
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 1);
+  // Payloads are XOR encoded, so analyzing the same packet undoes the write.
+  for (auto pkt = frame.cbegin(); pkt != frame.cend(); ++pkt)
+    CHECK(regs.analyze(pkt, api2::trace::Direction::Reverse));
+  CHECK(regs.get(0) == 0x1234);
+  CHECK(regs.get(2) == 0x0000);
+  CHECK(regs.get(3) == 0x0000);
+}
@@ -163,3 +163,34 @@ TEST_CASE("Simple bus path tracking", "[scope:sim][kind:int][arch:*]") {
   CHECK(sim::trace2::get_path(*packets) == path1);
   CHECK(sim::trace2::get_address<quint16>(*packets) == std::make_optional<quint16>(0));
 }
+
+TEST_CASE("Simple bus dirty pages", "[scope:sim][kind:int][arch:*]") {
+  using Bus = sim::memory::SimpleBus<quint16>;
+  constexpr quint16 page = Bus::dirtyPageSize;
+  sim::memory::Dense<quint16> mem(d1, Span(0, 0xFFFF));
+  Bus bus(b1, Span(0, 0xFFFF));
+  bus.pushFrontTarget(Span(0, 0xFFFF), &mem);
+  CHECK(bus.takeDirty().empty());
+
+  quint8 buf[2] = {0xFE, 0xED};
+  // Adjacent pages are reported as a single run, and writes which straddle a page boundary dirty both pages.
+  bus.write(page - 1, {buf, 2}, rw);
+  bus.write(2 * page, {buf, 1}, rw);
+  bus.write(10 * page + 3, {buf, 1}, rw);
+  auto dirty = bus.takeDirty();
+  REQUIRE(dirty.size() == 2);
+  CHECK(dirty[0] == Span(0, 3 * page - 1));
+  CHECK(dirty[1] == Span(10 * page, 11 * page - 1));
+  // Taking the dirty pages marks them clean.
+  CHECK(bus.takeDirty().empty());
+
+  bus.write(0xFFFF, {buf, 1}, rw);
+  dirty = bus.takeDirty();
+  REQUIRE(dirty.size() == 1);
+  CHECK(dirty[0] == Span(0x10000 - page, 0xFFFF));
+
+  bus.clear(0);
+  dirty = bus.takeDirty();
+  REQUIRE(dirty.size() == 1);
+  CHECK(dirty[0] == Span(0, 0xFFFF));
+}
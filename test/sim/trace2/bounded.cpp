@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "sim/api2.hpp"
+#include "sim/trace2/buffers.hpp"
+
+namespace {
+using namespace sim::api2;
+// Emit count frames, where the i'th frame contains a single write to address i.
+void emitFrames(sim::trace2::InfiniteBuffer &buf, quint16 count) {
+  quint8 src[2] = {0xFE, 0xED}, dest[2] = {0, 0};
+  for (quint16 it = 0; it < count; it++) {
+    buf.emitFrameStart();
+    buf.emitWrite<quint16>(1, it, src, dest);
+  }
+  buf.updateFrameHeader();
+}
+
+quint16 address(const trace::FrameIterator &frame) {
+  packet::Header header = *frame.cbegin();
+  return std::get<packet::header::Write>(header).address.to_address<quint16>();
+}
+} // namespace
+
+TEST_CASE("Bounded trace buffer", "[scope:sim][kind:unit][arch:*]") {
+  SECTION("Frame budget") {
+    sim::trace2::BoundedBuffer buf({.frames = 4});
+    buf.trace(1, true);
+    emitFrames(buf, 10);
+    // Evicts down to 3 frames whenever the budget is exceeded, so the 10th frame leaves 4 frames.
+    CHECK(std::distance(buf.cbegin(), buf.cend()) == 4);
+    CHECK(address(buf.cbegin()) == 6);
+    CHECK(address(buf.crbegin()) == 9);
+    CHECK_FALSE(buf.cbegin().evicted());
+
+    // Reverse iteration stops at the oldest retained frame, and reports that older frames were discarded.
+    quint16 expected = 9;
+    auto frame = buf.crbegin();
+    for (; frame != buf.crend(); ++frame) CHECK(address(frame) == expected--);
+    CHECK(expected == 5);
+    CHECK(frame.evicted());
+  }
+  SECTION("Byte budget") {
+    sim::trace2::BoundedBuffer buf({.bytes = 256});
+    buf.trace(1, true);
+    emitFrames(buf, 2);
+    auto stale = buf.cbegin();
+    CHECK_FALSE(stale.evicted());
+    emitFrames(buf, 1000);
+    auto count = std::distance(buf.cbegin(), buf.cend());
+    CHECK(count > 1);
+    CHECK(count < 1000);
+    CHECK(stale.evicted());
+    CHECK_THROWS(*stale);
+    // Iterators into discarded frames resume from the oldest retained frame.
+    CHECK(++stale == buf.cbegin());
+
+    // Retained frames are still contiguous and in order.
+    auto frame = buf.cbegin();
+    quint16 previous = address(frame);
+    for (++frame; frame != buf.cend(); ++frame) CHECK(address(frame) == ++previous);
+    CHECK(previous == 999);
+  }
+  SECTION("Unbounded buffers never evict") {
+    sim::trace2::InfiniteBuffer buf;
+    buf.trace(1, true);
+    emitFrames(buf, 100);
+    CHECK(std::distance(buf.cbegin(), buf.cend()) == 100);
+    CHECK_FALSE(buf.crend().evicted());
+  }
+}
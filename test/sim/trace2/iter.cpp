@@ -18,6 +18,7 @@
 #include <zpp_bits.h>
 #include "sim/api2.hpp"
 #include "sim/trace2/buffers.hpp"
+#include "sim/trace2/frame_utils.hpp"
 #include "sim/trace2/packet_utils.hpp"
 
 TEST_CASE("Trace buffer iterators", "[scope:sim][kind:unit][arch:*]") {
@@ -155,3 +156,109 @@ TEST_CASE("Trace buffer iterators", "[scope:sim][kind:unit][arch:*]") {
     }
   }
 }
+
+TEST_CASE("Lazy trace frames", "[scope:sim][kind:unit][arch:*]") {
+  sim::trace2::InfiniteBuffer buf;
+  std::array<quint8, 2> src = {1, 2}, dest = {0, 0};
+  auto ticks = [](const sim::api2::trace::FrameIterator &frame) {
+    return std::visit(sim::trace2::GetFrameTickDelta{}, *frame);
+  };
+  buf.trace(1, true);
+
+  // Empty ticks do not write anything, not even a frame header.
+  for (int it = 0; it < 2; it++) {
+    buf.emitLazyFrameStart();
+    buf.updateFrameHeader();
+  }
+  CHECK(buf.cbegin() == buf.cend());
+  CHECK(buf.pendingTicks() == 2);
+
+  // The first packet materializes a frame, which accounts for the empty ticks.
+  buf.emitLazyFrameStart();
+  buf.emitWrite<quint16>(1, 0, src, dest);
+  buf.updateFrameHeader();
+  // Eagerly started frames also account for preceding empty ticks.
+  buf.emitLazyFrameStart();
+  buf.updateFrameHeader();
+  buf.emitFrameStart();
+  buf.emitWrite<quint16>(1, 2, src, dest);
+  buf.updateFrameHeader();
+  // Trailing empty ticks remain pending until the next frame.
+  buf.emitLazyFrameStart();
+  CHECK(buf.pendingTicks() == 1);
+
+  CHECK(std::distance(buf.cbegin(), buf.cend()) == 2);
+  CHECK(std::distance(buf.crbegin(), buf.crend()) == 2);
+  auto frame = buf.cbegin();
+  CHECK(ticks(frame) == 3);
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 1);
+  ++frame;
+  CHECK(ticks(frame) == 2);
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 1);
+}
+
+TEST_CASE("Trace buffer iterators observe the growing frame", "[scope:sim][kind:unit][arch:*]") {
+  sim::trace2::InfiniteBuffer buf;
+  std::array<quint8, 2> src = {1, 2}, dest = {0, 0};
+  auto length = [](const sim::api2::trace::FrameIterator &frame) {
+    return std::visit(sim::trace2::GetFrameLength{}, *frame);
+  };
+  buf.trace(1, true);
+  buf.emitFrameStart();
+  buf.emitWrite<quint16>(1, 0, src, dest);
+
+  // Walking the newest frame decodes it, which must not hide packets appended afterwards.
+  auto frame = buf.cbegin();
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 1);
+  CHECK(length(frame) == 0);
+  buf.emitWrite<quint16>(1, 2, src, dest);
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 2);
+  CHECK(std::distance(buf.crbegin().cbegin(), buf.crbegin().cend()) == 2);
+
+  // Nor hide the length written to its header once the frame is complete.
+  buf.emitFrameStart();
+  CHECK(length(frame) > 0);
+  CHECK(std::distance(frame.cbegin(), frame.cend()) == 2);
+  CHECK(std::distance(buf.cbegin(), buf.cend()) == 2);
+}
+
+TEST_CASE("Trace buffer decodes each fragment once per frame walk", "[scope:sim][kind:unit][arch:*]") {
+  using namespace sim::api2;
+  sim::trace2::InfiniteBuffer buf;
+  std::array<quint8, 16> src, dest;
+  src.fill(0xFE), dest.fill(0);
+  buf.trace(1, true);
+  for (int frame = 0; frame < 3; frame++) {
+    buf.emitFrameStart();
+    for (quint16 it = 0; it < 4; it++) buf.emitWrite<quint16>(1, 32 * it, src, dest);
+    buf.emitPureRead<quint16>(1, 0, 16);
+  }
+  buf.updateFrameHeader();
+
+  // Visits every fragment of the frame, returning the number of fragments visited.
+  auto walk = [](const trace::FrameIterator &frame, bool reverse) {
+    std::size_t count = 1;
+    (void)*frame;
+    for (auto packet = reverse ? frame.crbegin() : frame.cbegin(); packet != (reverse ? frame.crend() : frame.cend());
+         ++packet, count++) {
+      (void)*packet;
+      for (auto payload = packet.cbegin(); payload != packet.cend(); ++payload, count++) (void)*payload;
+    }
+    return count;
+  };
+
+  // Use a frame with neighbors on both sides, so that walks must step over its boundaries.
+  auto frame = ++buf.cbegin();
+  auto before = buf.decodes();
+  auto fragments = walk(frame, false);
+  CHECK(fragments == 1 + 5 + 4);
+  // The header is decoded on its own before its frame, and the walk's end is found at the next frame's header.
+  CHECK(buf.decodes() - before <= fragments + 2);
+
+  auto decoded = buf.decodes();
+  for (int it = 0; it < 3; it++) {
+    CHECK(walk(frame, true) == fragments);
+    CHECK(walk(frame, false) == fragments);
+  }
+  CHECK(buf.decodes() == decoded);
+}
@@ -0,0 +1,87 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "sim/api2.hpp"
+#include "sim/trace2/buffers.hpp"
+
+namespace {
+using namespace sim::api2;
+// Simulate count ticks, where only even ticks write to memory. The write's address is the tick which produced it.
+void emitTicks(sim::trace2::InfiniteBuffer &buf, quint16 count) {
+  quint8 src[2] = {0xFE, 0xED}, dest[2] = {0, 0};
+  for (quint16 it = 0; it < count; it++) {
+    buf.emitLazyFrameStart();
+    if (it % 2 == 0) buf.emitWrite<quint16>(1, it, src, dest);
+    buf.updateFrameHeader();
+  }
+}
+
+quint16 address(const trace::FrameIterator &frame) {
+  packet::Header header = *frame.cbegin();
+  return std::get<packet::header::Write>(header).address.to_address<quint16>();
+}
+} // namespace
+
+TEST_CASE("Trace buffer seek", "[scope:sim][kind:unit][arch:*]") {
+  SECTION("Unbounded") {
+    sim::trace2::InfiniteBuffer buf;
+    buf.trace(1, true);
+    emitTicks(buf, 1000);
+    // The final tick is pending, since it produced no frame.
+    CHECK(buf.ticks() == 999);
+    CHECK(buf.seek(0) == buf.cbegin());
+    for (quint16 tick : {0, 1, 2, 127, 128, 129, 500, 998}) {
+      auto frame = buf.seek(tick);
+      REQUIRE(frame != buf.cend());
+      // Odd ticks produce no frame, so seek finds the following tick's frame.
+      CHECK(address(frame) == tick + tick % 2);
+    }
+    CHECK(buf.seek(999) == buf.cend());
+  }
+  SECTION("After eviction") {
+    sim::trace2::BoundedBuffer buf({.frames = 100});
+    buf.trace(1, true);
+    emitTicks(buf, 1000);
+    // Ticks before the oldest retained frame resolve to that frame.
+    CHECK(buf.seek(0) == buf.cbegin());
+    CHECK(address(buf.seek(0)) > 0);
+    CHECK(address(buf.seek(900)) == 900);
+    CHECK(address(buf.seek(997)) == 998);
+  }
+}
+
+TEST_CASE("Trace buffer reverse iteration within frames", "[scope:sim][kind:unit][arch:*]") {
+  sim::trace2::InfiniteBuffer buf;
+  buf.trace(1, true);
+  quint8 src[2] = {0xFE, 0xED}, dest[2] = {0, 0};
+  for (quint16 frame = 0; frame < 3; frame++) {
+    buf.emitFrameStart();
+    for (quint16 packet = 0; packet < 10; packet++) buf.emitWrite<quint16>(1, frame * 10 + packet, src, dest);
+  }
+  buf.updateFrameHeader();
+
+  // Packets are visited in the opposite order of forward iteration.
+  quint16 expected = 30;
+  for (auto frame = buf.crbegin(); frame != buf.crend(); ++frame) {
+    for (auto packet = frame.cbegin(); packet != frame.cend(); ++packet) {
+      packet::Header header = *packet;
+      CHECK(std::get<packet::header::Write>(header).address.to_address<quint16>() == --expected);
+      CHECK(std::distance(packet.cbegin(), packet.cend()) == 1);
+    }
+  }
+  CHECK(expected == 0);
+}
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "./instr/api.hpp"
+#include "sim/debug/debugger.hpp"
+
+namespace {
+using ISA = isa::Pep10;
+using Access = pepp::sim::Debugger::Access;
+} // namespace
+
+TEST_CASE("Pep/10 breakpoints and watchpoints", "[scope:sim][kind:int][target:pep10]") {
+  auto machine = makeMachine(true);
+  auto &bus = *machine.bus;
+  auto &cpu = *machine.cpu;
+
+  // LDWA 0x1234,i; STBA 0x8000,d; LDBA 0x8001,d; NOP
+  auto program = std::array<quint8, 10>{0xC0, 0x12, 0x34, 0xF1, 0x80, 0x00, 0xD1, 0x80, 0x01, 0x07};
+  REQUIRE_NOTHROW(bus.write(0, {program.data(), program.size()}, rw));
+  pepp::sim::Debugger dbg;
+  cpu.setDebugger(&dbg);
+
+  SECTION("Conditional breakpoint") {
+    auto regA = [&]() {
+      quint16 value = 0;
+      targets::isa::readRegister<ISA>(cpu.regs(), ISA::Register::A, value, rw);
+      return value;
+    };
+    // PC is notified after the increment, so a breakpoint on the STBA triggers at the end of the LDWA.
+    dbg.addBP(0x0003, [&]() { return regA() == 0x4321; });
+    REQUIRE_NOTHROW(cpu.clock(0));
+    CHECK_FALSE(dbg.hit());
+    dbg.removeBP(0x0003);
+    CHECK_FALSE(dbg.hasBP(0x0003));
+    dbg.addBP(0x0006, [&]() { return regA() == 0x1234; });
+    REQUIRE_NOTHROW(cpu.clock(1));
+    CHECK(dbg.hit());
+  }
+  SECTION("Write watchpoint") {
+    // Covers the program too, to show that instruction fetches are not data accesses.
+    dbg.addWatchpoint(0x0000, 0x8000, Access::Write);
+    REQUIRE_NOTHROW(cpu.clock(0));
+    CHECK_FALSE(dbg.hit());
+    REQUIRE_NOTHROW(cpu.clock(1));
+    CHECK(dbg.hit());
+    REQUIRE(dbg.watchHit().has_value());
+    CHECK(dbg.watchHit()->address == 0x8000);
+    CHECK(dbg.watchHit()->access == Access::Write);
+    dbg.clearHit();
+    CHECK_FALSE(dbg.watchHit().has_value());
+    // Reads are not watched by a write watchpoint.
+    REQUIRE_NOTHROW(cpu.clock(2));
+    CHECK_FALSE(dbg.hit());
+  }
+  SECTION("Read watchpoint") {
+    dbg.addWatchpoint(0x8001, 0x8001, Access::Read);
+    for (int it = 0; it < 2; it++) REQUIRE_NOTHROW(cpu.clock(it));
+    CHECK_FALSE(dbg.hit());
+    REQUIRE_NOTHROW(cpu.clock(2));
+    CHECK(dbg.hit());
+    CHECK(dbg.watchHit()->access == Access::Read);
+    dbg.clearHit();
+    dbg.clearWatchpoints();
+    REQUIRE_NOTHROW(cpu.clock(3));
+    CHECK_FALSE(dbg.hit());
+  }
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "./instr/api.hpp"
+
+namespace {
+using ISA = isa::Pep10;
+using Register = ISA::Register;
+
+void setReg(targets::pep10::isa::CPU &cpu, Register reg, quint16 value) {
+  targets::isa::writeRegister<ISA>(cpu.regs(), reg, value, rw);
+}
+} // namespace
+
+TEST_CASE("Pep/10 decode cache coherence", "[scope:sim][kind:int][target:pep10]") {
+  auto machine = makeMachine(true);
+  auto &bus = *machine.bus;
+  auto &cpu = *machine.cpu;
+  cpu.setDecodeCacheEnabled(true);
+  bus.setWriteObserver([&cpu](quint16 address, std::size_t length) { cpu.invalidateDecodeCache(address, length); });
+
+  SECTION("Writes from another initiator") {
+    // LDWA 0x1234,i
+    auto program = std::array<quint8, 3>{0xC0, 0x12, 0x34};
+    REQUIRE_NOTHROW(bus.write(0, {program.data(), program.size()}, rw));
+    REQUIRE_NOTHROW(cpu.clock(0));
+    CHECK(reg(machine.cpu, Register::A) == 0x1234);
+
+    // Only the operand specifier changes, which must still evict the cached instruction.
+    program[1] = 0x56, program[2] = 0x78;
+    REQUIRE_NOTHROW(bus.write(0, {program.data(), program.size()}, rw));
+    setReg(cpu, Register::PC, 0);
+    REQUIRE_NOTHROW(cpu.clock(1));
+    CHECK(reg(machine.cpu, Register::A) == 0x5678);
+    CHECK(reg(machine.cpu, Register::OS) == 0x5678);
+  }
+  SECTION("Self-modifying code") {
+    // STBA 0x0004,d; LDWA 0x1111,i
+    auto program = std::array<quint8, 6>{0xF1, 0x00, 0x04, 0xC0, 0x11, 0x11};
+    REQUIRE_NOTHROW(bus.write(0, {program.data(), program.size()}, rw));
+    // Execute (and cache) the LDWA before it is modified.
+    setReg(cpu, Register::PC, 3);
+    REQUIRE_NOTHROW(cpu.clock(0));
+    CHECK(reg(machine.cpu, Register::A) == 0x1111);
+
+    setReg(cpu, Register::A, 0x0022);
+    setReg(cpu, Register::PC, 0);
+    REQUIRE_NOTHROW(cpu.clock(1));
+    REQUIRE_NOTHROW(cpu.clock(2));
+    CHECK(reg(machine.cpu, Register::A) == 0x2211);
+    CHECK(reg(machine.cpu, Register::PC) == 6);
+  }
+}
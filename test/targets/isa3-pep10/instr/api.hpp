@@ -18,6 +18,7 @@
 #include <qtypes.h>
 #include "bits/operations/swap.hpp"
 #include "sim/device/dense.hpp"
+#include "sim/device/simple_bus.hpp"
 #include "targets/isa3/helpers.hpp"
 #include "targets/pep10/isa3/cpu.hpp"
 
@@ -26,8 +27,17 @@ static inline sim::api2::memory::Operation rw = {
     .kind = sim::api2::memory::Operation::Kind::data,
 };
 
-static inline std::pair<QSharedPointer<sim::memory::Dense<quint16>>, QSharedPointer<targets::pep10::isa::CPU>> make() {
-  int i = 3;
+// Memory, bus, and CPU of a minimal Pep/10 system.
+struct Machine {
+  QSharedPointer<sim::memory::Dense<quint16>> storage;
+  // Only present if requested from makeMachine.
+  QSharedPointer<sim::memory::SimpleBus<quint16>> bus;
+  QSharedPointer<targets::pep10::isa::CPU> cpu;
+};
+
+// If withBus, the CPU reaches memory through a bus as it does in a System, and its registers and CSRs are cleared.
+static inline Machine makeMachine(bool withBus = false) {
+  int i = 4;
 
   static const auto desc_mem = sim::api2::device::Descriptor{
       .id = 1,
@@ -41,12 +51,31 @@ static inline std::pair<QSharedPointer<sim::memory::Dense<quint16>>, QSharedPoin
       .fullName = "/cpu",
   };
 
+  static const auto desc_bus = sim::api2::device::Descriptor{
+      .id = 3,
+      .baseName = "bus",
+      .fullName = "/bus",
+  };
+
   static const auto span = sim::api2::memory::AddressSpan<quint16>(0, 0xFFFF);
   sim::api2::device::IDGenerator gen = [&i]() { return i++; };
-  auto storage = QSharedPointer<sim::memory::Dense<quint16>>::create(desc_mem, span);
-  auto cpu = QSharedPointer<targets::pep10::isa::CPU>::create(desc_cpu, gen);
-  cpu->setTarget(storage.data(), nullptr);
-  return std::pair{storage, cpu};
+  Machine ret{.storage = QSharedPointer<sim::memory::Dense<quint16>>::create(desc_mem, span),
+              .cpu = QSharedPointer<targets::pep10::isa::CPU>::create(desc_cpu, gen)};
+  if (!withBus) {
+    ret.cpu->setTarget(ret.storage.data(), nullptr);
+    return ret;
+  }
+  ret.bus = QSharedPointer<sim::memory::SimpleBus<quint16>>::create(desc_bus, span);
+  ret.bus->pushFrontTarget(span, ret.storage.data());
+  ret.cpu->setTarget(ret.bus.data(), nullptr);
+  ret.cpu->regs()->clear(0);
+  ret.cpu->csrs()->clear(0);
+  return ret;
+}
+
+static inline std::pair<QSharedPointer<sim::memory::Dense<quint16>>, QSharedPointer<targets::pep10::isa::CPU>> make() {
+  auto machine = makeMachine();
+  return std::pair{machine.storage, machine.cpu};
 };
 
 static inline auto reg(QSharedPointer<targets::pep10::isa::CPU> cpu, isa::Pep10::Register reg) -> quint16 {
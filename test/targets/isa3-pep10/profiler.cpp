@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "./instr/api.hpp"
+#include "sim/debug/profiler.hpp"
+
+namespace {
+using ISA = isa::Pep10;
+} // namespace
+
+TEST_CASE("Pep/10 profiler", "[scope:sim][kind:int][target:pep10]") {
+  auto machine = makeMachine(true);
+  auto &bus = *machine.bus;
+  auto &cpu = *machine.cpu;
+  targets::isa::writeRegister<ISA>(cpu.regs(), ISA::Register::SP, 0xFF00, rw);
+
+  // main: CALL sub,i; CALL sub,i; NOP
+  auto main = std::array<quint8, 7>{0x36, 0x00, 0x10, 0x36, 0x00, 0x10, 0x07};
+  // sub: NOP; RET
+  auto sub = std::array<quint8, 2>{0x07, 0x01};
+  REQUIRE_NOTHROW(bus.write(0, {main.data(), main.size()}, rw));
+  REQUIRE_NOTHROW(bus.write(0x10, {sub.data(), sub.size()}, rw));
+
+  pepp::sim::Profiler profiler;
+  profiler.setSymbols({{0x0000, "main"}, {0x0010, "sub"}});
+  cpu.setProfiler(&profiler);
+  for (int it = 0; it < 7; it++) REQUIRE_NOTHROW(cpu.clock(it));
+
+  CHECK(profiler.instructions() == 7);
+  CHECK(profiler.count(0x0010) == 2);
+  CHECK(profiler.count(0x0006) == 1);
+  CHECK(profiler.opcodeCount(0x36) == 2);
+  CHECK(profiler.opcodeCount(0x01) == 2);
+
+  QString folded;
+  QTextStream out(&folded);
+  profiler.writeFolded(out);
+  out.flush();
+  CHECK(folded == "main 3\nmain;sub 4\n");
+
+  auto calls = profiler.summary()["calls"].toArray();
+  REQUIRE(calls.size() == 1);
+  CHECK(calls[0].toObject()["caller"].toString() == "main");
+  CHECK(calls[0].toObject()["callee"].toString() == "sub");
+  CHECK(calls[0].toObject()["count"].toInteger() == 2);
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 J. Stanley Warford, Matthew McRaven
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <catch.hpp>
+#include "link/memmap.hpp"
+#include "link/mmio.hpp"
+#include "sim/device/broadcast/mmi.hpp"
+#include "sim/device/broadcast/mmo.hpp"
+#include "sim/device/simple_bus.hpp"
+#include "targets/isa3/helpers.hpp"
+#include "targets/isa3/system.hpp"
+#include "targets/pep10/isa3/cpu.hpp"
+
+namespace {
+sim::api2::memory::Operation gs = {
+    .type = sim::api2::memory::Operation::Type::Application,
+    .kind = sim::api2::memory::Operation::Kind::data,
+};
+using ISA = isa::Pep10;
+
+QSharedPointer<targets::isa::System> makeSystem() {
+  QList<obj::MemoryRegion> regions = {{.r = true, .w = true, .minOffset = 0, .maxOffset = 0xFEFF, .segs = {}}};
+  QList<obj::AddressedIO> mmios = {
+      {{.name = "charIn", .type = obj::IO::Type::kInput}, 0xFF00, 0xFF00},
+      {{.name = "charOut", .type = obj::IO::Type::kOutput}, 0xFF01, 0xFF01},
+  };
+  auto system = QSharedPointer<targets::isa::System>::create(builtins::Architecture::PEP10, regions, mmios);
+  // LDBA charIn,d; STBA charOut,d; STBA 0x0100,d
+  auto program = std::array<quint8, 9>{0xD1, 0xFF, 0x00, 0xF1, 0xFF, 0x01, 0xF1, 0x01, 0x00};
+  system->bus()->write(0, {program.data(), program.size()}, gs);
+  auto cpu = dynamic_cast<targets::pep10::isa::CPU *>(system->cpu());
+  cpu->regs()->clear(0), cpu->csrs()->clear(0);
+  return system;
+}
+
+quint8 memory(targets::isa::System &system, quint16 address) {
+  quint8 ret = 0;
+  system.bus()->read(address, {&ret, 1}, gs);
+  return ret;
+}
+
+QByteArray output(targets::isa::System &system) {
+  QByteArray ret;
+  auto endpoint = system.output("charOut")->endpoint();
+  endpoint->set_to_head();
+  for (auto next = endpoint->next_value(); next.has_value(); next = endpoint->next_value()) ret.push_back(*next);
+  return ret;
+}
+
+void run(targets::isa::System &system) {
+  for (int it = 0; it < 3; it++) system.tick(sim::api2::Scheduler::Mode::Jump);
+}
+} // namespace
+
+TEST_CASE("Pep/10 system snapshots", "[scope:sim][kind:int][target:pep10]") {
+  SECTION("Restore") {
+    auto system = makeSystem();
+    system->input("charIn")->endpoint()->append_value('a');
+    auto snapshot = system->snapshot();
+    run(*system);
+    CHECK(memory(*system, 0x100) == 'a');
+    CHECK(output(*system) == "a");
+
+    system->restore(*snapshot);
+    CHECK(system->currentTick() == 0);
+    CHECK(memory(*system, 0x100) == 0);
+    CHECK(output(*system) == "");
+    quint16 pc = 0xFFFF;
+    auto cpu = dynamic_cast<targets::pep10::isa::CPU *>(system->cpu());
+    targets::isa::readRegister<ISA>(cpu->regs(), ISA::Register::PC, pc, gs);
+    CHECK(pc == 0);
+
+    // Input is replayed from the same position.
+    run(*system);
+    CHECK(memory(*system, 0x100) == 'a');
+    CHECK(output(*system) == "a");
+  }
+  SECTION("Fork") {
+    auto system = makeSystem();
+    auto snapshot = system->snapshot();
+    auto fork = system->fork(*snapshot);
+    system->input("charIn")->endpoint()->append_value('a');
+    fork->input("charIn")->endpoint()->append_value('b');
+    run(*system), run(*fork);
+    CHECK(memory(*system, 0x100) == 'a');
+    CHECK(output(*system) == "a");
+    CHECK(memory(*fork, 0x100) == 'b');
+    CHECK(output(*fork) == "b");
+
+    // Neither run is visible from the snapshot.
+    system->restore(*snapshot);
+    CHECK(memory(*system, 0x100) == 0);
+    CHECK(memory(*system, 0) == 0xD1);
+  }
+}